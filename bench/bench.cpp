@@ -0,0 +1,388 @@
+#include "bench.h"
+#include "common/config.h"
+#include "common/log.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <unistd.h>
+
+// ---- 分配计数：替换全局 operator new/delete ----
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace bench {
+
+uint64_t allocation_count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+namespace {
+
+struct Entry {
+    std::string name;
+    BenchFn fn;
+    std::vector<int64_t> args;
+};
+
+std::vector<Entry>& entries() {
+    static std::vector<Entry> list;
+    return list;
+}
+
+std::string g_work_dir;
+DiskBackendKind g_disk_backend = DiskBackendKind::Stream;
+AsyncEngineKind g_io_engine = AsyncEngineKind::Auto;
+
+struct Result {
+    std::string name;
+    std::string benchmark;
+    int64_t arg = 0;
+    uint64_t iterations = 0;
+    double ns_per_op = 0;
+    double ops_per_sec = 0;
+    double allocs_per_op = 0;
+    double bytes_per_sec = 0;
+    uint64_t disk_num_blocks = 0;
+    std::string skipped;
+};
+
+struct Options {
+    std::string format = "text";  // text | json | csv
+    std::string filter;
+    std::string out;
+    double min_time_ms = 100;
+    bool list = false;
+    bool keep = false;
+    bool smoke = false;  // 每个基准只跑第一个参数
+};
+
+// 反复加倍迭代次数，直到单次运行耗时超过 min_time
+Result run_one(const Entry& e, int64_t arg, double min_time_ns) {
+    Result r;
+    r.benchmark = e.name;
+    r.arg = arg;
+    r.name = e.name + "/" + std::to_string(arg);
+
+    uint64_t iters = 1;
+    for (;;) {
+        State state(iters, arg);
+        e.fn(state);
+        if (!state.skip_reason().empty()) {
+            r.skipped = state.skip_reason();
+            return r;
+        }
+
+        const double elapsed = state.elapsed_ns();
+        if (elapsed >= min_time_ns || iters >= 1'000'000'000) {
+            r.iterations = iters;
+            r.ns_per_op = elapsed / static_cast<double>(iters);
+            r.ops_per_sec = r.ns_per_op > 0 ? 1e9 / r.ns_per_op : 0;
+            r.allocs_per_op =
+                static_cast<double>(state.allocations()) / static_cast<double>(iters);
+            r.bytes_per_sec = static_cast<double>(state.bytes_per_op()) * r.ops_per_sec;
+            r.disk_num_blocks = state.disk_blocks();
+            return r;
+        }
+
+        double multiplier = elapsed > 0 ? min_time_ns * 1.4 / elapsed : 10.0;
+        if (multiplier > 10.0 || elapsed / min_time_ns < 0.1) {
+            multiplier = 10.0;
+        }
+        if (multiplier < 2.0) {
+            multiplier = 2.0;
+        }
+        iters = static_cast<uint64_t>(static_cast<double>(iters) * multiplier);
+    }
+}
+
+std::string human_rate(double v) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    if (v >= 1e9) {
+        oss << v / 1e9 << "G";
+    } else if (v >= 1e6) {
+        oss << v / 1e6 << "M";
+    } else if (v >= 1e3) {
+        oss << v / 1e3 << "k";
+    } else {
+        oss << v;
+    }
+    return oss.str();
+}
+
+void print_text(std::ostream& os, const std::vector<Result>& results) {
+    os << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12)
+       << "iters" << std::setw(14) << "ns/op" << std::setw(12) << "ops/s"
+       << std::setw(12) << "allocs/op" << std::setw(12) << "B/s" << "\n";
+    for (const auto& r : results) {
+        os << std::left << std::setw(40) << r.name << std::right;
+        if (!r.skipped.empty()) {
+            os << "  skipped: " << r.skipped << "\n";
+            continue;
+        }
+        os << std::setw(12) << r.iterations << std::setw(14) << std::fixed
+           << std::setprecision(1) << r.ns_per_op << std::setw(12)
+           << human_rate(r.ops_per_sec) << std::setw(12) << std::setprecision(2)
+           << r.allocs_per_op << std::setw(12)
+           << (r.bytes_per_sec > 0 ? human_rate(r.bytes_per_sec) : "-") << "\n";
+    }
+}
+
+void print_csv(std::ostream& os, const std::vector<Result>& results) {
+    os << "name,benchmark,arg,iterations,ns_per_op,ops_per_sec,allocs_per_op,bytes_per_sec,disk_num_blocks\n";
+    os << std::fixed << std::setprecision(3);
+    for (const auto& r : results) {
+        if (!r.skipped.empty()) {
+            continue;
+        }
+        os << r.name << "," << r.benchmark << "," << r.arg << "," << r.iterations << ","
+           << r.ns_per_op << "," << r.ops_per_sec << "," << r.allocs_per_op << ","
+           << r.bytes_per_sec << "," << r.disk_num_blocks << "\n";
+    }
+}
+
+void print_json(std::ostream& os, const std::vector<Result>& results,
+                const Options& opts) {
+    os << std::fixed << std::setprecision(3);
+    os << "{\n  \"context\": {\"min_time_ms\": " << opts.min_time_ms
+       << ", \"disk_block_size\": " << config::DISK_BLOCK_SIZE
+       << ", \"page_frames\": " << config::PAGE_FRAMES
+       << ", \"disk_backend\": \"" << disk_backend_name(g_disk_backend) << "\""
+       << ", \"io_engine\": \"" << async_engine_name(g_io_engine) << "\""
+#ifdef NDEBUG
+       << ", \"assertions\": false"
+#else
+       << ", \"assertions\": true"
+#endif
+       << "},\n  \"benchmarks\": [";
+    bool first = true;
+    for (const auto& r : results) {
+        if (!r.skipped.empty()) {
+            continue;
+        }
+        os << (first ? "\n" : ",\n") << "    {\"name\": \"" << r.name
+           << "\", \"benchmark\": \"" << r.benchmark << "\", \"arg\": " << r.arg
+           << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.ns_per_op
+           << ", \"ops_per_sec\": " << r.ops_per_sec
+           << ", \"allocs_per_op\": " << r.allocs_per_op
+           << ", \"bytes_per_sec\": " << r.bytes_per_sec
+           << ", \"disk_num_blocks\": " << r.disk_num_blocks << "}";
+        first = false;
+    }
+    os << "\n  ]\n}\n";
+}
+
+void usage() {
+    std::cerr << "Usage: tinix_bench [options]\n"
+              << "       tinix_bench macro [macro options]   (see tinix_bench macro --help)\n"
+              << "  --filter=<substr>   Only run benchmarks whose name contains substr\n"
+              << "  --format=<fmt>      Output format: text (default), json, csv\n"
+              << "  --out=<file>        Write results to file instead of stdout\n"
+              << "  --min-time=<ms>     Minimum measured time per benchmark (default 100)\n"
+              << "  --smoke             Run only the first argument of each benchmark; fail if any is skipped\n"
+              << "  --list              List benchmark names and exit\n"
+              << "  --keep              Keep the temporary working directory\n"
+              << "  --disk-backend=<b>  DiskDevice backend: stream (default), mmap, pread, direct, ram, ram-persist\n"
+              << "  --io-engine=<e>     Async I/O engine: auto (default), uring, pool, sync\n";
+}
+
+bool parse_options(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&](const std::string& key) -> const char* {
+            return a.rfind(key, 0) == 0 ? a.c_str() + key.size() : nullptr;
+        };
+        if (const char* v = value("--filter=")) {
+            opts.filter = v;
+        } else if (const char* v = value("--format=")) {
+            opts.format = v;
+        } else if (const char* v = value("--out=")) {
+            opts.out = v;
+        } else if (const char* v = value("--min-time=")) {
+            opts.min_time_ms = std::atof(v);
+        } else if (const char* v = value("--disk-backend=")) {
+            if (!parse_disk_backend(v, g_disk_backend)) {
+                return false;
+            }
+        } else if (const char* v = value("--io-engine=")) {
+            if (!parse_async_engine(v, g_io_engine)) {
+                return false;
+            }
+        } else if (a == "--list") {
+            opts.list = true;
+        } else if (a == "--keep") {
+            opts.keep = true;
+        } else if (a == "--smoke") {
+            opts.smoke = true;
+        } else {
+            return false;
+        }
+    }
+    return opts.format == "text" || opts.format == "json" || opts.format == "csv";
+}
+
+}  // namespace
+
+Registrar::Registrar(const char* name, BenchFn fn, std::vector<int64_t> args) {
+    if (args.empty()) {
+        args.push_back(0);
+    }
+    entries().push_back({name, fn, std::move(args)});
+}
+
+const std::string& work_dir() {
+    return g_work_dir;
+}
+
+DiskBackendKind disk_backend() {
+    return g_disk_backend;
+}
+
+void set_disk_backend(DiskBackendKind kind) {
+    g_disk_backend = kind;
+}
+
+AsyncEngineKind io_engine() {
+    return g_io_engine;
+}
+
+}  // namespace bench
+
+namespace {
+
+bool create_work_dir() {
+    std::string tmpl =
+        (std::filesystem::temp_directory_path() / "tinix_bench_XXXXXX").string();
+    if (!mkdtemp(tmpl.data())) {
+        std::cerr << "tinix_bench: cannot create temporary directory\n";
+        return false;
+    }
+    bench::g_work_dir = tmpl;
+    return true;
+}
+
+void remove_work_dir() {
+    std::error_code ec;
+    std::filesystem::remove_all(bench::g_work_dir, ec);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    using namespace bench;
+
+    // 基准期间关闭日志，避免 stderr 输出干扰计时
+    logging::set_all_levels(logging::Level::Off);
+
+    if (argc > 1 && std::string(argv[1]) == "macro") {
+        if (!create_work_dir()) {
+            return 1;
+        }
+        const int rc = run_macro(argc - 1, argv + 1);
+        remove_work_dir();
+        return rc;
+    }
+
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        usage();
+        return 2;
+    }
+
+    if (opts.list) {
+        for (const auto& e : entries()) {
+            for (int64_t arg : e.args) {
+                std::cout << e.name << "/" << arg << "\n";
+            }
+        }
+        return 0;
+    }
+
+    if (!create_work_dir()) {
+        return 1;
+    }
+
+    std::vector<Result> results;
+    const double min_time_ns = opts.min_time_ms * 1e6;
+    for (const auto& e : entries()) {
+        for (int64_t arg : e.args) {
+            const std::string name = e.name + "/" + std::to_string(arg);
+            if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) {
+                continue;
+            }
+            std::cerr << "running " << name << "...\n";
+            results.push_back(run_one(e, arg, min_time_ns));
+            if (opts.smoke) {
+                break;
+            }
+        }
+    }
+
+    if (!opts.keep) {
+        remove_work_dir();
+    }
+
+    std::ofstream file;
+    if (!opts.out.empty()) {
+        file.open(opts.out);
+        if (!file) {
+            std::cerr << "tinix_bench: cannot write " << opts.out << "\n";
+            return 1;
+        }
+    }
+    std::ostream& os = opts.out.empty() ? std::cout : file;
+
+    if (opts.format == "json") {
+        print_json(os, results, opts);
+    } else if (opts.format == "csv") {
+        print_csv(os, results);
+    } else {
+        print_text(os, results);
+    }
+    // 冒烟运行中任何基准被跳过（准备阶段失败）都视为失败
+    if (opts.smoke) {
+        for (const auto& r : results) {
+            if (!r.skipped.empty()) {
+                std::cerr << "tinix_bench: " << r.name << " skipped: " << r.skipped << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "dev/async_io.h"
+#include "dev/disk_backend.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// tinix_bench 的极简基准框架：
+//   TINIX_BENCHMARK(bench_fn, {参数列表})  注册一个基准，每个参数单独运行一次；
+//   基准函数在 `while (state.keep_running())` 循环中执行被测操作，
+//   循环外或 pause_timing()/resume_timing() 之间的准备工作不计入耗时与分配次数。
+namespace bench {
+
+// 进程内全局堆分配计数（由 bench.cpp 中替换的 operator new 维护）
+uint64_t allocation_count();
+
+class State {
+public:
+    State(uint64_t iterations, int64_t arg) : iterations_(iterations), arg_(arg) {}
+
+    bool keep_running() {
+        if (done_ == 0) {
+            start();
+        }
+        if (done_ < iterations_) {
+            ++done_;
+            return true;
+        }
+        stop();
+        return false;
+    }
+
+    void pause_timing() {
+        elapsed_ += std::chrono::steady_clock::now() - started_;
+        allocs_ += allocation_count() - allocs_at_start_;
+    }
+
+    void resume_timing() {
+        allocs_at_start_ = allocation_count();
+        started_ = std::chrono::steady_clock::now();
+    }
+
+    int64_t arg() const { return arg_; }
+    uint64_t iterations() const { return iterations_; }
+
+    // 每次迭代处理的字节数，用于输出吞吐
+    void set_bytes_per_op(uint64_t bytes) { bytes_per_op_ = bytes; }
+    // 基准实际使用的磁盘块数（几何可能随参数变化）
+    void set_disk_blocks(uint64_t blocks) { disk_blocks_ = blocks; }
+    // 跳过该参数组合（例如准备阶段失败），附带原因
+    void skip(std::string reason) { skip_reason_ = std::move(reason); }
+
+    double elapsed_ns() const {
+        return std::chrono::duration<double, std::nano>(elapsed_).count();
+    }
+    uint64_t allocations() const { return allocs_; }
+    uint64_t bytes_per_op() const { return bytes_per_op_; }
+    uint64_t disk_blocks() const { return disk_blocks_; }
+    const std::string& skip_reason() const { return skip_reason_; }
+
+private:
+    void start() { resume_timing(); }
+    void stop() { pause_timing(); }
+
+    uint64_t iterations_;
+    int64_t arg_;
+    uint64_t done_ = 0;
+    uint64_t allocs_ = 0;
+    uint64_t allocs_at_start_ = 0;
+    uint64_t bytes_per_op_ = 0;
+    uint64_t disk_blocks_ = 0;
+    std::string skip_reason_;
+    std::chrono::steady_clock::time_point started_{};
+    std::chrono::steady_clock::duration elapsed_{};
+};
+
+using BenchFn = void (*)(State&);
+
+struct Registrar {
+    Registrar(const char* name, BenchFn fn, std::vector<int64_t> args);
+};
+
+// 阻止编译器把结果优化掉
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// 基准运行所在的临时目录（磁盘镜像等文件放在这里）
+const std::string& work_dir();
+
+// 基准中创建 DiskDevice 时使用的后端（--disk-backend=）
+DiskBackendKind disk_backend();
+void set_disk_backend(DiskBackendKind kind);
+// 异步 I/O 基准使用的引擎（--io-engine=）
+AsyncEngineKind io_engine();
+
+// `tinix_bench macro ...`：合成负载端到端基准（macro_benchmark.cpp）
+int run_macro(int argc, char** argv);
+
+}  // namespace bench
+
+#define TINIX_BENCH_CONCAT_(a, b) a##b
+#define TINIX_BENCH_CONCAT(a, b) TINIX_BENCH_CONCAT_(a, b)
+#define TINIX_BENCHMARK(fn, ...)                                              \
+    static ::bench::Registrar TINIX_BENCH_CONCAT(tinix_bench_reg_, __LINE__)( \
+        #fn, fn, std::vector<int64_t> __VA_ARGS__)
@@ -0,0 +1,245 @@
+// 端到端宏基准：用合成负载创建 N 个进程，推进 M 个 tick，
+// 报告 ticks/s、instructions/s 与峰值 RSS。模拟结果（指令数、缺页数等）只取决于种子与参数。
+#include "bench.h"
+#include "common/metrics.h"
+#include "dev/device_manager.h"
+#include "dev/disk.h"
+#include "fs/file_system.h"
+#include "mem/memory_manager.h"
+#include "proc/process_manager.h"
+#include "proc/workload.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <sys/resource.h>
+
+namespace bench {
+
+namespace {
+
+struct MacroOptions {
+    uint64_t procs = 1000;
+    uint64_t ticks = 20000;
+    std::string format = "text";  // text | json
+    workload::Params params;
+    bool disk_timing = false;
+    DiskSchedPolicy disk_sched = DiskSchedPolicy::Fcfs;
+};
+
+void macro_usage() {
+    std::cerr << "Usage: tinix_bench macro [options]\n"
+              << "  --procs=<n>         Number of generated processes (default 1000)\n"
+              << "  --ticks=<n>         Simulated ticks to run (default 20000)\n"
+              << "  --seed=<n>          Workload seed (default 1)\n"
+              << "  --length=<n>        Instructions per process (default 200)\n"
+              << "  --mix=<k=v,...>     Weights: compute,read,write,file,device,sleep\n"
+              << "  --access=<p>        uniform | sequential | strided | zipfian\n"
+              << "  --pages=<n>         Virtual pages touched per process\n"
+              << "  --stride=<n>        Page stride for strided access (default 4)\n"
+              << "  --theta=<x>         Zipfian skew (default 0.99)\n"
+              << "  --files=<n>         Number of shared files (default 16)\n"
+              << "  --io=<lo>-<hi>      File read/write size range in bytes (default 64-4096)\n"
+              << "  --devices=<n>       Number of contended devices (default 1)\n"
+              << "  --format=<fmt>      text (default) | json\n"
+              << "  --disk-backend=<b>  stream (default) | mmap | pread | direct | ram | ram-persist\n"
+              << "  --disk-sched=<p>    Enable the simulated disk timing model with policy\n"
+              << "                      fcfs | sstf | scan | clook, and compare all policies\n";
+}
+
+bool parse_macro_options(int argc, char** argv, MacroOptions& opts) {
+    workload::Params& p = opts.params;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&](const std::string& key) -> const char* {
+            return a.rfind(key, 0) == 0 ? a.c_str() + key.size() : nullptr;
+        };
+        auto number = [](const char* v) { return std::strtoull(v, nullptr, 0); };
+        if (const char* v = value("--procs=")) {
+            opts.procs = number(v);
+        } else if (const char* v = value("--ticks=")) {
+            opts.ticks = number(v);
+        } else if (const char* v = value("--seed=")) {
+            p.seed = number(v);
+        } else if (const char* v = value("--length=")) {
+            p.program_length = number(v);
+        } else if (const char* v = value("--mix=")) {
+            if (!workload::parse_mix(v, p.mix)) {
+                return false;
+            }
+        } else if (const char* v = value("--access=")) {
+            if (!workload::parse_access_pattern(v, p.access)) {
+                return false;
+            }
+        } else if (const char* v = value("--pages=")) {
+            p.virtual_pages = number(v);
+        } else if (const char* v = value("--stride=")) {
+            p.stride_pages = number(v);
+        } else if (const char* v = value("--theta=")) {
+            p.zipf_theta = std::atof(v);
+        } else if (const char* v = value("--files=")) {
+            p.num_files = static_cast<uint32_t>(number(v));
+        } else if (const char* v = value("--io=")) {
+            char* end = nullptr;
+            p.min_io_bytes = static_cast<uint32_t>(std::strtoul(v, &end, 0));
+            if (*end != '-') {
+                return false;
+            }
+            p.max_io_bytes = static_cast<uint32_t>(std::strtoul(end + 1, nullptr, 0));
+        } else if (const char* v = value("--devices=")) {
+            p.num_devices = static_cast<uint32_t>(number(v));
+        } else if (const char* v = value("--format=")) {
+            opts.format = v;
+        } else if (const char* v = value("--disk-backend=")) {
+            DiskBackendKind kind;
+            if (!parse_disk_backend(v, kind)) {
+                return false;
+            }
+            set_disk_backend(kind);
+        } else if (const char* v = value("--disk-sched=")) {
+            if (!parse_disk_sched_policy(v, opts.disk_sched)) {
+                return false;
+            }
+            opts.disk_timing = true;
+        } else {
+            return false;
+        }
+    }
+    return opts.format == "text" || opts.format == "json";
+}
+
+uint64_t counter_value(const char* name) {
+    return metrics::registry().counter(name, "").value();
+}
+
+long peak_rss_kb() {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;  // Linux 下单位为 KB
+}
+
+}  // namespace
+
+int run_macro(int argc, char** argv) {
+    MacroOptions opts;
+    if (!parse_macro_options(argc, argv, opts)) {
+        macro_usage();
+        return 2;
+    }
+    const workload::Params& p = opts.params;
+
+    DiskDevice disk(work_dir() + "/macro.img", disk_backend());
+    DeviceManager devices;
+    for (uint32_t d = 1; d < p.num_devices; ++d) {
+        devices.register_device(d, "dev" + std::to_string(d));
+    }
+    FileSystem fs(&disk);
+    fs.format();
+    for (uint32_t f = 0; f < p.num_files; ++f) {
+        fs.create_file(workload::file_path(f));
+    }
+    MemoryManager mm(disk);
+    ProcessManager pm(mm, devices, fs);
+    if (opts.disk_timing) {
+        pm.enable_disk_timing(disk, opts.disk_sched);
+    }
+
+    workload::Generator gen(p);
+    const auto setup_start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < opts.procs; ++i) {
+        pm.create_process_with_program(gen.make_program(i));
+    }
+    const double setup_s = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - setup_start).count();
+
+    const char* const kCounters[] = {"proc_instructions_total", "proc_idle_ticks_total",
+                                     "mem_page_faults_total", "proc_terminated_total",
+                                     "disk_reads_total", "disk_writes_total"};
+    uint64_t before[std::size(kCounters)];
+    for (size_t i = 0; i < std::size(kCounters); ++i) {
+        before[i] = counter_value(kCounters[i]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t t = 0; t < opts.ticks; ++t) {
+        pm.tick();
+    }
+    const double run_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t delta[std::size(kCounters)];
+    for (size_t i = 0; i < std::size(kCounters); ++i) {
+        delta[i] = counter_value(kCounters[i]) - before[i];
+    }
+    const uint64_t instructions = delta[0];
+    const uint64_t idle = delta[1];
+    const uint64_t faults = delta[2];
+    const uint64_t terminated = delta[3];
+    const uint64_t disk_reads = delta[4];
+    const uint64_t disk_writes = delta[5];
+    const double ticks_per_s = run_s > 0 ? static_cast<double>(opts.ticks) / run_s : 0;
+    const double instr_per_s = run_s > 0 ? static_cast<double>(instructions) / run_s : 0;
+    const long rss_kb = peak_rss_kb();
+
+    std::ostream& os = std::cout;
+    if (opts.format == "json") {
+        os << std::fixed << std::setprecision(3) << "{\n"
+           << "  \"workload\": {\"seed\": " << p.seed << ", \"procs\": " << opts.procs
+           << ", \"ticks\": " << opts.ticks << ", \"length\": " << p.program_length
+           << ", \"access\": \"" << workload::access_pattern_name(p.access)
+           << "\", \"disk_backend\": \"" << disk_backend_name(disk_backend())
+           << "\", \"devices\": " << p.num_devices << ", \"files\": " << p.num_files
+           << "},\n"
+           << "  \"simulation\": {\"instructions\": " << instructions
+           << ", \"idle_ticks\": " << idle << ", \"page_faults\": " << faults
+           << ", \"terminated\": " << terminated << ", \"disk_reads\": " << disk_reads
+           << ", \"disk_writes\": " << disk_writes << "},\n"
+           << "  \"performance\": {\"setup_seconds\": " << setup_s
+           << ", \"run_seconds\": " << run_s << ", \"ticks_per_sec\": " << ticks_per_s
+           << ", \"instructions_per_sec\": " << instr_per_s
+           << ", \"peak_rss_kb\": " << rss_kb << "}";
+        if (const DiskScheduler* sched = pm.get_disk_scheduler()) {
+            // 同一到达序列在各策略下的回放结果
+            os << ",\n  \"disk_sched\": {\"policy\": \""
+               << disk_sched_policy_name(sched->policy()) << "\", \"replay\": [";
+            const char* sep = "";
+            for (auto policy : {DiskSchedPolicy::Fcfs, DiskSchedPolicy::Sstf,
+                                DiskSchedPolicy::Scan, DiskSchedPolicy::CLook}) {
+                const DiskSchedStats st = sched->replay(policy);
+                os << sep << "\n    {\"policy\": \"" << disk_sched_policy_name(policy)
+                   << "\", \"requests\": " << st.requests
+                   << ", \"throughput\": " << st.throughput()
+                   << ", \"mean_latency\": " << st.mean_latency()
+                   << ", \"p50\": " << st.percentile(50) << ", \"p95\": " << st.percentile(95)
+                   << ", \"p99\": " << st.percentile(99)
+                   << ", \"head_movement\": " << st.head_movement << "}";
+                sep = ",";
+            }
+            os << "]}";
+        }
+        os << "\n}\n";
+    } else {
+        os << "workload: seed=" << p.seed << " procs=" << opts.procs
+           << " ticks=" << opts.ticks << " length=" << p.program_length
+           << " access=" << workload::access_pattern_name(p.access)
+           << " disk=" << disk_backend_name(disk_backend())
+           << " devices=" << p.num_devices << " files=" << p.num_files << "\n"
+           << "simulation: instructions=" << instructions << " idle_ticks=" << idle
+           << " page_faults=" << faults << " terminated=" << terminated
+           << " disk_reads=" << disk_reads << " disk_writes=" << disk_writes << "\n"
+           << std::fixed << std::setprecision(1)
+           << "performance: setup=" << setup_s * 1e3 << "ms run=" << run_s * 1e3
+           << "ms ticks/s=" << ticks_per_s << " instructions/s=" << instr_per_s
+           << " peak_rss=" << rss_kb << "KB\n";
+        if (const DiskScheduler* sched = pm.get_disk_scheduler()) {
+            sched->dump(os);
+            sched->dump_comparison(os);
+        }
+    }
+    return 0;
+}
+
+}  // namespace bench
@@ -0,0 +1,293 @@
+// 内核原语微基准：直接调用 DiskDevice / InodeManager / DirectoryManager /
+// FileSystem / MemoryManager / ProcessManager，不经过 Shell。
+#include "bench.h"
+#include "dev/device_manager.h"
+#include "dev/disk.h"
+#include "fs/block_manager.h"
+#include "fs/block_map.h"
+#include "fs/directory_manager.h"
+#include "fs/file_system.h"
+#include "fs/inode_manager.h"
+#include "mem/memory_manager.h"
+#include "proc/process_manager.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 每个基准使用工作目录下的全新磁盘镜像
+std::string fresh_image(const std::string& name) {
+    const std::string path = bench::work_dir() + "/" + name + ".img";
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return path;
+}
+
+// ---- DiskDevice ----
+
+void disk_read_block(bench::State& state) {
+    DiskDevice disk(fresh_image("disk_read"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    const size_t span = static_cast<size_t>(state.arg());
+    std::vector<uint8_t> buf(disk.get_block_size());
+    size_t i = 0;
+    while (state.keep_running()) {
+        disk.read_block(i++ % span, buf.data());
+    }
+    state.set_bytes_per_op(disk.get_block_size());
+}
+TINIX_BENCHMARK(disk_read_block, {1, 64, 1024});
+
+void disk_write_block(bench::State& state) {
+    DiskDevice disk(fresh_image("disk_write"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    const size_t span = static_cast<size_t>(state.arg());
+    std::vector<uint8_t> buf(disk.get_block_size(), 0xab);
+    size_t i = 0;
+    while (state.keep_running()) {
+        disk.write_block(i++ % span, buf.data());
+    }
+    state.set_bytes_per_op(disk.get_block_size());
+}
+TINIX_BENCHMARK(disk_write_block, {1, 64, 1024});
+
+// 每次写入后立即 barrier，测量写回缓冲之下后端本身的写入成本
+void disk_write_through(bench::State& state) {
+    DiskDevice disk(fresh_image("disk_write_through"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    const size_t span = static_cast<size_t>(state.arg());
+    std::vector<uint8_t> buf(disk.get_block_size(), 0xcd);
+    size_t i = 0;
+    while (state.keep_running()) {
+        disk.write_block(i++ % span, buf.data());
+        disk.barrier();
+    }
+    state.set_bytes_per_op(disk.get_block_size());
+}
+TINIX_BENCHMARK(disk_write_through, {1, 64, 1024});
+
+// 参数为队列深度：逐块异步提交写，队列满时回收；计时包含最终的 wait_io
+void disk_async_write(bench::State& state) {
+    DiskDevice disk(fresh_image("disk_async_write"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    disk.configure_async(bench::io_engine(), static_cast<size_t>(state.arg()));
+    std::vector<uint8_t> buf(disk.get_block_size(), 0xef);
+    size_t i = 0;
+    while (state.keep_running()) {
+        disk.submit_write(i++ % disk.get_num_blocks(), buf.data());
+    }
+    state.resume_timing();
+    disk.wait_io();
+    state.pause_timing();
+    state.set_bytes_per_op(disk.get_block_size());
+}
+TINIX_BENCHMARK(disk_async_write, {1, 8, 32});
+
+// ---- InodeManager ----
+
+void inode_read(bench::State& state) {
+    DiskDevice disk(fresh_image("inode_read"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    FileSystem fs(&disk);
+    fs.format();
+    InodeManager inodes(&fs.buffer_cache(), &fs.superblock());
+    const uint32_t span = static_cast<uint32_t>(state.arg());
+    Inode inode;
+    uint32_t i = 0;
+    while (state.keep_running()) {
+        inodes.read_inode(i++ % span, inode);
+        bench::do_not_optimize(inode);
+    }
+}
+TINIX_BENCHMARK(inode_read, {1, 32, 128});
+
+// ---- DirectoryManager ----
+
+// 参数为路径深度：/d1/d2/.../dN/f
+void dir_lookup_path(bench::State& state) {
+    DiskDevice disk(fresh_image("dir_lookup"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    FileSystem fs(&disk);
+    fs.format();
+    std::string path;
+    for (int64_t d = 1; d <= state.arg(); ++d) {
+        path += "/d" + std::to_string(d);
+        fs.create_directory(path);
+    }
+    path += "/f";
+    fs.create_file(path);
+    // 下面另起的管理器直接读盘上的位图与 inode 表，先提交成组未写的元数据
+    fs.sync();
+
+    InodeManager inodes(&fs.buffer_cache(), &fs.superblock());
+    BlockManager blocks(&fs.buffer_cache(), &fs.superblock());
+    blocks.load_bitmaps();
+    BlockMap block_map(&fs.buffer_cache(), &blocks);
+    DirectoryManager dirs(&fs.buffer_cache(), &inodes, &blocks, &block_map);
+    if (dirs.lookup_path(path, "/") == INVALID_INODE) {
+        state.skip("setup failed: " + path);
+        return;
+    }
+
+    while (state.keep_running()) {
+        bench::do_not_optimize(dirs.lookup_path(path, "/"));
+    }
+}
+TINIX_BENCHMARK(dir_lookup_path, {1, 4, 8});
+
+// ---- FileSystem ----
+
+void fs_read_file(bench::State& state) {
+    DiskDevice disk(fresh_image("fs_read"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    FileSystem fs(&disk);
+    fs.format();
+    const size_t size = static_cast<size_t>(state.arg());
+    std::vector<uint8_t> data(size, 0x5a);
+    fs.create_file("/f");
+    int fd = fs.open_file("/f");
+    if (fs.write_file(fd, data.data(), size) != static_cast<ssize_t>(size)) {
+        state.skip("setup failed: short write");
+        return;
+    }
+    fs.close_file(fd);
+
+    fd = fs.open_file("/f");
+    bool first = true;
+    while (state.keep_running()) {
+        if (!first) {
+            state.pause_timing();
+            fs.close_file(fd);
+            fd = fs.open_file("/f");
+            state.resume_timing();
+        }
+        first = false;
+        bench::do_not_optimize(fs.read_file(fd, data.data(), size));
+    }
+    fs.close_file(fd);
+    state.set_bytes_per_op(size);
+}
+TINIX_BENCHMARK(fs_read_file, {64, 4096, 40960, 1048576});
+
+void fs_write_file(bench::State& state) {
+    DiskDevice disk(fresh_image("fs_write"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    FileSystem fs(&disk);
+    fs.format();
+    const size_t size = static_cast<size_t>(state.arg());
+    std::vector<uint8_t> data(size, 0xa5);
+    fs.create_file("/f");
+
+    int fd = fs.open_file("/f");
+    bool first = true;
+    while (state.keep_running()) {
+        if (!first) {
+            state.pause_timing();
+            fs.close_file(fd);
+            fd = fs.open_file("/f");
+            state.resume_timing();
+        }
+        first = false;
+        bench::do_not_optimize(fs.write_file(fd, data.data(), size));
+    }
+    fs.close_file(fd);
+    state.set_bytes_per_op(size);
+}
+TINIX_BENCHMARK(fs_write_file, {64, 4096, 40960});
+
+// 参数为元数据成组提交的操作数：1 即每次创建/删除都写位图、超级块并提交
+void fs_create_remove(bench::State& state) {
+    DiskDevice disk(fresh_image("fs_create"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    FileSystem fs(&disk);
+    fs.format();
+    fs.set_commit_interval(static_cast<size_t>(state.arg()), config::METADATA_COMMIT_TICKS);
+    while (state.keep_running()) {
+        fs.create_file("/f");
+        fs.remove_file("/f");
+    }
+}
+TINIX_BENCHMARK(fs_create_remove, {1, 32});
+
+// 参数为磁盘块数：数据区先占满九成，之后每次分配一块并释放最早分配的块。
+// 分配从轮转提示处按 64 位字查找，不随已占用的前缀变长
+void fs_block_alloc(bench::State& state) {
+    DiskGeometry geometry;
+    geometry.num_blocks = static_cast<size_t>(state.arg());
+    DiskDevice disk(fresh_image("block_alloc"), bench::disk_backend(), geometry);
+    state.set_disk_blocks(disk.get_num_blocks());
+    FileSystem fs(&disk);
+    fs.format();
+    BlockManager blocks(&fs.buffer_cache(), &fs.superblock());
+    blocks.load_bitmaps();
+    const uint32_t fill = blocks.free_blocks() / 10 * 9;
+    for (uint32_t done = 0; done < fill;) {
+        done += blocks.alloc_extent(INVALID_BLOCK, fill - done).length;
+    }
+
+    std::vector<uint32_t> ring(64, INVALID_BLOCK);
+    size_t i = 0;
+    while (state.keep_running()) {
+        uint32_t& slot = ring[i++ % ring.size()];
+        if (slot != INVALID_BLOCK) {
+            blocks.free_block(slot);
+        }
+        slot = blocks.alloc_block();
+        bench::do_not_optimize(slot);
+    }
+}
+TINIX_BENCHMARK(fs_block_alloc, {1024, 262144});
+
+// ---- MemoryManager ----
+
+// 参数为循环访问的页数：不超过 PAGE_FRAMES 时全部命中，超过后每次访问都缺页
+void mem_access(bench::State& state) {
+    DiskDevice disk(fresh_image("mem_access"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    MemoryManager mm(disk);
+    mm.create_process_memory(1, config::DEFAULT_VIRTUAL_PAGES);
+    const uint64_t pages = static_cast<uint64_t>(state.arg());
+    uint64_t i = 0;
+    while (state.keep_running()) {
+        mm.access_memory(1, (i++ % pages) * config::PAGE_SIZE, AccessType::Read);
+    }
+}
+TINIX_BENCHMARK(mem_access, {4, 8, 64});
+
+// ---- ProcessManager ----
+
+// 参数为并发的纯计算进程数；指令耗尽时（不计时）重新创建一批进程
+void proc_tick(bench::State& state) {
+    constexpr int kProgramLength = 4096;
+    DiskDevice disk(fresh_image("proc_tick"), bench::disk_backend());
+    state.set_disk_blocks(disk.get_num_blocks());
+    DeviceManager devices;
+    FileSystem fs(&disk);
+    fs.format();
+    MemoryManager mm(disk);
+    ProcessManager pm(mm, devices, fs);
+
+    const int procs = static_cast<int>(state.arg());
+    const uint64_t ticks_per_batch = static_cast<uint64_t>(procs) * kProgramLength;
+    auto spawn = [&] {
+        for (int p = 0; p < procs; ++p) {
+            pm.create_process(kProgramLength);
+        }
+    };
+    spawn();
+
+    uint64_t ticks = 0;
+    while (state.keep_running()) {
+        if (ticks++ == ticks_per_batch) {
+            state.pause_timing();
+            spawn();
+            ticks = 1;
+            state.resume_timing();
+        }
+        pm.tick();
+    }
+}
+TINIX_BENCHMARK(proc_tick, {1, 8, 64});
+
+}  // namespace
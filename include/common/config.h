@@ -1,5 +1,6 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 
 namespace config {
 
@@ -11,14 +12,34 @@ constexpr size_t DEFAULT_VIRTUAL_PAGES = 256;  // 每个进程虚拟空间页数
 // disk
 constexpr const char* DISK_IMAGE_NAME = "disk.img";
 constexpr size_t DISK_BLOCK_SIZE = 0x1000;  // 块大小 4 KB
-constexpr size_t DISK_NUM_BLOCKS = 1024;    // 总块数
+constexpr size_t DISK_NUM_BLOCKS = 1024;    // 新镜像的默认总块数（--disk-blocks 可覆盖）
+constexpr size_t DISK_WRITEBACK_MAX_BLOCKS = 256;  // 写回缓冲上限，超出时提前回写
+constexpr size_t DISK_IO_QUEUE_DEPTH = 32;         // 异步 I/O 默认队列深度
+constexpr size_t DISK_IO_WORKERS = 2;              // 无 io_uring 时的 I/O 工作线程数
+constexpr size_t DISK_IO_MAX_RUN_BLOCKS = 64;      // 合并回写时单个异步请求的最大块数
+constexpr size_t BUFFER_CACHE_BLOCKS = 256;        // 文件系统块缓冲缓存容量（--buffer-cache 可覆盖）
+constexpr size_t INODE_CACHE_ENTRIES = 128;        // 内存 inode 表容量（被引用的 inode 不计入淘汰）
+constexpr size_t DENTRY_CACHE_ENTRIES = 1024;      // 目录项缓存容量（含否定项）
+constexpr size_t READAHEAD_MIN_BLOCKS = 2;         // 顺序读的初始预读窗口
+constexpr size_t READAHEAD_MAX_BLOCKS = 16;        // 预读窗口上限（另受缓存容量的 1/4 限制）
+constexpr size_t DELALLOC_MAX_BLOCKS = 64;         // 延迟分配的数据块总数上限，超出时立即刷出
+constexpr uint64_t DELALLOC_FLUSH_TICKS = 5;       // 延迟分配的数据最多停留的 tick 数
+constexpr size_t METADATA_COMMIT_OPS = 32;         // 累计多少个元数据操作成组提交一次
+constexpr uint64_t METADATA_COMMIT_TICKS = 5;      // 未提交的元数据最多停留的 tick 数
+constexpr uint32_t JOURNAL_BLOCKS = 32;            // 元数据日志区块数（另受 FS 分区的 1/16 限制）
+constexpr uint32_t JOURNAL_MIN_BLOCKS = 8;         // 分区太小、日志不足此数时不建日志
+constexpr uint32_t FS_BLOCKS_PER_GROUP = 8192;     // 块组大小（另受一个位图块的位数限制）
 
-// swap
+// swap（镜像末尾的保留区；--swap-blocks 可覆盖，格式化时记录在超级块中）
 constexpr size_t SWAP_RESERVED_BLOCKS = 128;
-constexpr size_t SWAP_START_BLOCK = DISK_NUM_BLOCKS - SWAP_RESERVED_BLOCKS;
 
 static_assert(SWAP_RESERVED_BLOCKS < DISK_NUM_BLOCKS);
 
 // proc
 constexpr int DEFAULT_TIME_SLICE = 3;  // 时间片长度
+
+// trace
+constexpr size_t TRACE_RING_CAPACITY = 1 << 16;  // 事件环形缓冲容量（须为 2 的幂）
+
+static_assert((TRACE_RING_CAPACITY & (TRACE_RING_CAPACITY - 1)) == 0);
 }
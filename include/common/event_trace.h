@@ -0,0 +1,132 @@
+#pragma once
+#include "common/config.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace trace {
+
+enum class EventType : uint8_t {
+    TickStart,   // pid=当前运行进程, aux=进程总数
+    Schedule,    // pid=被调度进程
+    PageFault,   // pid, arg=虚页号, aux=访问类型(0读/1写)
+    Evict,       // pid=牺牲进程, arg=虚页号, aux=页框号
+    SwapIn,      // pid, arg=虚页号, aux=swap 块号
+    SwapOut,     // pid=牺牲进程, arg=虚页号, aux=swap 块号
+    DevGrant,    // pid=新 owner, aux=设备号
+    DevQueue,    // pid=排队进程, aux=设备号, arg=队列长度
+    DevRelease,  // pid=释放者, aux=设备号
+    FsOp,        // aux=FsOpKind, arg=inode 或字节数
+    Preempt,     // pid=被手动抢占的进程
+    SliceExpired,  // pid=时间片用完的进程
+    Block,       // pid, aux=BlockReason, arg=睡眠时长或设备号
+    Wakeup,      // pid=重新就绪的进程
+    Exit,        // pid=完成或被终止的进程
+    Count
+};
+
+enum class FsOpKind : uint32_t { Create, Remove, Mkdir, Open, Close, Read, Write };
+
+// 定长二进制事件记录（32 字节），直接按内存布局写入 trace 文件。
+struct Event {
+    uint64_t tick;
+    uint64_t arg;
+    int32_t pid;
+    uint32_t aux;
+    EventType type;
+    uint8_t padding[7];
+};
+
+static_assert(sizeof(Event) == 32, "Event must stay 32 bytes");
+
+// trace 文件格式：TraceFileHeader 之后紧跟若干 Event（小端、按时间顺序）。
+struct TraceFileHeader {
+    char magic[8];        // "TNXTRACE"
+    uint32_t version;     // 当前为 1
+    uint32_t event_size;  // sizeof(Event)
+};
+
+// 预分配的单生产者环形缓冲：记录只做一次定长写入，不分配内存；
+// 写满后覆盖最旧事件，若开启流式输出则在覆盖前整段写入文件。
+// 可挂接一个 tap 向量，额外保留完整事件序列（供时间线导出使用）。
+class EventRing {
+public:
+    explicit EventRing(size_t capacity = config::TRACE_RING_CAPACITY);
+    ~EventRing();
+
+    void record(EventType type, int pid, uint32_t aux = 0, uint64_t arg = 0) {
+        if (tap_) {
+            tap_->push_back(Event{tick_, arg, pid, aux, type, {}});
+        }
+        if (!enabled_) {
+            return;
+        }
+        if (streaming_ && head_ - flushed_ == events_.size()) {
+            flush_stream();
+        }
+        Event& ev = events_[head_ & mask_];
+        ev.tick = tick_;
+        ev.arg = arg;
+        ev.pid = pid;
+        ev.aux = aux;
+        ev.type = type;
+        ++head_;
+    }
+
+    void set_tap(std::vector<Event>* tap) { tap_ = tap; }
+
+    void set_tick(uint64_t tick) { tick_ = tick; }
+    uint64_t tick() const { return tick_; }
+
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_; }
+
+    size_t capacity() const { return events_.size(); }
+    size_t size() const;
+    uint64_t total_recorded() const { return head_; }
+    uint64_t overwritten() const;
+    void clear();
+
+    // 按时间顺序（旧 -> 新）访问缓冲中的最后 n 个事件。
+    template <typename F>
+    void for_each_recent(size_t n, F&& fn) const {
+        const size_t count = std::min(n, size());
+        for (uint64_t i = head_ - count; i < head_; ++i) {
+            fn(events_[i & mask_]);
+        }
+    }
+
+    void dump_text(std::ostream& os, size_t n) const;
+    bool save(const std::string& filename) const;
+
+    // 流式输出：缓冲写满前整段落盘，stop 时写出剩余事件。
+    bool start_stream(const std::string& filename);
+    void stop_stream();
+    bool is_streaming() const { return streaming_; }
+
+private:
+    std::vector<Event> events_;
+    uint64_t mask_;
+    uint64_t head_ = 0;
+    uint64_t flushed_ = 0;
+    uint64_t tick_ = 0;
+    bool enabled_ = true;
+    bool streaming_ = false;
+    std::ofstream stream_;
+    std::vector<Event>* tap_ = nullptr;
+
+    void flush_stream();
+};
+
+const char* event_name(EventType type);
+
+inline EventRing g_ring;
+
+inline void record(EventType type, int pid, uint32_t aux = 0, uint64_t arg = 0) {
+    g_ring.record(type, pid, aux, arg);
+}
+
+}  // namespace trace
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+
+// 编译期日志上限：高于该级别的日志语句在编译期被整体剔除。
+// 0=Off 1=Error 2=Warn 3=Info 4=Debug，可通过 CMake 选项 TINIX_LOG_MAX_LEVEL 设置。
+#ifndef TINIX_LOG_MAX_LEVEL
+#define TINIX_LOG_MAX_LEVEL 4
+#endif
+
+namespace logging {
+
+enum class Level : uint8_t { Off = 0, Error = 1, Warn = 2, Info = 3, Debug = 4 };
+
+enum class Subsystem : uint8_t { Kernel, Proc, Memory, Swap, FS, Dev, Disk, Count };
+
+constexpr size_t kSubsystemCount = static_cast<size_t>(Subsystem::Count);
+
+// 运行期各子系统日志级别；默认 Debug，保持与原先全量输出一致。
+inline Level g_levels[kSubsystemCount] = {
+    Level::Debug, Level::Debug, Level::Debug, Level::Debug,
+    Level::Debug, Level::Debug, Level::Debug,
+};
+
+inline bool enabled(Subsystem sub, Level level) {
+    return level <= g_levels[static_cast<size_t>(sub)];
+}
+
+void set_level(Subsystem sub, Level level);
+void set_all_levels(Level level);
+Level get_level(Subsystem sub);
+
+const char* subsystem_name(Subsystem sub);
+const char* level_name(Level level);
+std::optional<Subsystem> parse_subsystem(const std::string& name);
+std::optional<Level> parse_level(const std::string& name);
+
+// 组装一行日志，析构时一次性写出（自动追加换行）。
+class LogLine {
+public:
+    LogLine();
+    ~LogLine();
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    std::ostream& stream();
+};
+
+}  // namespace logging
+
+#define TINIX_LOG(sub, lvl, msg)                                            \
+    do {                                                                    \
+        if constexpr (static_cast<int>(::logging::Level::lvl) <=            \
+                      TINIX_LOG_MAX_LEVEL) {                                \
+            if (::logging::enabled(::logging::Subsystem::sub,               \
+                                   ::logging::Level::lvl)) {                \
+                ::logging::LogLine tinix_log_line_;                         \
+                tinix_log_line_.stream() << msg;                            \
+            }                                                               \
+        }                                                                   \
+    } while (0)
+
+#define LOG_ERROR(sub, msg) TINIX_LOG(sub, Error, msg)
+#define LOG_WARN(sub, msg) TINIX_LOG(sub, Warn, msg)
+#define LOG_INFO(sub, msg) TINIX_LOG(sub, Info, msg)
+#define LOG_DEBUG(sub, msg) TINIX_LOG(sub, Debug, msg)
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace metrics {
+
+// 单调递增计数器
+class Counter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// 可增可减的瞬时值
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { set(0); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// 以 2 的幂为桶边界的直方图：桶 i 统计 (2^(i-1), 2^i] 内的观测值。
+class Histogram {
+public:
+    static constexpr size_t kBuckets = 48;
+
+    void observe(uint64_t v) {
+        buckets_[bucket_index(v)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(v, std::memory_order_relaxed);
+        uint64_t cur = max_.load(std::memory_order_relaxed);
+        while (v > cur &&
+               !max_.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t bucket(size_t i) const {
+        return buckets_[i].load(std::memory_order_relaxed);
+    }
+    static uint64_t bucket_bound(size_t i) { return uint64_t{1} << i; }
+
+    // 估算分位数（返回所在桶的上界）
+    uint64_t percentile(double p) const;
+    void reset();
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets]{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+
+    static size_t bucket_index(uint64_t v) {
+        if (v <= 1) {
+            return 0;
+        }
+        const size_t idx = 64 - static_cast<size_t>(__builtin_clzll(v - 1));
+        return idx < kBuckets ? idx : kBuckets - 1;
+    }
+};
+
+// 全局指标注册表：按名称注册，重复注册返回同一实例，地址在进程生命周期内稳定。
+class Registry {
+public:
+    Counter& counter(const std::string& name, const std::string& help);
+    Gauge& gauge(const std::string& name, const std::string& help);
+    Histogram& histogram(const std::string& name, const std::string& help);
+
+    // 清零计数器与直方图；仪表反映当前状态（缓存项数、脏块数等），保持不变
+    void reset();
+
+    void dump_table(std::ostream& os) const;
+    void write_prometheus(std::ostream& os) const;
+    void write_json(std::ostream& os) const;
+
+private:
+    template <typename T>
+    struct Entry {
+        std::string help;
+        std::unique_ptr<T> metric;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry<Counter>> counters_;
+    std::map<std::string, Entry<Gauge>> gauges_;
+    std::map<std::string, Entry<Histogram>> histograms_;
+};
+
+Registry& registry();
+
+// 作用域计时器：析构时把耗时（纳秒）记入直方图
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& hist)
+        : hist_(hist), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        hist_.observe(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& hist_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace metrics
@@ -0,0 +1,41 @@
+#pragma once
+#include "common/event_trace.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace trace {
+
+// 调度时间线：录制期间把完整事件序列缓存在内存中（不落盘），
+// 按需或退出时一次性导出为 Chrome trace-event / Perfetto 可读的 JSON。
+// 时间戳单位为模拟 tick；每个 PID、每个设备各占一条轨道。
+class Timeline {
+public:
+    explicit Timeline(EventRing& ring) : ring_(ring) {}
+    ~Timeline();
+
+    // 开始录制（清空旧数据）；若给出路径，则在 finish() 时自动导出。
+    void start(const std::string& auto_save_path = "");
+    void stop();
+    void clear() { events_.clear(); }
+
+    bool is_recording() const { return recording_; }
+    size_t size() const { return events_.size(); }
+
+    bool write_chrome_json(const std::string& filename) const;
+    void write_chrome_json(std::ostream& os) const;
+
+    // 程序退出前调用：停止录制，并导出到 start() 指定的路径（如有）。
+    bool finish();
+
+private:
+    EventRing& ring_;
+    std::vector<Event> events_;
+    bool recording_ = false;
+    std::string auto_save_path_;
+};
+
+inline Timeline g_timeline{g_ring};
+
+}  // namespace trace
@@ -0,0 +1,62 @@
+#pragma once
+#include "dev/disk_backend.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+// 异步块 I/O 引擎。DiskDevice 负责请求的生命周期、队列深度与一致性，
+// 引擎只负责把请求交给内核（io_uring）或工作线程，并回收完成的请求。
+enum class AsyncEngineKind {
+    Auto,   // 后端有文件描述符且内核支持时用 io_uring，否则用线程池
+    Uring,
+    Pool,
+    Sync,   // 不使用引擎，submit_* 退化为同步读写（与旧行为一致）
+};
+
+bool parse_async_engine(const std::string& s, AsyncEngineKind& out);
+const char* async_engine_name(AsyncEngineKind kind);
+
+using IoCallback = std::function<void(bool ok)>;
+
+struct IoRequest {
+    struct AlignedFree {
+        void operator()(uint8_t* p) const { std::free(p); }
+    };
+
+    bool write = false;
+    size_t block_id = 0;
+    size_t count = 1;                            // 从 block_id 起的连续块数
+    std::unique_ptr<uint8_t, AlignedFree> data;  // count 个块的对齐缓冲（满足 O_DIRECT）
+    uint8_t* read_target = nullptr;              // 读请求完成后拷贝到此处
+    IoCallback done;
+    bool ok = false;
+    std::chrono::steady_clock::time_point submitted;
+    iovec iov{};
+};
+
+class AsyncIoEngine {
+public:
+    virtual ~AsyncIoEngine() = default;
+
+    // 排队一个请求（调用方保证在途请求数不超过创建时的队列深度）
+    virtual bool submit(IoRequest* req) = 0;
+    // 将已排队的请求真正提交（io_uring 一次 enter 提交一批）
+    virtual void kick() {}
+    // 取回已完成的请求；wait 为 true 时至少等到一个完成
+    virtual void reap(bool wait, std::vector<IoRequest*>& completed) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// 内核不支持 io_uring（或被禁用）时返回 nullptr
+std::unique_ptr<AsyncIoEngine> make_uring_engine(int fd, size_t block_size, size_t depth);
+// serialize 非空时，工作线程在持有该互斥量的情况下访问后端
+std::unique_ptr<AsyncIoEngine> make_pool_engine(DiskBackend& backend, size_t block_size,
+                                                size_t workers, std::mutex* serialize);
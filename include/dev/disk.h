@@ -1,26 +1,124 @@
 #pragma once
 #include "common/config.h"
+#include "dev/async_io.h"
+#include "dev/disk_backend.h"
 #include <cstdint>
-#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+// 磁盘几何。构造时传 0 的字段自动确定：块大小取 DISK_BLOCK_SIZE，块数取已有镜像的
+// 文件大小（新镜像取 DISK_NUM_BLOCKS），swap 保留块数取 SWAP_RESERVED_BLOCKS
+// （挂载时可被文件系统超级块中记录的值替换）。
+struct DiskGeometry {
+    size_t num_blocks = 0;
+    size_t block_size = 0;
+    size_t swap_blocks = 0;
+};
+
+// 向量化读写的一项：块号与对应的块缓冲
+struct BlockRead {
+    size_t block_id;
+    uint8_t* data;
+};
+struct BlockWrite {
+    size_t block_id;
+    const uint8_t* data;
+};
+
 class DiskDevice {
 public:
     DiskDevice();
+    explicit DiskDevice(std::string filename,
+                        DiskBackendKind backend = DiskBackendKind::Stream,
+                        DiskGeometry geometry = {});
     ~DiskDevice();
 
     bool read_block(size_t block_id, uint8_t* out_buffer);
     bool write_block(size_t block_id, const uint8_t* in_buffer);
 
+    // 向量化读写：块号相邻的项合并为一次后端调用（pread 后端即一次 preadv/pwritev），
+    // 顺序任意；同一块重复写入时以列表中最后一项为准。
+    bool read_blocks(const std::vector<BlockRead>& ios);
+    bool write_blocks(const std::vector<BlockWrite>& ios);
+    // 连续范围 [first_block, first_block + count)，缓冲大小为 count * block_size
+    bool read_blocks(size_t first_block, size_t count, uint8_t* out_buffer);
+    bool write_blocks(size_t first_block, size_t count, const uint8_t* in_buffer);
+
+    // write_block 默认只写入写回缓冲。
+    // barrier(): 把此前的写全部交给后端，保证它们先于之后的写到达镜像（元数据提交点）；
+    // sync():    barrier 并持久化到镜像文件（卸载、退出与检查点时调用）。
+    bool barrier();
+    bool sync();
+    size_t dirty_blocks() const { return dirty_.size(); }
+    // 模拟掉电：写回缓冲中尚未交给后端的写全部丢弃，已交给后端的写视为已到达盘面
+    void power_loss();
+
+    // 异步接口：提交后立即返回，完成回调在调用方线程的 poll_completions()/wait_io()
+    // （或任何需要等待该块的同步调用）中执行。同一块上的请求按提交顺序完成，
+    // 同步的 read_block 会先等待该块上的在途请求。
+    // submit_write 会拷贝 in_buffer；submit_read 完成前 out_buffer 必须保持有效。
+    bool submit_read(size_t block_id, uint8_t* out_buffer, IoCallback done = {});
+    bool submit_write(size_t block_id, const uint8_t* in_buffer, IoCallback done = {});
+    size_t poll_completions();  // 非阻塞回收，返回完成的请求数
+    void wait_io();             // 等待全部在途请求完成
+    size_t io_in_flight() const { return in_flight_; }
+    // submit_* 是否真正异步执行（否则就地同步完成）；必要时创建引擎
+    bool async_enabled() { return ensure_engine(); }
+
+    // 选择异步引擎与队列深度；需在第一次异步 I/O 之前调用
+    void configure_async(AsyncEngineKind kind, size_t queue_depth);
+    const char* async_engine() const;
+
     size_t get_num_blocks() const { return num_blocks_; }
     size_t get_block_size() const { return block_size_; }
 
+    // 镜像末尾 [swap_start(), num_blocks) 保留给 swap，其前为文件系统分区
+    size_t get_swap_blocks() const { return swap_blocks_; }
+    size_t swap_start() const { return num_blocks_ - swap_blocks_; }
+    // 调用方是否显式指定了 swap 大小；未指定时挂载采用镜像中记录的值
+    bool swap_blocks_requested() const { return swap_requested_; }
+    void set_swap_blocks(size_t swap_blocks);
+    DiskBackendKind get_backend_kind() const { return backend_kind_; }
+
+    // 每次真正交给后端的访问（一个连续块段）都会通知观察者；写回缓冲命中不算。
+    // 模拟时序的磁盘调度器借此为发起访问的进程计时。
+    using AccessObserver = std::function<void(size_t first_block, size_t count, bool write)>;
+    void set_access_observer(AccessObserver observer) { observer_ = std::move(observer); }
+
 private:
     std::string filename_ = config::DISK_IMAGE_NAME;
     size_t num_blocks_ = config::DISK_NUM_BLOCKS;
     size_t block_size_ = config::DISK_BLOCK_SIZE;
-    std::fstream disk_file_;
+    size_t swap_blocks_ = config::SWAP_RESERVED_BLOCKS;
+    bool swap_requested_ = false;
+    DiskBackendKind backend_kind_ = DiskBackendKind::Stream;
+    std::unique_ptr<DiskBackend> backend_;
+
+    // 写回缓冲：block_id -> 尚未交给后端的块数据（有序，回写时按块号递增）
+    std::map<size_t, std::vector<uint8_t>> dirty_;
+    bool write_back_ = true;
+
+    // 异步 I/O。engine_ 在 backend_ 之后声明，析构时先于后端销毁
+    AsyncEngineKind engine_kind_ = AsyncEngineKind::Auto;
+    size_t io_queue_depth_ = config::DISK_IO_QUEUE_DEPTH;
+    std::unique_ptr<AsyncIoEngine> engine_;
+    std::mutex backend_mu_;  // 后端非线程安全时，同步路径与线程池工作线程共用
+    size_t in_flight_ = 0;
+    std::unordered_map<size_t, uint32_t> inflight_blocks_;  // block_id -> 在途请求数
+    bool async_failed_ = false;  // 写回失败延迟到下一次 barrier/sync 报告
+    AccessObserver observer_;
 
-    void initialize_disk();
+    void initialize_disk(const DiskGeometry& requested);
+    void note_access(size_t first_block, size_t count, bool write);
+    bool flush_dirty(bool wait);
+    bool ensure_engine();
+    bool submit_request(std::unique_ptr<IoRequest> req);
+    size_t reap(bool wait);
+    void wait_block(size_t block_id);
+    std::unique_lock<std::mutex> lock_backend();
 };
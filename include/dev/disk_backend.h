@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 磁盘镜像的存储后端。DiskDevice 负责镜像创建、越界检查与指标统计，
+// 后端只负责按块搬运数据。
+enum class DiskBackendKind {
+    Stream,  // std::fstream 逐块 seek + read/write（默认）
+    Mmap,    // 整个镜像 mmap 到内存，读写即 memcpy，持久化依赖 sync()
+    Pread,   // 裸 fd + pread/pwrite，无共享文件偏移
+    Direct,  // 同 Pread，但以 O_DIRECT 打开绕过页缓存（不支持时回退为 Pread）
+    Ram,         // 纯内存盘，不读写任何镜像文件
+    RamPersist,  // 内存盘，启动时载入已有镜像，sync()/退出时把写过的块存回
+};
+
+// 后端是否直接读写镜像文件（需要 DiskDevice 预先创建并设置大小）
+bool disk_backend_uses_image_file(DiskBackendKind kind);
+
+bool parse_disk_backend(const std::string& s, DiskBackendKind& out);
+const char* disk_backend_name(DiskBackendKind kind);
+
+class DiskBackend {
+public:
+    virtual ~DiskBackend() = default;
+
+    // 打开已存在的镜像文件（至少 num_blocks * block_size 字节）
+    virtual bool open(const std::string& filename, size_t num_blocks, size_t block_size) = 0;
+
+    virtual bool read(size_t block_id, uint8_t* out_buffer) = 0;
+    virtual bool write(size_t block_id, const uint8_t* in_buffer) = 0;
+
+    // 连续块 [first_block, first_block + count) 的分散读 / 聚集写，buffers[i] 对应第 i 块。
+    // 默认逐块调用 read/write；能合并成一次系统调用（preadv/pwritev）的后端应覆盖。
+    virtual bool read_run(size_t first_block, uint8_t* const* buffers, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!read(first_block + i, buffers[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    virtual bool write_run(size_t first_block, const uint8_t* const* buffers, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!write(first_block + i, buffers[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 将已写入的数据落盘
+    virtual bool sync() = 0;
+
+    // 是否需要 DiskDevice 在其上做写回缓冲；本身就写内存的后端（mmap）不需要
+    virtual bool wants_write_back() const { return true; }
+
+    // 可供 io_uring 直接提交的文件描述符；没有时返回 -1
+    virtual int fd() const { return -1; }
+    // 不同块上的 read/write 能否被多个线程并发调用
+    virtual bool thread_safe() const { return false; }
+    // 异步提交能否带来重叠；纯内存后端同步 memcpy 更快，auto 引擎下不启用异步
+    virtual bool benefits_from_async() const { return true; }
+};
+
+std::unique_ptr<DiskBackend> make_disk_backend(DiskBackendKind kind);
+std::unique_ptr<DiskBackend> make_stream_backend();
+std::unique_ptr<DiskBackend> make_mmap_backend();
+std::unique_ptr<DiskBackend> make_pread_backend(bool direct);
+std::unique_ptr<DiskBackend> make_ram_backend(bool persist);
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 模拟时序的磁盘请求队列：DiskDevice 的每次后端访问（一个连续块段）在这里按
+// 机械盘模型计算服务时间（单位为 tick），由排序策略决定下一个服务的请求。
+// 数据本身仍由 DiskDevice 同步搬运，这里只决定“何时完成”，发起进程阻塞到完成为止。
+enum class DiskSchedPolicy {
+    Fcfs,   // 按到达顺序
+    Sstf,   // 最短寻道优先
+    Scan,   // 电梯：沿当前方向扫到磁盘边缘再折返
+    CLook,  // 单向扫描到最远的请求，然后跳回最低磁道的请求
+};
+
+bool parse_disk_sched_policy(const std::string& s, DiskSchedPolicy& out);
+const char* disk_sched_policy_name(DiskSchedPolicy policy);
+
+// 时序模型。块号按 blocks_per_track 连续映射到磁道；紧接上一请求末尾的顺序访问
+// 不付寻道与旋转延迟。
+struct DiskTiming {
+    double seek_settle = 1.0;          // 非零寻道的固定开销（加速与定位）
+    double seek_per_track = 0.05;      // 每跨越一条磁道的附加寻道时间
+    double rotation = 1.0;             // 平均旋转延迟（半圈）
+    double transfer_per_block = 0.25;  // 每块的传输时间
+    size_t blocks_per_track = 16;
+};
+
+// 解析形如 "settle=1,track=0.05,rotation=1,transfer=0.25,bpt=16" 的参数串，未给出的项保持原值
+bool parse_disk_timing(const std::string& s, DiskTiming& out);
+
+struct DiskRequest {
+    uint64_t id = 0;
+    int pid = -1;  // 发起进程；-1 表示不归属任何进程
+    size_t block = 0;
+    size_t count = 1;
+    bool write = false;
+    double arrival = 0;
+    double start = 0;
+    double finish = 0;
+};
+
+struct DiskSchedStats {
+    uint64_t requests = 0;       // 已完成的请求数
+    uint64_t blocks = 0;
+    uint64_t head_movement = 0;  // 磁头移动的磁道总数
+    double busy = 0;             // 磁盘忙碌的总时长
+    double first_arrival = 0;
+    double last_finish = 0;
+    std::vector<double> latencies;  // 每个请求的 finish - arrival
+
+    double elapsed() const { return last_finish - first_arrival; }
+    double throughput() const;  // 每 tick 完成的请求数
+    double mean_latency() const;
+    double percentile(double p) const;  // p ∈ [0, 100]
+};
+
+class DiskScheduler {
+public:
+    DiskScheduler(DiskSchedPolicy policy, DiskTiming timing, size_t num_blocks);
+
+    // 在时刻 now 到达一个请求，返回请求 id
+    uint64_t submit(int pid, size_t block, size_t count, bool write, double now);
+    // 推进到时刻 now，把在此之前完成的请求追加到 completed
+    void advance(double now, std::vector<DiskRequest>& completed);
+
+    size_t queued() const { return queue_.size() + (busy_ ? 1 : 0); }
+    const DiskSchedStats& stats() const { return stats_; }
+    void reset_stats();
+
+    DiskSchedPolicy policy() const { return policy_; }
+    void set_policy(DiskSchedPolicy policy) { policy_ = policy; }
+    const DiskTiming& timing() const { return timing_; }
+
+    // 记录的到达序列（开环）在另一策略下回放的结果，用于同一负载的策略对比
+    DiskSchedStats replay(DiskSchedPolicy policy) const;
+
+    void dump(std::ostream& os) const;
+    void dump_comparison(std::ostream& os) const;
+
+private:
+    DiskSchedPolicy policy_;
+    DiskTiming timing_;
+    size_t num_blocks_;
+    size_t num_tracks_;
+    bool replaying_ = false;  // 回放用的临时实例：不计入全局指标，也不打日志
+
+    std::vector<DiskRequest> queue_;  // 等待服务的请求（按到达顺序）
+    DiskRequest current_;
+    bool busy_ = false;
+    size_t head_track_ = 0;
+    size_t next_block_ = SIZE_MAX;  // 上一请求结束后磁头下方的块，用于识别顺序访问
+    bool sweep_up_ = true;
+    double idle_since_ = 0;  // 上一请求完成的时刻
+    uint64_t next_id_ = 1;
+
+    DiskSchedStats stats_;
+    std::vector<DiskRequest> arrivals_;
+
+    size_t track_of(size_t block) const { return block / timing_.blocks_per_track; }
+    size_t pick_next(double at, uint64_t& travel);
+    void start_next(double at);
+    void complete_current();
+};
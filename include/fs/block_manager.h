@@ -1,37 +1,74 @@
 #pragma once
 #include "fs/fs_defs.h"
-#include "dev/disk.h"
+#include "fs/buffer_cache.h"
 #include <vector>
 #include <cstdint>
+#include <ostream>
 
+// 按块组管理 inode 与数据块的分配。每组有各自的位图、空闲计数与轮转提示；
+// 分配先在目标组内进行（文件跟随父目录，数据块跟随 inode 或文件末块），组满时依次试后面的组
 class BlockManager {
 public:
-    explicit BlockManager(DiskDevice* disk);
+    // sb 为文件系统的超级块，块组位置与容量取自其中的布局字段
+    BlockManager(BufferCache* cache, const SuperBlock* sb);
     
     bool load_bitmaps();
+    // 只写回自上次保存以来有改动的组的位图
     bool save_bitmaps();
     
-    uint32_t alloc_inode();
+    // 普通文件的 inode 优先放在父目录所在组；新目录放到空闲块最多的组，
+    // 把各目录及其中的文件分散到各组。parent 为 INVALID_INODE 时从块组 0 开始
+    uint32_t alloc_inode(uint32_t parent = INVALID_INODE, bool directory = false);
     void free_inode(uint32_t inode_num);
     
-    uint32_t alloc_block();
+    // 分配一块，优先 goal 本身，其次 goal 所在的组（goal 可为 INVALID_BLOCK）
+    uint32_t alloc_block(uint32_t goal = INVALID_BLOCK);
+    // 分配一段至多 count 块的连续空闲块，优先紧接在 goal 之后，其次在 goal 所在的组内。
+    // 没有足够长的空闲段时返回较短的一段，调用方继续分配余下部分；空间耗尽时 length 为 0
+    Extent alloc_extent(uint32_t goal, uint32_t count);
     void free_block(uint32_t block_num);
+    void free_extent(const Extent& extent);
+    // inode 所在组的第一个数据块，作为该 inode 首次分配数据块的目标
+    uint32_t group_goal(uint32_t inode_num) const;
 
-    uint32_t free_inodes() const;
-    uint32_t free_blocks() const;
+    // 空闲计数在加载位图时统计一次，之后随分配与释放增量维护
+    uint32_t free_inodes() const { return free_inodes_; }
+    uint32_t free_blocks() const { return free_blocks_; }
     
     bool is_bitmap_dirty() const { return bitmap_dirty_; }
-    void set_bitmap_dirty(bool dirty) { bitmap_dirty_ = dirty; }
+    void set_bitmap_dirty(bool dirty);
+
+    // 各组的位置与空闲情况
+    void dump(std::ostream& os) const;
     
 private:
-    DiskDevice* disk_;
-    std::vector<uint8_t> inode_bitmap_;
-    std::vector<uint8_t> data_bitmap_;
+    struct Group {
+        GroupLayout layout;
+        std::vector<uint64_t> inode_bitmap;  // 按 64 位字扫描
+        std::vector<uint64_t> data_bitmap;
+        uint32_t free_inodes = 0;
+        uint32_t free_blocks = 0;
+        // 轮转提示：上次分配之后的位，下次查找从这里开始（next-fit）
+        uint32_t inode_hint = 0;
+        uint32_t data_hint = 0;
+        bool dirty = false;
+    };
+
+    BufferCache* cache_;
+    const SuperBlock* sb_;
+    std::vector<Group> groups_;
     bool bitmap_dirty_;
+    uint32_t free_inodes_ = 0;
+    uint32_t free_blocks_ = 0;
     
-    bool is_bit_set(const std::vector<uint8_t>& bitmap, uint32_t bit_index) const;
-    void set_bit(std::vector<uint8_t>& bitmap, uint32_t bit_index);
-    void clear_bit(std::vector<uint8_t>& bitmap, uint32_t bit_index);
-    uint32_t find_free_bit(const std::vector<uint8_t>& bitmap, uint32_t max_bits);
-    uint32_t count_set_bits(const std::vector<uint8_t>& bitmap, uint32_t max_bits) const;
+    uint32_t directory_group(uint32_t parent) const;
+    Extent allocate(uint32_t goal, uint32_t count);
+    Extent take(Group& group, uint32_t bit, uint32_t len);
+    bool is_bit_set(const std::vector<uint64_t>& bitmap, uint32_t bit_index) const;
+    void set_bit(std::vector<uint64_t>& bitmap, uint32_t bit_index);
+    void clear_bit(std::vector<uint64_t>& bitmap, uint32_t bit_index);
+    uint32_t find_free_bit(const std::vector<uint64_t>& bitmap, uint32_t max_bits, uint32_t hint);
+    uint32_t find_free_run(const std::vector<uint64_t>& bitmap, uint32_t max_bits, uint32_t hint,
+                           uint32_t count, uint32_t& len);
+    uint32_t count_set_bits(const std::vector<uint64_t>& bitmap, uint32_t max_bits) const;
 };
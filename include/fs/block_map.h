@@ -0,0 +1,50 @@
+#pragma once
+#include "fs/fs_defs.h"
+#include "fs/buffer_cache.h"
+#include "fs/block_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 文件块索引到磁盘块号的映射，支持两种 inode 格式：
+// - extent（新建的 inode）：文件由若干 (起始块, 长度) 段首尾相接组成，前 INLINE_EXTENTS 段
+//   存于 inode，其余存于 extent 块链表。映射与追加按段进行，开销与段数而非块数成正比；
+//   追加的块紧接末段时直接延长末段。
+// - 块指针（旧版镜像）：前 DIRECT_BLOCKS 块记录在 inode 中，之后的 PTRS_PER_BLOCK 块经一级
+//   间接块，再往后经二级间接块。间接块是否存在由 blocks_used 决定，不看指针的值。
+// 间接块与 extent 块都作为元数据经缓冲缓存读写；区间映射时每个映射块只取一次
+class BlockMap {
+public:
+    BlockMap(BufferCache* cache, BlockManager* block_mgr);
+
+    // 把文件块 [first, first + count) 的块号追加到 out；要求 first + count <= blocks_used
+    bool map(const Inode& inode, uint32_t first, uint32_t count, std::vector<uint32_t>& out);
+    // 把从 start 起的 count 个连续块接在文件末尾并更新 blocks_used，按需分配映射块。
+    // 返回追加的块数，映射块分配失败或到达文件上限时少于 count
+    uint32_t append(Inode& inode, uint32_t start, uint32_t count);
+    // 释放文件的全部数据块与映射块
+    void release(const Inode& inode);
+    // 文件末块之后的块号，作为分配新块的目标；空文件返回 INVALID_BLOCK
+    uint32_t goal(const Inode& inode);
+
+    // 向文件追加 blocks 块最多还需要分配的映射块数（extent 格式按每块一段的最坏情况估计）
+    static uint32_t metadata_blocks_for(const Inode& inode, uint32_t blocks);
+    // 数据块加映射块不超过 budget 时最多能向文件追加的块数（至多 max_blocks）
+    static uint32_t blocks_within(const Inode& inode, uint64_t budget, uint32_t max_blocks);
+
+private:
+    BufferCache* cache_;
+    BlockManager* block_mgr_;
+
+    BufferCache::Handle fetch(uint32_t block);
+    BufferCache::Handle new_map_block(uint32_t goal);
+
+    bool for_each_extent(const Inode& inode, const std::function<bool(const Extent&)>& fn);
+    BufferCache::Handle last_extent_block(const Inode& inode);
+    uint32_t append_extent(Inode& inode, uint32_t start, uint32_t count);
+    bool map_pointers(const Inode& inode, uint32_t first, uint32_t count,
+                      std::vector<uint32_t>& out);
+    uint32_t append_pointers(Inode& inode, uint32_t start, uint32_t count);
+    void release_pointers(const Inode& inode);
+};
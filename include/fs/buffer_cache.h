@@ -0,0 +1,142 @@
+#pragma once
+#include "fs/fs_defs.h"
+#include "dev/disk.h"
+#include "fs/journal.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// 文件系统与 DiskDevice 之间的块缓冲缓存。固定容量、LRU 替换；
+// 修改只标记脏块，在 barrier()/sync() 或被淘汰时才写到磁盘。
+// 通过 Handle 取得的块被钉住（pin），钉住期间不会被淘汰，地址保持不变。
+// 接入日志后，以元数据方式修改的块先作为事务写入日志，检查点时才原地写回。
+class BufferCache {
+    struct Buffer {
+        uint32_t block = INVALID_BLOCK;
+        std::unique_ptr<uint8_t[]> data;
+        uint32_t pins = 0;
+        bool dirty = false;
+        bool metadata = false;    // 脏内容是元数据，须经日志写回
+        bool logged = false;      // 当前内容已写入日志，可以原地写回
+        bool readahead = false;   // 预读读入、尚未被访问
+        bool io_pending = false;  // 异步预读尚未完成
+    };
+    using BufferList = std::list<Buffer>;
+
+public:
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept : cache_(other.cache_), buf_(other.buf_) {
+            other.buf_ = nullptr;
+        }
+        Handle& operator=(Handle&& other) noexcept;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle() { release(); }
+
+        explicit operator bool() const { return buf_ != nullptr; }
+        uint32_t block() const { return buf_->block; }
+        const uint8_t* data() const { return buf_->data.get(); }
+        // 修改前取可写指针，同时把块标记为脏
+        uint8_t* mutable_data() {
+            cache_->mark_dirty(*buf_, false);
+            return buf_->data.get();
+        }
+        // 修改元数据块（inode 表、位图、目录块、超级块）
+        uint8_t* mutable_metadata() {
+            cache_->mark_dirty(*buf_, true);
+            return buf_->data.get();
+        }
+        void release();
+
+    private:
+        friend class BufferCache;
+        Handle(BufferCache* cache, Buffer* buf) : cache_(cache), buf_(buf) {}
+
+        BufferCache* cache_ = nullptr;
+        Buffer* buf_ = nullptr;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t writebacks = 0;  // 写到磁盘的脏块数（淘汰或 flush）
+        uint64_t readahead = 0;         // 预读发起的块数
+        uint64_t readahead_hits = 0;    // 预读的块随后被访问
+        uint64_t readahead_wasted = 0;  // 预读的块未被访问就被淘汰
+
+        double hit_rate() const {
+            const uint64_t total = hits + misses;
+            return total ? static_cast<double>(hits) / static_cast<double>(total) : 0;
+        }
+    };
+
+    BufferCache(DiskDevice* disk, size_t capacity);
+    ~BufferCache();
+
+    // 取得一块（未命中时从磁盘读入）；读失败返回空 Handle
+    Handle get(uint32_t block);
+    // 批量取得：未命中的块合并为一次 read_blocks。out 与 blocks 一一对应
+    bool get_many(const std::vector<uint32_t>& blocks, std::vector<Handle>& out);
+    // 取得一块并清零，不读磁盘（新分配的块）；返回的块已标记为脏
+    Handle get_zeroed(uint32_t block);
+    // 预读：把尚未缓存的块读入缓存，不钉住。有异步引擎时提交后立即返回，
+    // 之后访问这些块时才等待完成。返回实际发起读的块数
+    size_t prefetch(const std::vector<uint32_t>& blocks);
+
+    // 整块拷贝的便捷接口
+    bool read(uint32_t block, uint8_t* out);
+    bool write(uint32_t block, const uint8_t* in, bool metadata = false);
+    bool read_range(uint32_t first, uint32_t count, uint8_t* out);
+    bool write_range(uint32_t first, uint32_t count, const uint8_t* in, bool metadata = false);
+
+    // 接入元数据日志；nullptr 或未启用时所有脏块直接原地写回
+    void set_journal(Journal* journal) { journal_ = journal; }
+
+    // 把全部脏块交给磁盘（相邻块合并为一次 write_blocks）。有日志时数据块先原地写，
+    // 未写入日志的元数据块合并为一个事务写入日志，已写入日志的元数据块留到检查点
+    bool flush();
+    // flush 后调用磁盘的 barrier()/sync()。已写入日志的元数据即已持久，sync 不做检查点
+    bool barrier();
+    bool sync();
+    // 把已写入日志的元数据块原地写回，然后清空日志
+    bool checkpoint();
+
+    void set_capacity(size_t capacity);
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return index_.size(); }
+    size_t dirty_blocks() const { return dirty_count_; }
+    const Stats& stats() const { return stats_; }
+    void reset_stats() { stats_ = Stats{}; }
+    void dump(std::ostream& os) const;
+
+private:
+    DiskDevice* disk_;
+    size_t capacity_;
+    BufferList lru_;  // 表头为最近使用
+    std::unordered_map<uint32_t, BufferList::iterator> index_;
+    std::vector<std::unique_ptr<uint8_t[]>> spare_;  // 被丢弃缓冲的存储，供复用
+    size_t dirty_count_ = 0;
+    Journal* journal_ = nullptr;
+    Stats stats_;
+
+    bool journaling() const { return journal_ && journal_->enabled(); }
+    bool write_buffers(const std::vector<Buffer*>& bufs);
+
+    Buffer* lookup(uint32_t block);
+    Buffer* insert(uint32_t block);
+    void discard(Buffer* buf);
+    bool evict_one();
+    bool write_back(Buffer& buf);
+    void unpin(Buffer* buf);
+    void mark_dirty(Buffer& buf, bool metadata);
+    void mark_clean(Buffer& buf);
+    void note_hit(Buffer& buf);
+    void finish_prefetch(uint32_t block, bool ok);
+};
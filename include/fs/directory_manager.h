@@ -2,11 +2,16 @@
 #include "fs/fs_defs.h"
 #include "fs/inode_manager.h"
 #include "fs/block_manager.h"
+#include "fs/block_map.h"
+#include <cstdint>
+#include <ostream>
 #include <string>
+#include <unordered_map>
 
 class DirectoryManager {
 public:
-    DirectoryManager(DiskDevice* disk, InodeManager* inode_mgr, BlockManager* block_mgr);
+    DirectoryManager(BufferCache* cache, InodeManager* inode_mgr, BlockManager* block_mgr,
+                     BlockMap* block_map);
     
     uint32_t lookup_path(const std::string& path, const std::string& current_dir);
     uint32_t lookup_in_directory(uint32_t dir_inode, const std::string& name);
@@ -19,9 +24,44 @@ public:
     
     std::string normalize_path(const std::string& path, const std::string& current_dir);
     void split_path(const std::string& path, std::string& parent, std::string& name);
+
+    // 目录项缓存：(父目录 inode, 名字) → inode，找不到的名字也缓存为否定项
+    struct DentryStats {
+        uint64_t hits = 0;
+        uint64_t negative_hits = 0;  // 命中否定项（已知不存在）
+        uint64_t misses = 0;
+
+        double hit_rate() const {
+            const uint64_t total = hits + misses;
+            return total ? static_cast<double>(hits) / static_cast<double>(total) : 0;
+        }
+    };
+    // 删除目录时丢弃以它为父的全部缓存项
+    void forget_directory(uint32_t dir_inode);
+    void invalidate_dentries();
+    const DentryStats& dentry_stats() const { return dstats_; }
+    void reset_dentry_stats() { dstats_ = DentryStats{}; }
+    void dump_dentry_cache(std::ostream& os) const;
     
 private:
-    DiskDevice* disk_;
+    struct DentryKey {
+        uint32_t parent;
+        std::string name;
+        bool operator==(const DentryKey& o) const { return parent == o.parent && name == o.name; }
+    };
+    struct DentryKeyHash {
+        size_t operator()(const DentryKey& k) const {
+            return std::hash<std::string>()(k.name) ^ (static_cast<size_t>(k.parent) * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    BufferCache* cache_;
     InodeManager* inode_mgr_;
     BlockManager* block_mgr_;
+    BlockMap* block_map_;
+    std::unordered_map<DentryKey, uint32_t, DentryKeyHash> dentries_;  // 值为 INVALID_INODE 即否定项
+    DentryStats dstats_;
+
+    void cache_dentry(uint32_t parent, const std::string& name, uint32_t inode_num);
+    void forget_dentry(uint32_t parent, const std::string& name);
 };
@@ -1,17 +1,24 @@
 #pragma once
+#include "fs/fs_defs.h"
 #include <map>
 #include <cstdint>
 
 struct OpenFile {
     uint32_t inode_num;
     uint32_t offset;
+    Inode* inode;  // InodeManager 中被引用的 inode，关闭时释放引用
+
+    // 顺序读检测与预读状态
+    uint64_t ra_prev_end = 0;  // 上次读结束的位置
+    uint32_t ra_window = 0;    // 当前预读窗口（块数），0 表示未在顺序读
+    uint32_t ra_next = 0;      // 已预读区间之后的第一个块索引
 };
 
 class FileDescriptorTable {
 public:
     FileDescriptorTable();
     
-    int alloc_fd(uint32_t inode_num);
+    int alloc_fd(uint32_t inode_num, Inode* inode);
     bool free_fd(int fd);
     
     OpenFile* get_open_file(int fd);
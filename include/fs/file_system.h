@@ -1,12 +1,17 @@
 #pragma once
 #include "fs/fs_defs.h"
+#include "fs/buffer_cache.h"
 #include "fs/inode_manager.h"
 #include "fs/block_manager.h"
+#include "fs/block_map.h"
 #include "fs/directory_manager.h"
 #include "fs/file_descriptor_table.h"
+#include "fs/journal.h"
 #include "dev/disk.h"
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 class FileSystem {
 public:
@@ -16,6 +21,15 @@ public:
     bool format();
     bool mount();
     bool is_mounted() const { return mounted_; }
+    // 落实延迟分配，把缓冲缓存中的脏块写到磁盘并落盘
+    bool sync();
+    // 时钟推进：未提交的元数据或延迟分配的数据停留超时则提交
+    void tick(uint64_t now);
+    // 元数据成组提交：累计 ops 个操作或首个未提交操作经过 ticks 个 tick 后提交
+    void set_commit_interval(size_t ops, uint64_t ticks);
+    BufferCache& buffer_cache() { return *cache_; }
+    DirectoryManager& directories() { return *dir_mgr_; }
+    const Journal& journal() const { return *journal_; }
 
     // 目录操作
     bool create_directory(const std::string& path);
@@ -32,8 +46,10 @@ public:
     ssize_t write_file(int fd, const void* buffer, size_t size);
     
     // 调试信息
+    const SuperBlock& superblock() const { return superblock_; }
     void print_superblock() const;
     void print_inode(uint32_t inode_num) const;
+    bool stat_file(const std::string& path);
 
 private:
     DiskDevice* disk_;
@@ -41,14 +57,40 @@ private:
     bool mounted_;
     std::string current_dir_;
     
-    // 各功能模块
+    // 各功能模块（都经 cache_ 访问磁盘）
+    std::unique_ptr<Journal> journal_;  // 先于缓冲缓存构造、后于其析构
+    std::unique_ptr<BufferCache> cache_;
     std::unique_ptr<InodeManager> inode_mgr_;
     std::unique_ptr<BlockManager> block_mgr_;
+    std::unique_ptr<BlockMap> block_map_;
     std::unique_ptr<DirectoryManager> dir_mgr_;
     std::unique_ptr<FileDescriptorTable> fd_table_;
 
+    // 延迟分配：超出已分配块的写入先留在内存（按 inode、块索引），
+    // 刷出时一次分配一段连续块，元数据也只写一次
+    struct DelayedData {
+        std::map<uint32_t, std::unique_ptr<uint8_t[]>> blocks;  // 块索引 -> 数据
+        uint32_t metadata = 0;  // 这些块最多还需要分配的映射块数（间接块或 extent 块）
+    };
+    std::unordered_map<uint32_t, DelayedData> delalloc_;
+    size_t delalloc_blocks_ = 0;
+    size_t delalloc_metadata_ = 0;  // 为延迟分配预留的映射块
+    uint64_t delalloc_since_ = 0;   // 其中最早一块进入时的 tick（delalloc_blocks_ 非零时有效）
+    uint64_t now_ = 0;
+
+    size_t commit_ops_ = config::METADATA_COMMIT_OPS;
+    uint64_t commit_ticks_ = config::METADATA_COMMIT_TICKS;
+    size_t pending_ops_ = 0;      // 上次提交以来的元数据操作数
+    uint64_t pending_since_ = 0;  // 其中第一个操作发生时的 tick
+
     bool load_superblock();
     bool save_superblock();
+    bool commit();
+    bool write_metadata();
+    void metadata_changed();
+    void allocate_delayed();
+    void drop_delayed(uint32_t inode_num);
+    void readahead(OpenFile& file, const Inode& inode, uint64_t start, uint64_t end);
     bool init_root_directory();
     void refresh_space_counters_from_bitmaps();
 };
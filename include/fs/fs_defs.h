@@ -1,28 +1,42 @@
 #pragma once
 #include "common/config.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
 // 文件系统布局常量
 constexpr uint32_t BLOCK_SIZE = static_cast<uint32_t>(config::DISK_BLOCK_SIZE);
-// FS: [0, SWAP_START_BLOCK), swap: [SWAP_START_BLOCK, DISK_NUM_BLOCKS)
-constexpr uint32_t TOTAL_BLOCKS = static_cast<uint32_t>(config::SWAP_START_BLOCK);
 
-// 布局设计
+// 布局设计：FS 分区为 [0, DiskDevice::swap_start())，依次为
+// [超级块][元数据日志][块组 0][块组 1]...，每个块组为 [inode 位图][数据位图][inode 表][数据块]。
+// 组数、每组块数与 inode 数由 format 按分区大小确定并记录在超级块中，各组位置由此推算；
+// 日志紧接超级块，大小由 config::JOURNAL_BLOCKS 决定。
+// 以下为默认几何（1024 块、128 块 swap、32 块日志，只有一个块组）下的取值。
 constexpr uint32_t SUPERBLOCK_BLOCK = 0;
-constexpr uint32_t INODE_BITMAP_BLOCK = 1;
-constexpr uint32_t DATA_BITMAP_BLOCK = 2;
-constexpr uint32_t INODE_TABLE_START = 3; 
+constexpr uint32_t INODE_BITMAP_BLOCK = 33;
+constexpr uint32_t DATA_BITMAP_BLOCK = 34;
+constexpr uint32_t INODE_TABLE_START = 35;
 constexpr uint32_t INODE_TABLE_BLOCKS = 4;
-constexpr uint32_t DATA_BLOCKS_START = 7;
+constexpr uint32_t DATA_BLOCKS_START = 39;
 
 // 容量设计
-constexpr uint32_t MAX_INODES = 128;
-constexpr uint32_t MAX_DATA_BLOCKS = TOTAL_BLOCKS - DATA_BLOCKS_START;
+constexpr uint32_t MAX_INODES = 128;                      // 每组 inode 数的下限
+constexpr uint32_t BLOCKS_PER_INODE = 8;                  // 每 8 个块配一个 inode
+constexpr uint32_t BITS_PER_BITMAP_BLOCK = BLOCK_SIZE * 8;
+constexpr uint32_t INODES_PER_BLOCK = BLOCK_SIZE / 128;   // 每个 inode 表块的 inode 数
 
 // Inode 配置
 constexpr uint32_t DIRECT_BLOCKS = 10;  // 每个inode有10个直接块指针
-constexpr uint32_t MAX_FILE_SIZE = DIRECT_BLOCKS * BLOCK_SIZE;  // 40KB
+constexpr uint32_t PTRS_PER_BLOCK = BLOCK_SIZE / sizeof(uint32_t);  // 间接块中的块指针数
+// 直接块 + 一级间接 + 二级间接；文件大小字段为 32 位，块数以此为上限
+constexpr uint32_t MAX_FILE_BLOCKS = static_cast<uint32_t>(std::min<uint64_t>(
+    DIRECT_BLOCKS + PTRS_PER_BLOCK + static_cast<uint64_t>(PTRS_PER_BLOCK) * PTRS_PER_BLOCK,
+    UINT32_MAX / BLOCK_SIZE));
+constexpr uint64_t MAX_FILE_SIZE = static_cast<uint64_t>(MAX_FILE_BLOCKS) * BLOCK_SIZE;  // 约 4GB
+constexpr uint32_t INLINE_EXTENTS = 7;  // inode 内直接存放的 extent 数
+
+// inode 标志
+constexpr uint8_t INODE_FLAG_EXTENTS = 0x1;  // 数据块按 extent 记录（否则为直接/间接块指针）
 
 // 目录项配置
 constexpr uint32_t MAX_FILENAME_LEN = 28;
@@ -42,6 +56,18 @@ enum class FileType : uint8_t {
     DIRECTORY = 2
 };
 
+// 一个块组在分区中的位置，由超级块推算，不单独存盘
+struct GroupLayout {
+    uint32_t inode_bitmap;        // inode 位图块
+    uint32_t data_bitmap;         // 数据位图起始块
+    uint32_t data_bitmap_blocks;  // 数据位图块数（分组的镜像中为 1）
+    uint32_t inode_table;         // inode 表起始块
+    uint32_t first_inode;         // 组内第一个 inode 的编号
+    uint32_t inodes;              // 组内 inode 数
+    uint32_t data_start;          // 数据区起始块
+    uint32_t data_blocks;         // 数据区块数
+};
+
 // SuperBlock 结构 (占用一个块)
 struct SuperBlock {
     uint32_t magic;                   // 魔数，用于识别文件系统
@@ -53,32 +79,86 @@ struct SuperBlock {
     uint32_t inode_bitmap_block;      // inode位图起始块号
     uint32_t data_bitmap_block;       // 数据块位图起始块号
     uint32_t inode_table_start;       // inode表起始块号
-    uint32_t inode_table_blocks;      // inode表占用块数
+    uint32_t inode_table_blocks;      // inode表占用块数（分组的镜像中为每组）
     uint32_t data_blocks_start;       // 数据块起始块号
+    uint32_t data_bitmap_blocks;      // 数据块位图占用块数
     
-    uint8_t padding[BLOCK_SIZE - 40]; // 填充至4096字节
+    // 格式化时的磁盘几何（0 表示旧版镜像，按默认几何解释）
+    uint32_t block_size;              // 块大小
+    uint32_t disk_blocks;             // 整个镜像的块数
+    uint32_t swap_blocks;             // 镜像末尾保留给 swap 的块数
+
+    // 元数据日志区（journal_blocks 为 0 表示没有日志的旧版镜像）
+    uint32_t journal_start;
+    uint32_t journal_blocks;
+
+    // 块组（group_count 为 0 表示分组前的旧版镜像：整个分区是一组，位置取自上面的字段；
+    // 分组的镜像中上面的位图、inode 表与数据区字段描述块组 0）
+    uint32_t group_count;
+    uint32_t blocks_per_group;
+    uint32_t inodes_per_group;
+    uint32_t first_group_block;       // 块组 0 的起始块号
+    
+    uint8_t padding[BLOCK_SIZE - 80]; // 填充至4096字节
     
     SuperBlock() {
         memset(this, 0, sizeof(SuperBlock));
     }
+
+    uint32_t groups() const { return group_count != 0 ? group_count : 1; }
+    GroupLayout group(uint32_t g) const;
+    uint32_t group_of_inode(uint32_t inode_num) const {
+        return group_count != 0 ? std::min(inode_num / inodes_per_group, group_count - 1) : 0;
+    }
+    uint32_t group_of_block(uint32_t block) const {
+        if (group_count == 0 || block < first_group_block) {
+            return 0;
+        }
+        return std::min((block - first_group_block) / blocks_per_group, group_count - 1);
+    }
+    // 各组数据块数之和
+    uint32_t data_blocks() const;
+};
+
+// 一段物理上连续的数据块；文件的各 extent 在逻辑上首尾相接
+struct Extent {
+    uint32_t start;   // 起始块号
+    uint32_t length;  // 块数
 };
 
 // Inode 结构 (128 bytes, 每个块可存放32个inode)
 struct Inode {
     FileType type;                   // 文件类型
-    uint8_t padding1[3];             // 对齐
+    uint8_t flags;                   // INODE_FLAG_*，旧版镜像中为 0
+    uint8_t padding1[2];             // 对齐
     uint32_t size;                   // 文件大小（字节）
     uint32_t blocks_used;            // 已使用的数据块数
     uint32_t direct_blocks[DIRECT_BLOCKS];  // 直接块指针
-    uint8_t padding2[128 - 4 - 4 - 4 - DIRECT_BLOCKS * 4];  // 填充至128字节
+    // 间接块指针，仅在 blocks_used 超出直接块（一级）或再超出一级间接块（二级）时有效；
+    // 旧版镜像中为 0
+    uint32_t indirect_block;         // 一级间接块：PTRS_PER_BLOCK 个数据块号
+    uint32_t double_indirect_block;  // 二级间接块：PTRS_PER_BLOCK 个一级间接块号
+    // extent 格式（INODE_FLAG_EXTENTS）：前 INLINE_EXTENTS 段存于 inode，
+    // 其余存于从 extent_block 开始的 extent 块链表。两种格式的字段互不重叠
+    uint32_t extent_count;           // extent 总数
+    uint32_t extent_block;           // 第一个 extent 块（extent_count > INLINE_EXTENTS 时有效）
+    Extent extents[INLINE_EXTENTS];
+    uint8_t padding2[128 - 4 - 4 - 4 - DIRECT_BLOCKS * 4 - 8 - 8 - INLINE_EXTENTS * 8];  // 填充至128字节
     
+    // 新建的 inode 使用 extent 格式
     Inode() {
         memset(this, 0, sizeof(Inode));
         type = FileType::REGULAR;
+        flags = INODE_FLAG_EXTENTS;
         for (auto& block : direct_blocks) {
             block = INVALID_BLOCK;
         }
+        indirect_block = INVALID_BLOCK;
+        double_indirect_block = INVALID_BLOCK;
+        extent_block = INVALID_BLOCK;
     }
+
+    bool uses_extents() const { return (flags & INODE_FLAG_EXTENTS) != 0; }
 };
 
 // 目录项结构 (32 bytes, 每个块可存放128个目录项)
@@ -102,7 +182,28 @@ struct DirectoryEntry {
     }
 };
 
+inline GroupLayout SuperBlock::group(uint32_t g) const {
+    if (group_count == 0) {
+        return {inode_bitmap_block, data_bitmap_block, data_bitmap_blocks, inode_table_start,
+                0, total_inodes, data_blocks_start, total_blocks - data_blocks_start};
+    }
+    // 末组可能不满 blocks_per_group 块
+    const uint32_t base = first_group_block + g * blocks_per_group;
+    const uint32_t end = std::min(base + blocks_per_group, total_blocks);
+    const uint32_t data_start = base + 2 + inodes_per_group / INODES_PER_BLOCK;
+    return {base, base + 1, 1, base + 2, g * inodes_per_group, inodes_per_group,
+            data_start, end - data_start};
+}
+
+inline uint32_t SuperBlock::data_blocks() const {
+    uint32_t blocks = 0;
+    for (uint32_t g = 0; g < groups(); ++g) {
+        blocks += group(g).data_blocks;
+    }
+    return blocks;
+}
+
 static_assert(sizeof(SuperBlock) == BLOCK_SIZE, "SuperBlock size must equal BLOCK_SIZE");
 static_assert(sizeof(Inode) == 128, "Inode size must be 128 bytes");
+static_assert(INODES_PER_BLOCK * sizeof(Inode) == BLOCK_SIZE, "INODES_PER_BLOCK must match the inode size");
 static_assert(sizeof(DirectoryEntry) == DIRENT_SIZE, "DirectoryEntry size must equal DIRENT_SIZE");
-static_assert(TOTAL_BLOCKS > DATA_BLOCKS_START, "FS partition too small");
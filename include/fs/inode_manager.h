@@ -1,15 +1,47 @@
 #pragma once
 #include "fs/fs_defs.h"
-#include "dev/disk.h"
+#include "fs/buffer_cache.h"
+#include <cstddef>
 #include <cstdint>
+#include <unordered_map>
 
+// 内存中的 inode 表：按 inode 号缓存，带引用计数与脏标记。
+// 修改只更新内存中的副本，flush() 时按 inode 表块分组写入缓冲缓存。
 class InodeManager {
 public:
-    explicit InodeManager(DiskDevice* disk);
+    // inode 表位置取自 sb（文件系统的超级块）
+    InodeManager(BufferCache* cache, const SuperBlock* sb,
+                 size_t capacity = config::INODE_CACHE_ENTRIES);
     
     bool read_inode(uint32_t inode_num, Inode& out_inode);
     bool write_inode(uint32_t inode_num, const Inode& inode);
+
+    // 取得缓存中的 inode 并增加引用（打开的文件持有），引用期间地址不变、不会被淘汰；
+    // 通过返回的指针修改后须调用 mark_dirty
+    Inode* get(uint32_t inode_num);
+    void put(uint32_t inode_num);
+    void mark_dirty(uint32_t inode_num);
+
+    // 把脏 inode 写入缓冲缓存（同一 inode 表块内的合并为一次块更新）
+    bool flush();
+    // 丢弃未被引用的缓存项（格式化、重新挂载后内容已失效）
+    void invalidate();
+
+    size_t cached() const { return table_.size(); }
     
 private:
-    DiskDevice* disk_;
+    struct CachedInode {
+        Inode inode;
+        uint32_t refs = 0;
+        bool dirty = false;
+    };
+
+    BufferCache* cache_;
+    const SuperBlock* sb_;
+    size_t capacity_;
+    std::unordered_map<uint32_t, CachedInode> table_;
+
+    CachedInode* lookup(uint32_t inode_num);
+    void make_room();
+    uint32_t block_of(uint32_t inode_num) const;
 };
@@ -0,0 +1,64 @@
+#pragma once
+#include "fs/fs_defs.h"
+#include "dev/disk.h"
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+// 元数据预写日志（物理块日志）。日志区为 FS 分区中连续的 journal_blocks 块：
+// 第 0 块为日志头，记录下一个待重放事务的序号；其后顺序追加事务，每个事务为
+// 描述块（序号、块号表）+ 各元数据块的新内容 + 提交块（序号、校验和），
+// 一次连续写入后 barrier。元数据随后在检查点时才原地写回，日志随之清空。
+// 挂载时从第 1 块起重放序号连续、校验和正确的事务。
+class Journal {
+public:
+    struct Stats {
+        uint64_t transactions = 0;  // 提交的事务数
+        uint64_t blocks = 0;        // 写入日志的元数据块数
+        uint64_t checkpoints = 0;
+        uint64_t replayed_transactions = 0;
+        uint64_t replayed_blocks = 0;
+    };
+
+    explicit Journal(DiskDevice* disk) : disk_(disk) {}
+
+    // 绑定日志区 [start, start + blocks)；blocks 为 0 表示不使用日志（旧版镜像）
+    void attach(uint32_t start, uint32_t blocks);
+    bool enabled() const { return blocks_ != 0; }
+
+    // 格式化：清空日志区（包括旧文件系统残留的事务）并写入空日志头
+    bool format();
+    // 重放已提交的事务，apply 把一个块的新内容写到原位置；replayed 返回事务数。
+    // 完成后调用方需把重放的块写回并调用 reset()
+    bool recover(const std::function<bool(uint32_t, const uint8_t*)>& apply, uint32_t& replayed);
+
+    // 一个 count 块的事务能否写入剩余空间
+    bool fits(size_t count) const { return head_ + count + 2 <= blocks_; }
+    // 已用空间超过一半时应当检查点，保证下一批事务有空间
+    bool wants_checkpoint() const { return head_ > 1 + (blocks_ - 1) / 2; }
+    bool empty() const { return head_ == 1; }
+    // 块是否出现在尚未清空的日志中（原地覆盖前须先检查点，否则重放会写回旧内容）
+    bool contains(uint32_t block) const { return live_.count(block) != 0; }
+
+    // 写入一个事务并 barrier；调用方保证 fits(blocks.size())
+    bool log(const std::vector<BlockWrite>& blocks);
+    // 检查点完成（日志中的块已原地写回）后清空日志
+    bool reset();
+
+    const Stats& stats() const { return stats_; }
+    void dump(std::ostream& os) const;
+
+private:
+    DiskDevice* disk_;
+    uint32_t start_ = 0;
+    uint32_t blocks_ = 0;
+    uint32_t head_ = 1;        // 下一个事务的起始位置（相对日志区）
+    uint32_t sequence_ = 1;    // 下一个事务的序号
+    std::unordered_set<uint32_t> live_;
+    Stats stats_;
+
+    bool write_header();
+    bool wipe();
+};
@@ -7,13 +7,19 @@
 
 class Kernel {
 public:
-    Kernel();
+    explicit Kernel(DiskBackendKind disk_backend = DiskBackendKind::Stream,
+                    DiskGeometry disk_geometry = {});
     
     ProcessManager& get_process_manager() { return pm_; }
     MemoryManager& get_memory_manager() { return mm_; }
     DiskDevice& get_disk_device() { return disk_; }
     DeviceManager& get_device_manager() { return dev_mgr_; }
     FileSystem& get_file_system() { return fs_; }
+
+    // 启用模拟磁盘时序（默认关闭，块访问不耗费模拟时间）
+    void enable_disk_timing(DiskSchedPolicy policy, DiskTiming timing = {}) {
+        pm_.enable_disk_timing(disk_, policy, timing);
+    }
     
 private:
     // 基础硬件设备
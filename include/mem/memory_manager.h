@@ -42,7 +42,7 @@ private:
     
     size_t page_size_ = config::PAGE_SIZE;
     size_t clock_ptr_ = 0;
-    size_t next_swap_block_ = config::SWAP_START_BLOCK;
+    size_t next_swap_block_ = 0;  // 首次换出时从 disk_.swap_start() 开始（挂载后才确定）
 
     bool handle_page_fault(int pid, size_t page_number, AccessType type);
 };
@@ -11,6 +11,7 @@ enum class BlockReason : uint8_t {
     None = 0,
     Sleep = 1,
     Device = 2,
+    DiskIo = 3,  // 等待模拟磁盘完成本进程发起的请求
 };
 
 struct PCB {
@@ -23,6 +24,7 @@ struct PCB {
     int blocked_time = 0;
     BlockReason blocked_reason = BlockReason::None;
     uint32_t waiting_device = UINT32_MAX;
+    size_t disk_io_pending = 0;  // 尚未完成的模拟磁盘请求数
     
     std::shared_ptr<Program> program;
     size_t pc = 0;
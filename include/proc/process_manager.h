@@ -2,12 +2,15 @@
 #include "process.h"
 #include "instruction.h"
 #include "dev/device_manager.h"
+#include "dev/disk.h"
+#include "dev/disk_scheduler.h"
 #include "fs/file_system.h"
 #include "mem/memory_manager.h"
 #include <map>
 #include <queue>
 #include <string>
 #include <memory>
+#include <vector>
 
 class Program;
 
@@ -16,6 +19,7 @@ public:
     ProcessManager(MemoryManager& memory_manager,
                    DeviceManager& device_manager,
                    FileSystem& file_system);
+    ~ProcessManager();
     
     int create_process(int total_time = 10);
     int create_process_from_file(const std::string& filename);
@@ -28,6 +32,11 @@ public:
     void block_process(int pid, int duration);
     void wakeup_process(int pid);
     
+    // 启用磁盘时序模型：指令执行期间到达后端的访问排入 DiskScheduler，
+    // 发起进程阻塞到这些请求全部完成。已启用时只替换策略。
+    void enable_disk_timing(DiskDevice& disk, DiskSchedPolicy policy, DiskTiming timing = {});
+    DiskScheduler* get_disk_scheduler() { return disk_sched_.get(); }
+
     MemoryManager& get_memory_manager() { return memory_manager_; }
     DeviceManager& get_device_manager() { return device_manager_; }
 
@@ -41,9 +50,15 @@ private:
     MemoryManager& memory_manager_;
     DeviceManager& device_manager_;
     FileSystem& file_system_;
+
+    DiskDevice* timed_disk_ = nullptr;
+    std::unique_ptr<DiskScheduler> disk_sched_;
+    int io_pid_ = -1;  // 正在执行指令、磁盘访问归属的进程
+    std::vector<DiskRequest> completed_io_;
     
     void schedule();
     void check_blocked_processes();
+    void complete_disk_io(double now);
     void execute_instruction(PCB& pcb, const Instruction& inst);
     int allocate_script_fd(PCB& pcb);
     void close_all_process_files(PCB& pcb);
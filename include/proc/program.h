@@ -9,6 +9,7 @@ public:
     static std::shared_ptr<Program> load_from_file(const std::string& filename);
     static std::shared_ptr<Program> create_default(int length);
     static std::shared_ptr<Program> create_compute_only(int length);
+    static std::shared_ptr<Program> from_instructions(std::vector<Instruction> instructions);
     
     const Instruction& get_instruction(size_t pc) const;
     size_t size() const { return instructions_.size(); }
@@ -0,0 +1,71 @@
+#pragma once
+#include "instruction.h"
+#include "common/config.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Program;
+
+// 合成负载生成器：按种子与参数组合在内存中构造 Program，
+// 同一 (seed, 进程序号, 参数) 总是生成完全相同的指令流。
+namespace workload {
+
+enum class AccessPattern { Uniform, Sequential, Strided, Zipfian };
+
+// 各类操作的相对权重。文件操作展开为 FO/FR|FW/FC，设备操作展开为 DR/C.../DD。
+struct Mix {
+    uint32_t compute = 50;
+    uint32_t mem_read = 20;
+    uint32_t mem_write = 10;
+    uint32_t file = 10;
+    uint32_t device = 5;
+    uint32_t sleep = 5;
+};
+
+struct Params {
+    uint64_t seed = 1;
+    size_t program_length = 200;  // 每个进程的指令数（近似，操作组不会被截断）
+    Mix mix;
+
+    AccessPattern access = AccessPattern::Uniform;
+    size_t virtual_pages = config::DEFAULT_VIRTUAL_PAGES;
+    size_t stride_pages = 4;
+    double zipf_theta = 0.99;
+
+    uint32_t num_files = 16;      // 文件操作在 /wl0 ... /wl{n-1} 之间选择
+    uint32_t min_io_bytes = 64;
+    uint32_t max_io_bytes = 4096;
+    uint32_t write_percent = 50;  // 文件操作中写的比例
+
+    uint32_t num_devices = 1;     // 设备 id 取 0 ... n-1，越少竞争越激烈
+    uint32_t device_hold = 3;     // 持有设备期间执行的计算指令数
+    uint32_t max_sleep = 3;
+};
+
+// 负载中第 i 个文件的路径（运行前需由调用方创建）
+std::string file_path(uint32_t index);
+
+bool parse_access_pattern(const std::string& s, AccessPattern& out);
+const char* access_pattern_name(AccessPattern p);
+
+// 解析形如 "compute=50,read=20,write=10,file=10,device=5,sleep=5" 的权重串
+bool parse_mix(const std::string& s, Mix& out);
+
+class Generator {
+public:
+    explicit Generator(Params params);
+
+    // 生成第 index 个进程的指令流
+    std::vector<Instruction> generate(uint64_t index) const;
+    std::shared_ptr<Program> make_program(uint64_t index) const;
+
+    const Params& params() const { return params_; }
+
+private:
+    Params params_;
+    std::vector<double> zipf_cdf_;  // 仅 Zipfian 模式使用
+};
+
+}  // namespace workload
@@ -0,0 +1,118 @@
+#include "common/event_trace.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace trace {
+namespace {
+
+const char* const kEventNames[static_cast<size_t>(EventType::Count)] = {
+    "TickStart", "Schedule", "PageFault", "Evict",        "SwapIn",
+    "SwapOut",   "DevGrant", "DevQueue",  "DevRelease",   "FsOp",
+    "Preempt",   "SliceExpired", "Block", "Wakeup",       "Exit",
+};
+
+const char* const kFsOpNames[] = {
+    "create", "remove", "mkdir", "open", "close", "read", "write",
+};
+
+TraceFileHeader make_header() {
+    TraceFileHeader header{};
+    memcpy(header.magic, "TNXTRACE", sizeof(header.magic));
+    header.version = 1;
+    header.event_size = sizeof(Event);
+    return header;
+}
+
+void write_events(std::ostream& os, const std::vector<Event>& events,
+                  uint64_t mask, uint64_t begin, uint64_t end) {
+    // 环形缓冲最多分两段连续内存写出
+    while (begin < end) {
+        const uint64_t idx = begin & mask;
+        const uint64_t run = std::min<uint64_t>(end - begin, events.size() - idx);
+        os.write(reinterpret_cast<const char*>(&events[idx]),
+                 static_cast<std::streamsize>(run * sizeof(Event)));
+        begin += run;
+    }
+}
+
+}  // namespace
+
+EventRing::EventRing(size_t capacity)
+    : events_(capacity), mask_(capacity - 1) {}
+
+EventRing::~EventRing() {
+    stop_stream();
+}
+
+size_t EventRing::size() const {
+    return static_cast<size_t>(std::min<uint64_t>(head_, events_.size()));
+}
+
+uint64_t EventRing::overwritten() const {
+    return head_ > events_.size() ? head_ - events_.size() : 0;
+}
+
+void EventRing::clear() {
+    head_ = 0;
+    flushed_ = 0;
+}
+
+void EventRing::dump_text(std::ostream& os, size_t n) const {
+    for_each_recent(n, [&os](const Event& ev) {
+        os << "tick=" << ev.tick << " " << event_name(ev.type)
+           << " pid=" << ev.pid;
+        if (ev.type == EventType::FsOp &&
+            ev.aux < std::size(kFsOpNames)) {
+            os << " op=" << kFsOpNames[ev.aux];
+        } else {
+            os << " aux=" << ev.aux;
+        }
+        os << " arg=" << ev.arg << "\n";
+    });
+}
+
+bool EventRing::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    const TraceFileHeader header = make_header();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_events(out, events_, mask_, head_ - size(), head_);
+    return out.good();
+}
+
+bool EventRing::start_stream(const std::string& filename) {
+    stop_stream();
+    stream_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!stream_.is_open()) {
+        return false;
+    }
+    const TraceFileHeader header = make_header();
+    stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    // 从当前缓冲中最旧的事件开始输出
+    flushed_ = head_ - size();
+    streaming_ = true;
+    return stream_.good();
+}
+
+void EventRing::stop_stream() {
+    if (!streaming_) {
+        return;
+    }
+    flush_stream();
+    streaming_ = false;
+    stream_.close();
+}
+
+void EventRing::flush_stream() {
+    write_events(stream_, events_, mask_, flushed_, head_);
+    flushed_ = head_;
+}
+
+const char* event_name(EventType type) {
+    return kEventNames[static_cast<size_t>(type)];
+}
+
+}  // namespace trace
@@ -0,0 +1,103 @@
+#include "common/log.h"
+#include <iostream>
+#include <iterator>
+#include <streambuf>
+
+namespace logging {
+namespace {
+
+const char* const kSubsystemNames[kSubsystemCount] = {
+    "kernel", "proc", "memory", "swap", "fs", "dev", "disk",
+};
+
+const char* const kLevelNames[] = {"off", "error", "warn", "info", "debug"};
+
+// 追加写入 std::string 的 streambuf，容量在行与行之间复用，避免反复分配。
+class LineBuffer : public std::streambuf {
+public:
+    std::string& str() { return buf_; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            buf_.push_back(traits_type::to_char_type(ch));
+        }
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        buf_.append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+private:
+    std::string buf_;
+};
+
+struct LineState {
+    LineBuffer buffer;
+    std::ostream stream{&buffer};
+};
+
+LineState& line_state() {
+    thread_local LineState state;
+    return state;
+}
+
+}  // namespace
+
+void set_level(Subsystem sub, Level level) {
+    g_levels[static_cast<size_t>(sub)] = level;
+}
+
+void set_all_levels(Level level) {
+    for (auto& l : g_levels) {
+        l = level;
+    }
+}
+
+Level get_level(Subsystem sub) {
+    return g_levels[static_cast<size_t>(sub)];
+}
+
+const char* subsystem_name(Subsystem sub) {
+    return kSubsystemNames[static_cast<size_t>(sub)];
+}
+
+const char* level_name(Level level) {
+    return kLevelNames[static_cast<size_t>(level)];
+}
+
+std::optional<Subsystem> parse_subsystem(const std::string& name) {
+    for (size_t i = 0; i < kSubsystemCount; ++i) {
+        if (name == kSubsystemNames[i]) {
+            return static_cast<Subsystem>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Level> parse_level(const std::string& name) {
+    for (size_t i = 0; i < std::size(kLevelNames); ++i) {
+        if (name == kLevelNames[i]) {
+            return static_cast<Level>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+LogLine::LogLine() {
+    line_state().buffer.str().clear();
+}
+
+LogLine::~LogLine() {
+    std::string& line = line_state().buffer.str();
+    line.push_back('\n');
+    std::cerr.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+std::ostream& LogLine::stream() {
+    return line_state().stream;
+}
+
+}  // namespace logging
@@ -0,0 +1,156 @@
+#include "common/metrics.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace metrics {
+
+uint64_t Histogram::percentile(double p) const {
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += bucket(i);
+        if (seen >= rank) {
+            return std::min(bucket_bound(i), max());
+        }
+    }
+    return max();
+}
+
+void Histogram::reset() {
+    for (auto& b : buckets_) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = counters_[name];
+    if (!entry.metric) {
+        entry.help = help;
+        entry.metric = std::make_unique<Counter>();
+    }
+    return *entry.metric;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = gauges_[name];
+    if (!entry.metric) {
+        entry.help = help;
+        entry.metric = std::make_unique<Gauge>();
+    }
+    return *entry.metric;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = histograms_[name];
+    if (!entry.metric) {
+        entry.help = help;
+        entry.metric = std::make_unique<Histogram>();
+    }
+    return *entry.metric;
+}
+
+void Registry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [name, entry] : counters_) entry.metric->reset();
+    for (auto& [name, entry] : histograms_) entry.metric->reset();
+}
+
+void Registry::dump_table(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    os << std::left << std::setw(32) << "Metric" << std::setw(10) << "Type"
+       << "Value\n";
+    os << std::string(72, '-') << "\n";
+    for (const auto& [name, entry] : counters_) {
+        os << std::setw(32) << name << std::setw(10) << "counter"
+           << entry.metric->value() << "\n";
+    }
+    for (const auto& [name, entry] : gauges_) {
+        os << std::setw(32) << name << std::setw(10) << "gauge"
+           << entry.metric->value() << "\n";
+    }
+    for (const auto& [name, entry] : histograms_) {
+        const Histogram& h = *entry.metric;
+        const uint64_t count = h.count();
+        os << std::setw(32) << name << std::setw(10) << "histogram"
+           << "count=" << count;
+        if (count > 0) {
+            os << " mean=" << h.sum() / count << " p50=" << h.percentile(0.5)
+               << " p99=" << h.percentile(0.99) << " max=" << h.max();
+        }
+        os << "\n";
+    }
+    os << std::right;
+}
+
+void Registry::write_prometheus(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, entry] : counters_) {
+        os << "# HELP tinix_" << name << " " << entry.help << "\n"
+           << "# TYPE tinix_" << name << " counter\n"
+           << "tinix_" << name << " " << entry.metric->value() << "\n";
+    }
+    for (const auto& [name, entry] : gauges_) {
+        os << "# HELP tinix_" << name << " " << entry.help << "\n"
+           << "# TYPE tinix_" << name << " gauge\n"
+           << "tinix_" << name << " " << entry.metric->value() << "\n";
+    }
+    for (const auto& [name, entry] : histograms_) {
+        const Histogram& h = *entry.metric;
+        os << "# HELP tinix_" << name << " " << entry.help << "\n"
+           << "# TYPE tinix_" << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < Histogram::kBuckets; ++i) {
+            cumulative += h.bucket(i);
+            os << "tinix_" << name << "_bucket{le=\"" << Histogram::bucket_bound(i)
+               << "\"} " << cumulative << "\n";
+        }
+        os << "tinix_" << name << "_bucket{le=\"+Inf\"} " << h.count() << "\n"
+           << "tinix_" << name << "_sum " << h.sum() << "\n"
+           << "tinix_" << name << "_count " << h.count() << "\n";
+    }
+}
+
+void Registry::write_json(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    os << "{\n  \"counters\": {";
+    const char* sep = "\n";
+    for (const auto& [name, entry] : counters_) {
+        os << sep << "    \"" << name << "\": " << entry.metric->value();
+        sep = ",\n";
+    }
+    os << "\n  },\n  \"gauges\": {";
+    sep = "\n";
+    for (const auto& [name, entry] : gauges_) {
+        os << sep << "    \"" << name << "\": " << entry.metric->value();
+        sep = ",\n";
+    }
+    os << "\n  },\n  \"histograms\": {";
+    sep = "\n";
+    for (const auto& [name, entry] : histograms_) {
+        const Histogram& h = *entry.metric;
+        os << sep << "    \"" << name << "\": {\"count\": " << h.count()
+           << ", \"sum\": " << h.sum() << ", \"max\": " << h.max()
+           << ", \"p50\": " << h.percentile(0.5)
+           << ", \"p90\": " << h.percentile(0.9)
+           << ", \"p99\": " << h.percentile(0.99) << "}";
+        sep = ",\n";
+    }
+    os << "\n  }\n}\n";
+}
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+}  // namespace metrics
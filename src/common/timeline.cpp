@@ -0,0 +1,250 @@
+#include "common/timeline.h"
+#include "proc/process.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+
+namespace trace {
+namespace {
+
+// Chrome trace 中的“进程”分组：模拟进程、设备、文件系统各一组
+constexpr int kProcGroup = 1;
+constexpr int kDevGroup = 2;
+constexpr int kFsGroup = 3;
+
+struct OpenSlice {
+    std::string name;
+    uint64_t start = 0;
+};
+
+class ChromeWriter {
+public:
+    explicit ChromeWriter(std::ostream& os) : os_(os) {}
+
+    void slice(int group, int64_t tid, const std::string& name,
+               uint64_t start, uint64_t end) {
+        begin_event();
+        os_ << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":" << group
+            << ",\"tid\":" << tid << ",\"ts\":" << start
+            << ",\"dur\":" << (end > start ? end - start : 0) << "}";
+    }
+
+    void instant(int group, int64_t tid, const char* name, uint64_t ts,
+                 const char* arg_name, uint64_t arg, const char* aux_name,
+                 uint64_t aux) {
+        begin_event();
+        os_ << "{\"name\":\"" << name << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":"
+            << group << ",\"tid\":" << tid << ",\"ts\":" << ts
+            << ",\"args\":{\"" << arg_name << "\":" << arg << ",\"" << aux_name
+            << "\":" << aux << "}}";
+    }
+
+    void counter(const char* name, uint64_t ts, uint64_t value) {
+        begin_event();
+        os_ << "{\"name\":\"" << name << "\",\"ph\":\"C\",\"pid\":" << kProcGroup
+            << ",\"ts\":" << ts << ",\"args\":{\"value\":" << value << "}}";
+    }
+
+    void group_name(int group, const char* name) {
+        begin_event();
+        os_ << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << group
+            << ",\"args\":{\"name\":\"" << name << "\"}}";
+    }
+
+    void track_name(int group, int64_t tid, const std::string& name) {
+        begin_event();
+        os_ << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << group
+            << ",\"tid\":" << tid << ",\"args\":{\"name\":\"" << name << "\"}}";
+    }
+
+private:
+    std::ostream& os_;
+    bool first_ = true;
+
+    void begin_event() {
+        os_ << (first_ ? "\n" : ",\n");
+        first_ = false;
+    }
+};
+
+const char* block_slice_name(uint32_t reason) {
+    switch (static_cast<BlockReason>(reason)) {
+        case BlockReason::Device: return "Blocked (Device)";
+        case BlockReason::DiskIo: return "Blocked (Disk I/O)";
+        default: return "Blocked (Sleep)";
+    }
+}
+
+const char* fs_op_name(uint32_t op) {
+    static const char* const kNames[] = {"create", "remove", "mkdir", "open",
+                                         "close",  "read",   "write"};
+    return op < std::size(kNames) ? kNames[op] : "fs";
+}
+
+}  // namespace
+
+Timeline::~Timeline() {
+    if (recording_) {
+        ring_.set_tap(nullptr);
+    }
+}
+
+void Timeline::start(const std::string& auto_save_path) {
+    events_.clear();
+    auto_save_path_ = auto_save_path;
+    recording_ = true;
+    ring_.set_tap(&events_);
+}
+
+void Timeline::stop() {
+    recording_ = false;
+    ring_.set_tap(nullptr);
+}
+
+bool Timeline::finish() {
+    stop();
+    if (auto_save_path_.empty()) {
+        return true;
+    }
+    const bool ok = write_chrome_json(auto_save_path_);
+    auto_save_path_.clear();
+    return ok;
+}
+
+bool Timeline::write_chrome_json(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    write_chrome_json(out);
+    return out.good();
+}
+
+void Timeline::write_chrome_json(std::ostream& os) const {
+    os << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"time_unit\":\"tick\"},"
+       << "\"traceEvents\":[";
+    ChromeWriter w(os);
+    w.group_name(kProcGroup, "Processes");
+    w.group_name(kDevGroup, "Devices");
+    w.group_name(kFsGroup, "File System");
+
+    std::map<int, OpenSlice> running;   // pid -> Running 片段
+    std::map<int, OpenSlice> blocked;   // pid -> Blocked 片段
+    std::map<uint32_t, OpenSlice> owned;  // dev -> 占用片段
+    std::set<int> pids;
+    std::set<uint32_t> devs;
+    bool fs_used = false;
+    uint64_t last_tick = 0;
+    uint64_t last_procs = UINT64_MAX;
+
+    auto close = [&](auto& slices, auto key, int group, int64_t tid, uint64_t end) {
+        auto it = slices.find(key);
+        if (it != slices.end()) {
+            w.slice(group, tid, it->second.name, it->second.start, end);
+            slices.erase(it);
+        }
+    };
+
+    for (const Event& ev : events_) {
+        const uint64_t t = ev.tick;
+        last_tick = std::max(last_tick, t);
+        if (ev.pid >= 0) {
+            pids.insert(ev.pid);
+        }
+        switch (ev.type) {
+            case EventType::TickStart:
+                if (ev.aux != last_procs) {
+                    w.counter("processes", t, ev.aux);
+                    last_procs = ev.aux;
+                }
+                break;
+            case EventType::Schedule:
+                close(running, ev.pid, kProcGroup, ev.pid, t);
+                running[ev.pid] = {"Running", t};
+                break;
+            case EventType::Preempt:
+            case EventType::SliceExpired:
+                close(running, ev.pid, kProcGroup, ev.pid, t);
+                break;
+            case EventType::Block:
+                close(running, ev.pid, kProcGroup, ev.pid, t);
+                close(blocked, ev.pid, kProcGroup, ev.pid, t);
+                blocked[ev.pid] = {block_slice_name(ev.aux), t};
+                break;
+            case EventType::Wakeup:
+                close(blocked, ev.pid, kProcGroup, ev.pid, t);
+                break;
+            case EventType::Exit:
+                close(running, ev.pid, kProcGroup, ev.pid, t);
+                close(blocked, ev.pid, kProcGroup, ev.pid, t);
+                break;
+            case EventType::PageFault:
+                w.instant(kProcGroup, ev.pid, "PageFault", t, "vpage", ev.arg,
+                          "write", ev.aux);
+                break;
+            case EventType::Evict:
+                w.instant(kProcGroup, ev.pid, "Evict", t, "vpage", ev.arg,
+                          "frame", ev.aux);
+                break;
+            case EventType::SwapIn:
+                w.instant(kProcGroup, ev.pid, "SwapIn", t, "vpage", ev.arg,
+                          "block", ev.aux);
+                break;
+            case EventType::SwapOut:
+                w.instant(kProcGroup, ev.pid, "SwapOut", t, "vpage", ev.arg,
+                          "block", ev.aux);
+                break;
+            case EventType::DevGrant:
+                devs.insert(ev.aux);
+                close(owned, ev.aux, kDevGroup, ev.aux, t);
+                owned[ev.aux] = {"pid " + std::to_string(ev.pid), t};
+                break;
+            case EventType::DevRelease:
+                devs.insert(ev.aux);
+                close(owned, ev.aux, kDevGroup, ev.aux, t);
+                break;
+            case EventType::DevQueue:
+                devs.insert(ev.aux);
+                w.instant(kDevGroup, ev.aux, "Queued", t, "pid",
+                          static_cast<uint64_t>(ev.pid), "qlen", ev.arg);
+                break;
+            case EventType::FsOp:
+                fs_used = true;
+                w.instant(kFsGroup, 0, fs_op_name(ev.aux), t, "value", ev.arg,
+                          "op", ev.aux);
+                break;
+            case EventType::Count:
+                break;
+        }
+    }
+
+    // 录制结束时仍未闭合的片段截断到最后一个 tick 之后
+    const uint64_t end = last_tick + 1;
+    while (!running.empty()) {
+        const int pid = running.begin()->first;
+        close(running, pid, kProcGroup, pid, end);
+    }
+    while (!blocked.empty()) {
+        const int pid = blocked.begin()->first;
+        close(blocked, pid, kProcGroup, pid, end);
+    }
+    while (!owned.empty()) {
+        const uint32_t dev = owned.begin()->first;
+        close(owned, dev, kDevGroup, dev, end);
+    }
+
+    for (int pid : pids) {
+        w.track_name(kProcGroup, pid, "PID " + std::to_string(pid));
+    }
+    for (uint32_t dev : devs) {
+        w.track_name(kDevGroup, dev, "dev " + std::to_string(dev));
+    }
+    if (fs_used) {
+        w.track_name(kFsGroup, 0, "fs ops");
+    }
+    os << "\n]}\n";
+}
+
+}  // namespace trace
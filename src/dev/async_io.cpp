@@ -0,0 +1,317 @@
+#include "dev/async_io.h"
+#include "common/log.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+bool parse_async_engine(const std::string& s, AsyncEngineKind& out) {
+    if (s == "auto") {
+        out = AsyncEngineKind::Auto;
+    } else if (s == "uring" || s == "io_uring") {
+        out = AsyncEngineKind::Uring;
+    } else if (s == "pool") {
+        out = AsyncEngineKind::Pool;
+    } else if (s == "sync") {
+        out = AsyncEngineKind::Sync;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* async_engine_name(AsyncEngineKind kind) {
+    switch (kind) {
+        case AsyncEngineKind::Auto: return "auto";
+        case AsyncEngineKind::Uring: return "uring";
+        case AsyncEngineKind::Pool: return "pool";
+        case AsyncEngineKind::Sync: return "sync";
+    }
+    return "?";
+}
+
+namespace {
+
+// ---- io_uring：不依赖 liburing，直接使用 io_uring_setup/io_uring_enter 与共享环 ----
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+class UringEngine : public AsyncIoEngine {
+public:
+    UringEngine(int file_fd, size_t block_size) : file_fd_(file_fd), block_size_(block_size) {}
+
+    ~UringEngine() override {
+        if (sqes_) {
+            munmap(sqes_, sqes_size_);
+        }
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) {
+            munmap(cq_ptr_, cq_size_);
+        }
+        if (sq_ptr_) {
+            munmap(sq_ptr_, sq_size_);
+        }
+        if (ring_fd_ >= 0) {
+            close(ring_fd_);
+        }
+    }
+
+    bool init(size_t depth) {
+        io_uring_params p{};
+        ring_fd_ = sys_io_uring_setup(static_cast<unsigned>(depth), &p);
+        if (ring_fd_ < 0) {
+            return false;
+        }
+
+        sq_size_ = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+        cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+
+        sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) {
+            sq_ptr_ = nullptr;
+            return false;
+        }
+        if (single_mmap) {
+            cq_ptr_ = sq_ptr_;
+        } else {
+            cq_ptr_ = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ptr_ == MAP_FAILED) {
+                cq_ptr_ = nullptr;
+                return false;
+            }
+        }
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<uint8_t*>(sq_ptr_);
+        sq_tail_ = reinterpret_cast<std::atomic<uint32_t>*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<uint32_t*>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<uint32_t*>(sq + p.sq_off.array);
+        auto* cq = static_cast<uint8_t*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<std::atomic<uint32_t>*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<std::atomic<uint32_t>*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<uint32_t*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    bool submit(IoRequest* req) override {
+        const uint32_t tail = sq_tail_->load(std::memory_order_relaxed);
+        const uint32_t idx = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+
+        // READV/WRITEV 自 5.1 起可用，比 READ/WRITE 兼容更老的内核
+        req->iov.iov_base = req->data.get();
+        req->iov.iov_len = req->count * block_size_;
+        sqe.opcode = req->write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe.fd = file_fd_;
+        sqe.off = static_cast<uint64_t>(req->block_id) * block_size_;
+        sqe.addr = reinterpret_cast<uint64_t>(&req->iov);
+        sqe.len = 1;
+        sqe.user_data = reinterpret_cast<uint64_t>(req);
+
+        sq_array_[idx] = idx;
+        sq_tail_->store(tail + 1, std::memory_order_release);
+        ++unsubmitted_;
+        return true;
+    }
+
+    void kick() override {
+        while (unsubmitted_ > 0) {
+            const int n = sys_io_uring_enter(ring_fd_, unsubmitted_, 0, 0);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    continue;
+                }
+                LOG_ERROR(Disk, "[Disk] io_uring_enter failed: " << std::strerror(errno));
+                return;
+            }
+            unsubmitted_ -= static_cast<unsigned>(n);
+        }
+    }
+
+    void reap(bool wait, std::vector<IoRequest*>& completed) override {
+        kick();
+        for (;;) {
+            uint32_t head = cq_head_->load(std::memory_order_relaxed);
+            const uint32_t tail = cq_tail_->load(std::memory_order_acquire);
+            const size_t before = completed.size();
+            while (head != tail) {
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                auto* req = reinterpret_cast<IoRequest*>(cqe.user_data);
+                req->ok = cqe.res == static_cast<int32_t>(req->count * block_size_);
+                completed.push_back(req);
+                ++head;
+            }
+            cq_head_->store(head, std::memory_order_release);
+
+            if (!wait || completed.size() > before) {
+                return;
+            }
+            const int rc = sys_io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+            if (rc < 0 && errno != EINTR) {
+                LOG_ERROR(Disk, "[Disk] io_uring wait failed: " << std::strerror(errno));
+                return;
+            }
+        }
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+private:
+    int file_fd_;
+    size_t block_size_;
+    int ring_fd_ = -1;
+    unsigned unsubmitted_ = 0;
+
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    std::atomic<uint32_t>* sq_tail_ = nullptr;
+    uint32_t sq_mask_ = 0;
+    uint32_t* sq_array_ = nullptr;
+    std::atomic<uint32_t>* cq_head_ = nullptr;
+    std::atomic<uint32_t>* cq_tail_ = nullptr;
+    uint32_t cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+// ---- 线程池：工作线程调用后端的同步读写；后端非线程安全时串行访问 ----
+
+class PoolEngine : public AsyncIoEngine {
+public:
+    PoolEngine(DiskBackend& backend, size_t block_size, size_t workers, std::mutex* serialize)
+        : backend_(backend), block_size_(block_size), serialize_(serialize) {
+        for (size_t i = 0; i < workers; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~PoolEngine() override {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        pending_cv_.notify_all();
+        for (auto& t : workers_) {
+            t.join();
+        }
+    }
+
+    bool submit(IoRequest* req) override {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            pending_.push_back(req);
+        }
+        pending_cv_.notify_one();
+        return true;
+    }
+
+    void reap(bool wait, std::vector<IoRequest*>& completed) override {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (wait) {
+            done_cv_.wait(lock, [this] { return !done_.empty(); });
+        }
+        completed.insert(completed.end(), done_.begin(), done_.end());
+        done_.clear();
+    }
+
+    const char* name() const override { return "thread-pool"; }
+
+private:
+    DiskBackend& backend_;
+    size_t block_size_;
+    std::vector<std::thread> workers_;
+    std::mutex mu_;
+    std::condition_variable pending_cv_;
+    std::condition_variable done_cv_;
+    std::deque<IoRequest*> pending_;
+    std::vector<IoRequest*> done_;
+    bool stopping_ = false;
+    std::mutex* serialize_;  // 后端非线程安全时与 DiskDevice 共用的互斥量
+
+    void worker_loop() {
+        for (;;) {
+            IoRequest* req = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                pending_cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+                if (pending_.empty()) {
+                    return;
+                }
+                req = pending_.front();
+                pending_.pop_front();
+            }
+
+            if (serialize_) {
+                std::lock_guard<std::mutex> lock(*serialize_);
+                req->ok = execute(req);
+            } else {
+                req->ok = execute(req);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                done_.push_back(req);
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+    bool execute(IoRequest* req) {
+        std::vector<uint8_t*> buffers(req->count);
+        for (size_t i = 0; i < req->count; ++i) {
+            buffers[i] = req->data.get() + i * block_size_;
+        }
+        return req->write ? backend_.write_run(req->block_id, buffers.data(), req->count)
+                          : backend_.read_run(req->block_id, buffers.data(), req->count);
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<AsyncIoEngine> make_uring_engine(int fd, size_t block_size, size_t depth) {
+    if (fd < 0) {
+        return nullptr;
+    }
+    auto engine = std::make_unique<UringEngine>(fd, block_size);
+    if (!engine->init(depth)) {
+        return nullptr;
+    }
+    return engine;
+}
+
+std::unique_ptr<AsyncIoEngine> make_pool_engine(DiskBackend& backend, size_t block_size,
+                                                size_t workers, std::mutex* serialize) {
+    return std::make_unique<PoolEngine>(backend, block_size, workers, serialize);
+}
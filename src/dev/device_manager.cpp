@@ -1,10 +1,29 @@
 #include "dev/device_manager.h"
 
+#include "common/event_trace.h"
+#include "common/log.h"
+#include "common/metrics.h"
+
 #include <algorithm>
-#include <iostream>
 
 namespace {
 constexpr uint32_t kDiskDeviceId = 0;
+
+struct DevMetrics {
+    metrics::Counter& requests = metrics::registry().counter(
+        "dev_requests_total", "Device requests");
+    metrics::Counter& grants = metrics::registry().counter(
+        "dev_grants_total", "Device grants, immediate or by hand-over");
+    metrics::Counter& contended = metrics::registry().counter(
+        "dev_contended_requests_total", "Requests queued behind another owner");
+    metrics::Counter& releases = metrics::registry().counter(
+        "dev_releases_total", "Successful device releases");
+    metrics::Counter& invalid = metrics::registry().counter(
+        "dev_invalid_ops_total", "Requests or releases rejected as invalid");
+    metrics::Histogram& queue_len = metrics::registry().histogram(
+        "dev_wait_queue_length", "Wait queue length observed on enqueue");
+};
+DevMetrics g_dev_metrics;
 }
 
 DeviceManager::DeviceManager() {
@@ -21,10 +40,12 @@ bool DeviceManager::has_device(uint32_t dev_id) const {
 }
 
 bool DeviceManager::request(int pid, uint32_t dev_id) {
+    g_dev_metrics.requests.inc();
     auto it = devices_.find(dev_id);
     if (it == devices_.end()) {
-        std::cerr << "[Dev] Invalid device id=" << dev_id << " (pid=" << pid
-                  << ")\n";
+        g_dev_metrics.invalid.inc();
+        LOG_WARN(Dev, "[Dev] Invalid device id=" << dev_id << " (pid=" << pid
+                          << ")");
         return false;
     }
 
@@ -32,14 +53,17 @@ bool DeviceManager::request(int pid, uint32_t dev_id) {
 
     if (dev.owner_pid == -1) { // 成功分配：设备未被占用
         dev.owner_pid = pid;
-        std::cerr << "[Dev] Granted dev=" << dev_id << " (" << dev.name
-                  << ") to pid=" << pid << "\n";
+        g_dev_metrics.grants.inc();
+        trace::record(trace::EventType::DevGrant, pid, dev_id);
+        LOG_INFO(Dev, "[Dev] Granted dev=" << dev_id << " (" << dev.name
+                          << ") to pid=" << pid);
         return true;
     }
 
     if (dev.owner_pid == pid) { // 成功分配：设备已被该进程占用
-        std::cerr << "[Dev] Request dev=" << dev_id << " (" << dev.name
-                  << ") ignored: pid=" << pid << " already owns it\n";
+        LOG_INFO(Dev, "[Dev] Request dev=" << dev_id << " (" << dev.name
+                          << ") ignored: pid=" << pid
+                          << " already owns it");
         return true;
     }
 
@@ -50,12 +74,18 @@ bool DeviceManager::request(int pid, uint32_t dev_id) {
         dev.wait_queue.end(); // 该进程是否已在等待此设备
     if (!already_waiting) {
         dev.wait_queue.push_back(pid);
-        std::cerr << "[Dev] Queued pid=" << pid << " for dev=" << dev_id
-                  << " (" << dev.name << "), owner=" << dev.owner_pid
-                  << ", qlen=" << dev.wait_queue.size() << "\n";
+        g_dev_metrics.contended.inc();
+        g_dev_metrics.queue_len.observe(dev.wait_queue.size());
+        trace::record(trace::EventType::DevQueue, pid, dev_id,
+                      dev.wait_queue.size());
+        LOG_INFO(Dev, "[Dev] Queued pid=" << pid << " for dev=" << dev_id
+                          << " (" << dev.name
+                          << "), owner=" << dev.owner_pid
+                          << ", qlen=" << dev.wait_queue.size());
     } else {
-        std::cerr << "[Dev] Request dev=" << dev_id << " (" << dev.name
-                  << ") ignored: pid=" << pid << " already queued\n";
+        LOG_INFO(Dev, "[Dev] Request dev=" << dev_id << " (" << dev.name
+                          << ") ignored: pid=" << pid
+                          << " already queued");
     }
 
     return false;
@@ -64,34 +94,42 @@ bool DeviceManager::request(int pid, uint32_t dev_id) {
 std::optional<int> DeviceManager::release(int pid, uint32_t dev_id) {
     auto it = devices_.find(dev_id);
     if (it == devices_.end()) {
-        std::cerr << "[Dev] Invalid device id=" << dev_id << " (release by pid="
-                  << pid << ")\n";
+        g_dev_metrics.invalid.inc();
+        LOG_WARN(Dev, "[Dev] Invalid device id=" << dev_id
+                          << " (release by pid=" << pid
+                          << ")");
         return std::nullopt;
     }
 
     Device& dev = it->second;
     if (dev.owner_pid != pid) {
-        std::cerr << "[Dev] Release dev=" << dev_id << " (" << dev.name
-                  << ") denied: owner=" << dev.owner_pid << ", pid=" << pid
-                  << "\n";
+        g_dev_metrics.invalid.inc();
+        LOG_WARN(Dev, "[Dev] Release dev=" << dev_id << " (" << dev.name
+                          << ") denied: owner=" << dev.owner_pid
+                          << ", pid=" << pid);
         return std::nullopt;
     }
 
     dev.owner_pid = -1;
+    g_dev_metrics.releases.inc();
+    trace::record(trace::EventType::DevRelease, pid, dev_id);
 
     if (dev.wait_queue.empty()) {
-        std::cerr << "[Dev] Released dev=" << dev_id << " (" << dev.name
-                  << ") by pid=" << pid << "\n";
+        LOG_INFO(Dev, "[Dev] Released dev=" << dev_id << " (" << dev.name
+                          << ") by pid=" << pid);
         return std::nullopt;
     }
 
     const int next_pid = dev.wait_queue.front();
     dev.wait_queue.pop_front();
     dev.owner_pid = next_pid;
+    g_dev_metrics.grants.inc();
+    trace::record(trace::EventType::DevGrant, next_pid, dev_id);
 
-    std::cerr << "[Dev] Released dev=" << dev_id << " (" << dev.name
-              << ") by pid=" << pid << ", reassigned to pid=" << next_pid
-              << ", qlen=" << dev.wait_queue.size() << "\n";
+    LOG_INFO(Dev, "[Dev] Released dev=" << dev_id << " (" << dev.name
+                      << ") by pid=" << pid
+                      << ", reassigned to pid=" << next_pid
+                      << ", qlen=" << dev.wait_queue.size());
 
     return next_pid;
 }
@@ -108,8 +146,9 @@ size_t DeviceManager::cancel_wait(int pid) {
         const size_t after = dev.wait_queue.size();
         if (after != before) {
             removed += (before - after);
-            std::cerr << "[Dev] Removed pid=" << pid << " from dev=" << dev_id
-                      << " (" << dev.name << ") wait queue\n";
+            LOG_INFO(Dev, "[Dev] Removed pid=" << pid << " from dev=" << dev_id
+                              << " (" << dev.name
+                              << ") wait queue");
         }
     }
     return removed;
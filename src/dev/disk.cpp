@@ -1,37 +1,158 @@
 #include "dev/disk.h"
-#include <iostream>
+#include "common/log.h"
+#include "common/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+struct DiskMetrics {
+    metrics::Counter& reads = metrics::registry().counter(
+        "disk_reads_total", "Blocks read from the disk image");
+    metrics::Counter& writes = metrics::registry().counter(
+        "disk_writes_total", "Blocks written to the disk image");
+    metrics::Counter& errors = metrics::registry().counter(
+        "disk_io_errors_total", "Failed block reads or writes");
+    metrics::Histogram& read_ns = metrics::registry().histogram(
+        "disk_read_latency_ns", "Block read latency in nanoseconds");
+    metrics::Histogram& write_ns = metrics::registry().histogram(
+        "disk_write_latency_ns", "Block write latency in nanoseconds");
+    metrics::Counter& syncs = metrics::registry().counter(
+        "disk_syncs_total", "Explicit sync() calls on the disk image");
+    metrics::Counter& barriers = metrics::registry().counter(
+        "disk_barriers_total", "Write barriers (buffered writes handed to the backend)");
+    metrics::Counter& backend_writes = metrics::registry().counter(
+        "disk_backend_writes_total", "Blocks written through to the backend");
+    metrics::Counter& buffered_hits = metrics::registry().counter(
+        "disk_writeback_read_hits_total", "Block reads served from the write-back buffer");
+    metrics::Gauge& dirty = metrics::registry().gauge(
+        "disk_dirty_blocks", "Blocks currently held in the write-back buffer");
+    metrics::Histogram& sync_ns = metrics::registry().histogram(
+        "disk_sync_latency_ns", "sync() latency in nanoseconds");
+    metrics::Counter& async_submitted = metrics::registry().counter(
+        "disk_async_submitted_total", "Block requests submitted to the async I/O engine");
+    metrics::Counter& async_completed = metrics::registry().counter(
+        "disk_async_completed_total", "Async block requests completed and reaped");
+    metrics::Gauge& queue_depth = metrics::registry().gauge(
+        "disk_io_queue_depth", "Configured async I/O queue depth");
+    metrics::Gauge& in_flight = metrics::registry().gauge(
+        "disk_io_in_flight", "Async block requests currently in flight");
+    metrics::Histogram& inflight_at_submit = metrics::registry().histogram(
+        "disk_async_inflight_at_submit", "Requests already in flight when a new one is submitted");
+    metrics::Histogram& async_ns = metrics::registry().histogram(
+        "disk_async_latency_ns", "Async request latency from submit to reap in nanoseconds");
+    metrics::Counter& runs = metrics::registry().counter(
+        "disk_backend_runs_total", "Contiguous block runs handed to the backend in one call");
+    metrics::Histogram& run_blocks = metrics::registry().histogram(
+        "disk_run_blocks", "Blocks per backend run");
+};
+DiskMetrics g_disk_metrics;
+
+IoRequest* new_request(bool write, size_t block_id, size_t count, size_t block_size,
+                       IoCallback done) {
+    auto* req = new IoRequest;
+    req->write = write;
+    req->block_id = block_id;
+    req->count = count;
+    req->done = std::move(done);
+    // O_DIRECT 要求缓冲按页对齐；块大小本身是页大小的整数倍
+    req->data.reset(static_cast<uint8_t*>(std::aligned_alloc(4096, count * block_size)));
+    return req;
+}
+}
 
 DiskDevice::DiskDevice() {
-    initialize_disk();
+    initialize_disk(DiskGeometry{});
+}
+
+DiskDevice::DiskDevice(std::string filename, DiskBackendKind backend, DiskGeometry geometry)
+    : filename_(std::move(filename)), backend_kind_(backend) {
+    initialize_disk(geometry);
 }
 
 DiskDevice::~DiskDevice() {
-    if (disk_file_.is_open()) {
-        disk_file_.close();
+    if (backend_) {
+        flush_dirty(true);
+        auto lock = lock_backend();
+        backend_->sync();
     }
 }
 
-void DiskDevice::initialize_disk() {
-    // 检查磁盘文件是否存在，不存在则创建并预分配空间
-    if (!std::filesystem::exists(filename_)) {
-        std::cerr << "[Disk] Creating new disk image: " << filename_ 
-                  << " (" << (num_blocks_ * block_size_) / 1024 << " KB)" << std::endl;
-        
-        std::ofstream outfile(filename_, std::ios::binary | std::ios::out);
-        std::vector<uint8_t> empty_block(block_size_, 0);
-        for (size_t i = 0; i < num_blocks_; ++i) {
-            outfile.write(reinterpret_cast<const char*>(empty_block.data()), block_size_);
+void DiskDevice::initialize_disk(const DiskGeometry& requested) {
+    if (requested.block_size != 0) {
+        block_size_ = requested.block_size;
+    }
+
+    // 已有镜像且未指定块数时按文件大小确定；新镜像或指定的块数更大时
+    // 直接把文件截断到目标大小（稀疏文件，不写入任何数据块）
+    // 纯内存盘不看也不碰镜像文件；ram-persist 只读取已有镜像的大小，由后端负责载入与保存
+    std::error_code ec;
+    const bool file_backed = disk_backend_uses_image_file(backend_kind_);
+    const bool exists = backend_kind_ != DiskBackendKind::Ram &&
+                        std::filesystem::exists(filename_, ec);
+    const uintmax_t file_size = exists ? std::filesystem::file_size(filename_, ec) : 0;
+    if (requested.num_blocks != 0) {
+        num_blocks_ = requested.num_blocks;
+    } else if (exists && file_size >= block_size_) {
+        num_blocks_ = static_cast<size_t>(file_size / block_size_);
+    }
+    if (requested.swap_blocks != 0) {
+        swap_blocks_ = requested.swap_blocks;
+        swap_requested_ = true;
+    }
+    if (swap_blocks_ >= num_blocks_) {
+        throw std::runtime_error("Disk geometry error: swap reservation of " +
+                                 std::to_string(swap_blocks_) + " blocks does not fit in " +
+                                 std::to_string(num_blocks_) + " blocks");
+    }
+
+    const uintmax_t image_size = static_cast<uintmax_t>(num_blocks_) * block_size_;
+    if (file_backed && !exists) {
+        LOG_INFO(Disk, "[Disk] Creating new disk image: " << filename_
+                           << " (" << image_size / 1024 << " KB)");
+        std::ofstream(filename_, std::ios::binary | std::ios::out);
+    }
+    if (file_backed && (!exists || file_size < image_size)) {
+        std::filesystem::resize_file(filename_, image_size, ec);
+        if (ec) {
+            LOG_ERROR(Disk, "[Disk] Error: Could not size disk image " << filename_ << ": "
+                                << ec.message());
         }
-        outfile.close();
     }
 
-    std::cerr << "[Disk] Opening disk image: " << filename_ << std::endl;
-    // 以读写模式打开
-    disk_file_.open(filename_, std::ios::binary | std::ios::in | std::ios::out);
-    if (!disk_file_.is_open()) {
-        std::cerr << "[Disk] Error: Could not open disk image " << filename_ << std::endl;
+    LOG_INFO(Disk, "[Disk] Opening disk image: " << filename_ << " (backend: "
+                       << disk_backend_name(backend_kind_) << ", " << num_blocks_ << " x "
+                       << block_size_ << " B, swap " << swap_blocks_ << " blocks)");
+    backend_ = make_disk_backend(backend_kind_);
+    write_back_ = backend_->wants_write_back();
+    if (!backend_->open(filename_, num_blocks_, block_size_)) {
+        throw std::runtime_error("Disk open error: could not open " + filename_ + " with the " +
+                                 disk_backend_name(backend_kind_) + " backend (" +
+                                 std::to_string(num_blocks_) + " x " +
+                                 std::to_string(block_size_) + " B)");
+    }
+}
+
+void DiskDevice::set_swap_blocks(size_t swap_blocks) {
+    if (swap_blocks >= num_blocks_) {
+        throw std::runtime_error("Disk geometry error: swap reservation of " +
+                                 std::to_string(swap_blocks) + " blocks does not fit in " +
+                                 std::to_string(num_blocks_) + " blocks");
+    }
+    swap_blocks_ = swap_blocks;
+}
+
+void DiskDevice::note_access(size_t first_block, size_t count, bool write) {
+    g_disk_metrics.runs.inc();
+    if (observer_) {
+        observer_(first_block, count, write);
     }
 }
 
@@ -40,10 +161,24 @@ bool DiskDevice::read_block(size_t block_id, uint8_t* out_buffer) {
         throw std::runtime_error("Read error: block_id " + std::to_string(block_id) + " out of range");
     }
 
-    disk_file_.seekg(block_id * block_size_, std::ios::beg);
-    disk_file_.read(reinterpret_cast<char*>(out_buffer), block_size_);
-    
-    return disk_file_.good();
+    metrics::ScopedTimer timer(g_disk_metrics.read_ns);
+    g_disk_metrics.reads.inc();
+    auto it = dirty_.find(block_id);
+    if (it != dirty_.end()) {
+        std::memcpy(out_buffer, it->second.data(), block_size_);
+        g_disk_metrics.buffered_hits.inc();
+        return true;
+    }
+    if (in_flight_ > 0) {
+        wait_block(block_id);
+    }
+    auto lock = lock_backend();
+    note_access(block_id, 1, false);
+    if (!backend_->read(block_id, out_buffer)) {
+        g_disk_metrics.errors.inc();
+        return false;
+    }
+    return true;
 }
 
 bool DiskDevice::write_block(size_t block_id, const uint8_t* in_buffer) {
@@ -51,9 +186,449 @@ bool DiskDevice::write_block(size_t block_id, const uint8_t* in_buffer) {
         throw std::runtime_error("Write error: block_id " + std::to_string(block_id) + " out of range");
     }
 
-    disk_file_.seekp(block_id * block_size_, std::ios::beg);
-    disk_file_.write(reinterpret_cast<const char*>(in_buffer), block_size_);
-    disk_file_.flush(); // 确保写入物理设备
-    
-    return disk_file_.good();
+    metrics::ScopedTimer timer(g_disk_metrics.write_ns);
+    g_disk_metrics.writes.inc();
+    if (!write_back_) {
+        if (in_flight_ > 0) {
+            wait_block(block_id);
+        }
+        g_disk_metrics.backend_writes.inc();
+        note_access(block_id, 1, true);
+        auto lock = lock_backend();
+        if (!backend_->write(block_id, in_buffer)) {
+            g_disk_metrics.errors.inc();
+            return false;
+        }
+        return true;
+    }
+
+    // 同一块的重复写入在缓冲中合并
+    auto& slot = dirty_[block_id];
+    slot.assign(in_buffer, in_buffer + block_size_);
+    g_disk_metrics.dirty.set(static_cast<int64_t>(dirty_.size()));
+    if (dirty_.size() > config::DISK_WRITEBACK_MAX_BLOCKS) {
+        // 容量触发的回写不等待完成，与后续的模拟工作重叠
+        return flush_dirty(false);
+    }
+    return true;
+}
+
+bool DiskDevice::read_blocks(const std::vector<BlockRead>& ios) {
+    if (ios.size() == 1) {
+        return read_block(ios[0].block_id, ios[0].data);
+    }
+    for (const auto& io : ios) {
+        if (io.block_id >= num_blocks_) {
+            throw std::runtime_error("Read error: block_id " + std::to_string(io.block_id) + " out of range");
+        }
+    }
+
+    metrics::ScopedTimer timer(g_disk_metrics.read_ns);
+    g_disk_metrics.reads.inc(ios.size());
+    std::vector<BlockRead> pending;
+    pending.reserve(ios.size());
+    for (const auto& io : ios) {
+        auto it = dirty_.find(io.block_id);
+        if (it != dirty_.end()) {
+            std::memcpy(io.data, it->second.data(), block_size_);
+            g_disk_metrics.buffered_hits.inc();
+            continue;
+        }
+        if (in_flight_ > 0) {
+            wait_block(io.block_id);
+        }
+        pending.push_back(io);
+    }
+
+    std::sort(pending.begin(), pending.end(),
+              [](const BlockRead& a, const BlockRead& b) { return a.block_id < b.block_id; });
+    bool ok = true;
+    std::vector<uint8_t*> buffers;
+    auto lock = lock_backend();
+    for (size_t begin = 0, end = 0; begin < pending.size(); begin = end) {
+        buffers.clear();
+        end = begin;
+        do {
+            buffers.push_back(pending[end].data);
+            ++end;
+        } while (end < pending.size() && pending[end].block_id == pending[end - 1].block_id + 1);
+        note_access(pending[begin].block_id, buffers.size(), false);
+        g_disk_metrics.run_blocks.observe(buffers.size());
+        if (!backend_->read_run(pending[begin].block_id, buffers.data(), buffers.size())) {
+            g_disk_metrics.errors.inc();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool DiskDevice::write_blocks(const std::vector<BlockWrite>& ios) {
+    if (ios.size() == 1) {
+        return write_block(ios[0].block_id, ios[0].data);
+    }
+    for (const auto& io : ios) {
+        if (io.block_id >= num_blocks_) {
+            throw std::runtime_error("Write error: block_id " + std::to_string(io.block_id) + " out of range");
+        }
+    }
+
+    metrics::ScopedTimer timer(g_disk_metrics.write_ns);
+    g_disk_metrics.writes.inc(ios.size());
+    if (write_back_) {
+        for (const auto& io : ios) {
+            dirty_[io.block_id].assign(io.data, io.data + block_size_);
+        }
+        g_disk_metrics.dirty.set(static_cast<int64_t>(dirty_.size()));
+        if (dirty_.size() > config::DISK_WRITEBACK_MAX_BLOCKS) {
+            return flush_dirty(false);
+        }
+        return true;
+    }
+
+    std::vector<BlockWrite> sorted(ios);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const BlockWrite& a, const BlockWrite& b) { return a.block_id < b.block_id; });
+    // 同一块出现多次时保留最后一次写入
+    std::vector<BlockWrite> pending;
+    pending.reserve(sorted.size());
+    for (const auto& io : sorted) {
+        if (!pending.empty() && pending.back().block_id == io.block_id) {
+            pending.back() = io;
+        } else {
+            pending.push_back(io);
+        }
+    }
+    if (in_flight_ > 0) {
+        for (const auto& io : pending) {
+            wait_block(io.block_id);
+        }
+    }
+
+    bool ok = true;
+    std::vector<const uint8_t*> buffers;
+    auto lock = lock_backend();
+    for (size_t begin = 0, end = 0; begin < pending.size(); begin = end) {
+        buffers.clear();
+        end = begin;
+        do {
+            buffers.push_back(pending[end].data);
+            ++end;
+        } while (end < pending.size() && pending[end].block_id == pending[end - 1].block_id + 1);
+        note_access(pending[begin].block_id, buffers.size(), true);
+        g_disk_metrics.run_blocks.observe(buffers.size());
+        g_disk_metrics.backend_writes.inc(buffers.size());
+        if (!backend_->write_run(pending[begin].block_id, buffers.data(), buffers.size())) {
+            g_disk_metrics.errors.inc();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool DiskDevice::read_blocks(size_t first_block, size_t count, uint8_t* out_buffer) {
+    std::vector<BlockRead> ios(count);
+    for (size_t i = 0; i < count; ++i) {
+        ios[i] = {first_block + i, out_buffer + i * block_size_};
+    }
+    return read_blocks(ios);
+}
+
+bool DiskDevice::write_blocks(size_t first_block, size_t count, const uint8_t* in_buffer) {
+    std::vector<BlockWrite> ios(count);
+    for (size_t i = 0; i < count; ++i) {
+        ios[i] = {first_block + i, in_buffer + i * block_size_};
+    }
+    return write_blocks(ios);
+}
+
+bool DiskDevice::flush_dirty(bool wait) {
+    bool ok = true;
+    // 缓冲为空时不必为此启动引擎，但仍需等待已有的异步写
+    if (dirty_.empty() ? engine_ != nullptr : ensure_engine()) {
+        // 块号相邻的脏块合并成一个请求（最多 DISK_IO_MAX_RUN_BLOCKS 块）
+        for (auto it = dirty_.begin(); it != dirty_.end();) {
+            auto run_end = std::next(it);
+            size_t count = 1;
+            while (run_end != dirty_.end() && run_end->first == it->first + count &&
+                   count < config::DISK_IO_MAX_RUN_BLOCKS) {
+                ++run_end;
+                ++count;
+            }
+            const size_t first = it->first;
+            std::unique_ptr<IoRequest> req(new_request(
+                true, first, count, block_size_, [this, first, count](bool done_ok) {
+                    if (!done_ok) {
+                        async_failed_ = true;
+                        LOG_ERROR(Disk, "[Disk] Write-back failed for blocks " << first << ".."
+                                            << first + count - 1);
+                    }
+                }));
+            for (size_t i = 0; it != run_end; ++it, ++i) {
+                std::memcpy(req->data.get() + i * block_size_, it->second.data(), block_size_);
+            }
+            g_disk_metrics.backend_writes.inc(count);
+            ok = submit_request(std::move(req)) && ok;
+        }
+        dirty_.clear();
+        g_disk_metrics.dirty.set(0);
+        engine_->kick();
+        if (wait) {
+            wait_io();
+            ok = ok && !async_failed_;
+            async_failed_ = false;
+        }
+        return ok;
+    }
+
+    // 同步回写：map 按块号有序，相邻脏块合并成一次 write_run
+    std::vector<const uint8_t*> buffers;
+    auto lock = lock_backend();
+    for (auto it = dirty_.begin(); it != dirty_.end();) {
+        const size_t first = it->first;
+        buffers.clear();
+        do {
+            buffers.push_back(it->second.data());
+            ++it;
+        } while (it != dirty_.end() && it->first == first + buffers.size());
+        g_disk_metrics.backend_writes.inc(buffers.size());
+        note_access(first, buffers.size(), true);
+        g_disk_metrics.run_blocks.observe(buffers.size());
+        if (!backend_->write_run(first, buffers.data(), buffers.size())) {
+            g_disk_metrics.errors.inc();
+            LOG_ERROR(Disk, "[Disk] Write-back failed for blocks " << first << ".."
+                                << first + buffers.size() - 1);
+            ok = false;
+        }
+    }
+    dirty_.clear();
+    g_disk_metrics.dirty.set(0);
+    return ok;
+}
+
+bool DiskDevice::barrier() {
+    g_disk_metrics.barriers.inc();
+    return flush_dirty(true);
+}
+
+bool DiskDevice::sync() {
+    metrics::ScopedTimer timer(g_disk_metrics.sync_ns);
+    g_disk_metrics.syncs.inc();
+    bool ok = flush_dirty(true);
+    {
+        auto lock = lock_backend();
+        ok = backend_->sync() && ok;
+    }
+    if (!ok) {
+        g_disk_metrics.errors.inc();
+        LOG_ERROR(Disk, "[Disk] sync failed for " << filename_);
+        return false;
+    }
+    return true;
+}
+
+// ---- 异步 I/O ----
+
+void DiskDevice::configure_async(AsyncEngineKind kind, size_t queue_depth) {
+    wait_io();
+    engine_.reset();
+    engine_kind_ = kind;
+    io_queue_depth_ = queue_depth > 0 ? queue_depth : 1;
+}
+
+const char* DiskDevice::async_engine() const {
+    if (engine_) {
+        return engine_->name();
+    }
+    const bool sync_only = engine_kind_ == AsyncEngineKind::Sync ||
+                           (engine_kind_ == AsyncEngineKind::Auto && backend_ &&
+                            !backend_->benefits_from_async());
+    return sync_only ? "sync" : "idle";
+}
+
+bool DiskDevice::ensure_engine() {
+    if (engine_) {
+        return true;
+    }
+    if (engine_kind_ == AsyncEngineKind::Sync || !backend_ ||
+        (engine_kind_ == AsyncEngineKind::Auto && !backend_->benefits_from_async())) {
+        return false;
+    }
+
+    if (engine_kind_ != AsyncEngineKind::Pool) {
+        engine_ = make_uring_engine(backend_->fd(), block_size_, io_queue_depth_);
+        if (!engine_ && engine_kind_ == AsyncEngineKind::Uring) {
+            LOG_WARN(Disk, "[Disk] io_uring unavailable for backend "
+                               << disk_backend_name(backend_kind_)
+                               << ", falling back to thread pool");
+        }
+    }
+    if (!engine_) {
+        engine_ = make_pool_engine(*backend_, block_size_, config::DISK_IO_WORKERS,
+                                   backend_->thread_safe() ? nullptr : &backend_mu_);
+    }
+    g_disk_metrics.queue_depth.set(static_cast<int64_t>(io_queue_depth_));
+    LOG_INFO(Disk, "[Disk] Async I/O engine: " << engine_->name()
+                       << " (queue depth " << io_queue_depth_ << ")");
+    return true;
+}
+
+std::unique_lock<std::mutex> DiskDevice::lock_backend() {
+    if (engine_ && !backend_->thread_safe()) {
+        return std::unique_lock<std::mutex>(backend_mu_);
+    }
+    return {};
+}
+
+bool DiskDevice::submit_read(size_t block_id, uint8_t* out_buffer, IoCallback done) {
+    if (block_id >= num_blocks_) {
+        throw std::runtime_error("Read error: block_id " + std::to_string(block_id) + " out of range");
+    }
+    g_disk_metrics.reads.inc();
+
+    // 写回缓冲中的块或无引擎时就地完成
+    auto it = dirty_.find(block_id);
+    if (it != dirty_.end() || !ensure_engine()) {
+        bool ok = true;
+        if (it != dirty_.end()) {
+            std::memcpy(out_buffer, it->second.data(), block_size_);
+            g_disk_metrics.buffered_hits.inc();
+        } else {
+            auto lock = lock_backend();
+            note_access(block_id, 1, false);
+            ok = backend_->read(block_id, out_buffer);
+        }
+        if (!ok) {
+            g_disk_metrics.errors.inc();
+        }
+        if (done) {
+            done(ok);
+        }
+        return ok;
+    }
+
+    std::unique_ptr<IoRequest> req(new_request(false, block_id, 1, block_size_, std::move(done)));
+    req->read_target = out_buffer;
+    return submit_request(std::move(req));
+}
+
+bool DiskDevice::submit_write(size_t block_id, const uint8_t* in_buffer, IoCallback done) {
+    if (block_id >= num_blocks_) {
+        throw std::runtime_error("Write error: block_id " + std::to_string(block_id) + " out of range");
+    }
+    g_disk_metrics.writes.inc();
+
+    // 缓冲中的旧数据若之后再回写会覆盖这次写入
+    if (dirty_.erase(block_id) > 0) {
+        g_disk_metrics.dirty.set(static_cast<int64_t>(dirty_.size()));
+    }
+
+    if (!ensure_engine()) {
+        bool ok;
+        {
+            auto lock = lock_backend();
+            note_access(block_id, 1, true);
+            ok = backend_->write(block_id, in_buffer);
+        }
+        if (!ok) {
+            g_disk_metrics.errors.inc();
+        }
+        if (done) {
+            done(ok);
+        }
+        return ok;
+    }
+
+    std::unique_ptr<IoRequest> req(new_request(true, block_id, 1, block_size_, std::move(done)));
+    std::memcpy(req->data.get(), in_buffer, block_size_);
+    return submit_request(std::move(req));
+}
+
+bool DiskDevice::submit_request(std::unique_ptr<IoRequest> req) {
+    // 同一块上的请求不能在引擎内乱序，先等前一个完成
+    for (size_t i = 0; i < req->count; ++i) {
+        wait_block(req->block_id + i);
+    }
+    while (in_flight_ >= io_queue_depth_) {
+        reap(true);
+    }
+
+    g_disk_metrics.inflight_at_submit.observe(in_flight_);
+    req->submitted = std::chrono::steady_clock::now();
+    const size_t block_id = req->block_id;
+    const size_t count = req->count;
+    const bool write = req->write;
+    if (!engine_->submit(req.get())) {
+        g_disk_metrics.errors.inc();
+        return false;
+    }
+    req.release();  // 所有权交给引擎，reap 时收回
+
+    ++in_flight_;
+    note_access(block_id, count, write);
+    g_disk_metrics.run_blocks.observe(count);
+    for (size_t i = 0; i < count; ++i) {
+        ++inflight_blocks_[block_id + i];
+    }
+    g_disk_metrics.async_submitted.inc();
+    g_disk_metrics.in_flight.set(static_cast<int64_t>(in_flight_));
+    return true;
+}
+
+size_t DiskDevice::reap(bool wait) {
+    if (!engine_ || in_flight_ == 0) {
+        return 0;
+    }
+
+    std::vector<IoRequest*> completed;
+    engine_->reap(wait, completed);
+    const auto now = std::chrono::steady_clock::now();
+    for (IoRequest* raw : completed) {
+        std::unique_ptr<IoRequest> req(raw);
+        --in_flight_;
+        for (size_t i = 0; i < req->count; ++i) {
+            auto it = inflight_blocks_.find(req->block_id + i);
+            if (it != inflight_blocks_.end() && --it->second == 0) {
+                inflight_blocks_.erase(it);
+            }
+        }
+
+        g_disk_metrics.async_completed.inc();
+        g_disk_metrics.async_ns.observe(
+            static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - req->submitted).count()));
+        if (!req->ok) {
+            g_disk_metrics.errors.inc();
+        } else if (!req->write && req->read_target) {
+            std::memcpy(req->read_target, req->data.get(), block_size_);
+        }
+        if (req->done) {
+            req->done(req->ok);
+        }
+    }
+    g_disk_metrics.in_flight.set(static_cast<int64_t>(in_flight_));
+    return completed.size();
+}
+
+size_t DiskDevice::poll_completions() {
+    return reap(false);
+}
+
+void DiskDevice::power_loss() {
+    wait_io();
+    LOG_WARN(Disk, "[Disk] Power loss: dropping " << dirty_.size() << " unflushed blocks");
+    dirty_.clear();
+    auto lock = lock_backend();
+    backend_->sync();
+}
+
+void DiskDevice::wait_io() {
+    while (in_flight_ > 0) {
+        reap(true);
+    }
+}
+
+void DiskDevice::wait_block(size_t block_id) {
+    while (inflight_blocks_.count(block_id) > 0) {
+        reap(true);
+    }
 }
@@ -0,0 +1,48 @@
+#include "dev/disk_backend.h"
+
+bool parse_disk_backend(const std::string& s, DiskBackendKind& out) {
+    if (s == "stream") {
+        out = DiskBackendKind::Stream;
+    } else if (s == "mmap") {
+        out = DiskBackendKind::Mmap;
+    } else if (s == "pread") {
+        out = DiskBackendKind::Pread;
+    } else if (s == "direct") {
+        out = DiskBackendKind::Direct;
+    } else if (s == "ram") {
+        out = DiskBackendKind::Ram;
+    } else if (s == "ram-persist") {
+        out = DiskBackendKind::RamPersist;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* disk_backend_name(DiskBackendKind kind) {
+    switch (kind) {
+        case DiskBackendKind::Stream: return "stream";
+        case DiskBackendKind::Mmap: return "mmap";
+        case DiskBackendKind::Pread: return "pread";
+        case DiskBackendKind::Direct: return "direct";
+        case DiskBackendKind::Ram: return "ram";
+        case DiskBackendKind::RamPersist: return "ram-persist";
+    }
+    return "?";
+}
+
+bool disk_backend_uses_image_file(DiskBackendKind kind) {
+    return kind != DiskBackendKind::Ram && kind != DiskBackendKind::RamPersist;
+}
+
+std::unique_ptr<DiskBackend> make_disk_backend(DiskBackendKind kind) {
+    switch (kind) {
+        case DiskBackendKind::Stream: return make_stream_backend();
+        case DiskBackendKind::Mmap: return make_mmap_backend();
+        case DiskBackendKind::Pread: return make_pread_backend(false);
+        case DiskBackendKind::Direct: return make_pread_backend(true);
+        case DiskBackendKind::Ram: return make_ram_backend(false);
+        case DiskBackendKind::RamPersist: return make_ram_backend(true);
+    }
+    return nullptr;
+}
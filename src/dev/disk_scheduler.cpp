@@ -0,0 +1,343 @@
+#include "dev/disk_scheduler.h"
+#include "common/log.h"
+#include "common/metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+struct DiskSchedMetrics {
+    metrics::Counter& requests = metrics::registry().counter(
+        "disk_sched_requests_total", "Requests served by the simulated disk scheduler");
+    metrics::Counter& head_movement = metrics::registry().counter(
+        "disk_sched_head_movement_tracks_total", "Tracks crossed by the simulated disk head");
+    metrics::Histogram& latency = metrics::registry().histogram(
+        "disk_sched_latency_ticks", "Simulated request latency from arrival to completion in ticks");
+    metrics::Gauge& queued = metrics::registry().gauge(
+        "disk_sched_queue_length", "Requests waiting for or in simulated disk service");
+};
+DiskSchedMetrics g_sched_metrics;
+
+size_t distance(size_t a, size_t b) {
+    return a > b ? a - b : b - a;
+}
+}
+
+bool parse_disk_sched_policy(const std::string& s, DiskSchedPolicy& out) {
+    if (s == "fcfs") {
+        out = DiskSchedPolicy::Fcfs;
+    } else if (s == "sstf") {
+        out = DiskSchedPolicy::Sstf;
+    } else if (s == "scan") {
+        out = DiskSchedPolicy::Scan;
+    } else if (s == "clook" || s == "c-look") {
+        out = DiskSchedPolicy::CLook;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* disk_sched_policy_name(DiskSchedPolicy policy) {
+    switch (policy) {
+        case DiskSchedPolicy::Fcfs: return "fcfs";
+        case DiskSchedPolicy::Sstf: return "sstf";
+        case DiskSchedPolicy::Scan: return "scan";
+        case DiskSchedPolicy::CLook: return "clook";
+    }
+    return "?";
+}
+
+bool parse_disk_timing(const std::string& s, DiskTiming& out) {
+    DiskTiming timing = out;
+    std::istringstream iss(s);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        const auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        const std::string key = item.substr(0, eq);
+        double value = 0;
+        try {
+            value = std::stod(item.substr(eq + 1));
+        } catch (...) {
+            return false;
+        }
+        if (!(value >= 0)) {
+            return false;
+        }
+        if (key == "settle") {
+            timing.seek_settle = value;
+        } else if (key == "track") {
+            timing.seek_per_track = value;
+        } else if (key == "rotation") {
+            timing.rotation = value;
+        } else if (key == "transfer") {
+            timing.transfer_per_block = value;
+        } else if (key == "bpt") {
+            if (value < 1) {
+                return false;
+            }
+            timing.blocks_per_track = static_cast<size_t>(value);
+        } else {
+            return false;
+        }
+    }
+    out = timing;
+    return true;
+}
+
+double DiskSchedStats::throughput() const {
+    const double t = elapsed();
+    return t > 0 ? static_cast<double>(requests) / t : 0;
+}
+
+double DiskSchedStats::mean_latency() const {
+    if (latencies.empty()) {
+        return 0;
+    }
+    double sum = 0;
+    for (double l : latencies) {
+        sum += l;
+    }
+    return sum / static_cast<double>(latencies.size());
+}
+
+double DiskSchedStats::percentile(double p) const {
+    if (latencies.empty()) {
+        return 0;
+    }
+    std::vector<double> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    // 最近秩法：第 ceil(p% * n) 个
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+DiskScheduler::DiskScheduler(DiskSchedPolicy policy, DiskTiming timing, size_t num_blocks)
+    : policy_(policy),
+      timing_(timing),
+      num_blocks_(num_blocks),
+      num_tracks_((num_blocks + timing.blocks_per_track - 1) / timing.blocks_per_track) {}
+
+uint64_t DiskScheduler::submit(int pid, size_t block, size_t count, bool write, double now) {
+    DiskRequest req;
+    req.id = next_id_++;
+    req.pid = pid;
+    req.block = block;
+    req.count = count;
+    req.write = write;
+    req.arrival = now;
+
+    if (arrivals_.empty()) {
+        stats_.first_arrival = now;
+    }
+    arrivals_.push_back(req);
+    queue_.push_back(req);
+    if (!busy_) {
+        start_next(std::max(now, idle_since_));
+    }
+    if (!replaying_) {
+        g_sched_metrics.queued.set(static_cast<int64_t>(queued()));
+        LOG_DEBUG(Disk, "[DiskSched] Queued " << (write ? "write" : "read") << " blocks "
+                            << block << ".." << block + count - 1 << " for pid=" << pid
+                            << " at t=" << now << ", qlen=" << queued());
+    }
+    return req.id;
+}
+
+void DiskScheduler::advance(double now, std::vector<DiskRequest>& completed) {
+    while (busy_ && current_.finish <= now) {
+        const double finished_at = current_.finish;
+        completed.push_back(current_);
+        complete_current();
+        if (!queue_.empty()) {
+            start_next(finished_at);
+        }
+    }
+    if (!replaying_) {
+        g_sched_metrics.queued.set(static_cast<int64_t>(queued()));
+    }
+}
+
+size_t DiskScheduler::pick_next(double at, uint64_t& travel) {
+    // 只在 at 时刻已到达的请求中挑选；队列按到达顺序排列，同条件下取先到者
+    size_t best = SIZE_MAX;
+    auto consider = [&](size_t i, auto better) {
+        if (queue_[i].arrival > at) {
+            return;
+        }
+        if (best == SIZE_MAX || better(queue_[i], queue_[best])) {
+            best = i;
+        }
+    };
+    // 沿扫描方向最近：向上取磁道号最小者，向下取最大者
+    auto along = [this](bool up) {
+        return [this, up](const DiskRequest& a, const DiskRequest& b) {
+            return up ? track_of(a.block) < track_of(b.block)
+                      : track_of(a.block) > track_of(b.block);
+        };
+    };
+
+    switch (policy_) {
+        case DiskSchedPolicy::Fcfs:
+            for (size_t i = 0; i < queue_.size() && best == SIZE_MAX; ++i) {
+                consider(i, [](const DiskRequest&, const DiskRequest&) { return false; });
+            }
+            travel = distance(head_track_, track_of(queue_[best].block));
+            break;
+        case DiskSchedPolicy::Sstf:
+            for (size_t i = 0; i < queue_.size(); ++i) {
+                consider(i, [&](const DiskRequest& a, const DiskRequest& b) {
+                    return distance(head_track_, track_of(a.block)) <
+                           distance(head_track_, track_of(b.block));
+                });
+            }
+            travel = distance(head_track_, track_of(queue_[best].block));
+            break;
+        case DiskSchedPolicy::Scan: {
+            for (size_t i = 0; i < queue_.size(); ++i) {
+                const size_t t = track_of(queue_[i].block);
+                if (sweep_up_ ? t >= head_track_ : t <= head_track_) {
+                    consider(i, along(sweep_up_));
+                }
+            }
+            if (best != SIZE_MAX) {
+                travel = distance(head_track_, track_of(queue_[best].block));
+                break;
+            }
+            // 当前方向上没有请求：磁头先走到磁盘边缘，再折返
+            const size_t edge = sweep_up_ ? num_tracks_ - 1 : 0;
+            sweep_up_ = !sweep_up_;
+            for (size_t i = 0; i < queue_.size(); ++i) {
+                consider(i, along(sweep_up_));
+            }
+            travel = distance(head_track_, edge) + distance(edge, track_of(queue_[best].block));
+            break;
+        }
+        case DiskSchedPolicy::CLook:
+            for (size_t i = 0; i < queue_.size(); ++i) {
+                if (track_of(queue_[i].block) >= head_track_) {
+                    consider(i, along(true));
+                }
+            }
+            if (best == SIZE_MAX) {
+                // 跳回最低磁道上的请求，回程同样计入磁头移动
+                for (size_t i = 0; i < queue_.size(); ++i) {
+                    consider(i, along(true));
+                }
+            }
+            travel = distance(head_track_, track_of(queue_[best].block));
+            break;
+    }
+    return best;
+}
+
+void DiskScheduler::start_next(double at) {
+    // 磁盘空闲到下一个请求到达为止
+    double earliest = queue_.front().arrival;
+    for (const auto& req : queue_) {
+        earliest = std::min(earliest, req.arrival);
+    }
+    at = std::max(at, earliest);
+
+    uint64_t travel = 0;
+    const size_t index = pick_next(at, travel);
+    current_ = queue_[index];
+    queue_.erase(queue_.begin() + static_cast<std::ptrdiff_t>(index));
+
+    double service = timing_.transfer_per_block * static_cast<double>(current_.count);
+    if (current_.block != next_block_) {
+        if (travel > 0) {
+            service += timing_.seek_settle + timing_.seek_per_track * static_cast<double>(travel);
+        }
+        service += timing_.rotation;
+    }
+    current_.start = at;
+    current_.finish = at + service;
+    busy_ = true;
+
+    head_track_ = track_of(current_.block + current_.count - 1);
+    next_block_ = current_.block + current_.count;
+    stats_.head_movement += travel;
+    if (!replaying_) {
+        g_sched_metrics.head_movement.inc(travel);
+    }
+}
+
+void DiskScheduler::complete_current() {
+    busy_ = false;
+    idle_since_ = current_.finish;
+
+    const double latency = current_.finish - current_.arrival;
+    ++stats_.requests;
+    stats_.blocks += current_.count;
+    stats_.busy += current_.finish - current_.start;
+    stats_.last_finish = current_.finish;
+    stats_.latencies.push_back(latency);
+    if (!replaying_) {
+        g_sched_metrics.requests.inc();
+        g_sched_metrics.latency.observe(static_cast<uint64_t>(std::ceil(latency)));
+    }
+}
+
+void DiskScheduler::reset_stats() {
+    stats_ = DiskSchedStats{};
+    arrivals_.clear();
+}
+
+DiskSchedStats DiskScheduler::replay(DiskSchedPolicy policy) const {
+    DiskScheduler sim(policy, timing_, num_blocks_);
+    sim.replaying_ = true;
+    std::vector<DiskRequest> completed;
+    for (const auto& req : arrivals_) {
+        sim.advance(req.arrival, completed);
+        sim.submit(req.pid, req.block, req.count, req.write, req.arrival);
+    }
+    sim.advance(INFINITY, completed);
+    return sim.stats_;
+}
+
+void DiskScheduler::dump(std::ostream& os) const {
+    const auto old_flags = os.flags();
+    const auto old_precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+    os << "=== Disk Scheduler ===\n"
+       << "policy: " << disk_sched_policy_name(policy_) << " (settle=" << timing_.seek_settle
+       << " track=" << timing_.seek_per_track << " rotation=" << timing_.rotation
+       << " transfer=" << timing_.transfer_per_block << " bpt=" << timing_.blocks_per_track
+       << ", " << num_tracks_ << " tracks)\n"
+       << "queued: " << queued() << "  head track: " << head_track_ << "\n"
+       << "requests: " << stats_.requests << "  blocks: " << stats_.blocks
+       << "  elapsed: " << stats_.elapsed() << " ticks  busy: " << stats_.busy << " ticks\n"
+       << "throughput: " << stats_.throughput() << " req/tick\n"
+       << "latency (ticks): mean=" << stats_.mean_latency() << " p50=" << stats_.percentile(50)
+       << " p95=" << stats_.percentile(95) << " p99=" << stats_.percentile(99)
+       << " max=" << stats_.percentile(100) << "\n"
+       << "head movement: " << stats_.head_movement << " tracks\n";
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
+
+void DiskScheduler::dump_comparison(std::ostream& os) const {
+    const auto old_flags = os.flags();
+    const auto old_precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+    os << "=== Disk Scheduler Comparison (replay of " << arrivals_.size() << " requests) ===\n"
+       << std::left << std::setw(8) << "policy" << std::right << std::setw(10) << "req/tick"
+       << std::setw(9) << "mean" << std::setw(9) << "p50" << std::setw(9) << "p95"
+       << std::setw(9) << "p99" << std::setw(12) << "head-moves" << "\n";
+    for (auto policy : {DiskSchedPolicy::Fcfs, DiskSchedPolicy::Sstf, DiskSchedPolicy::Scan,
+                        DiskSchedPolicy::CLook}) {
+        const DiskSchedStats s = replay(policy);
+        os << std::left << std::setw(8) << disk_sched_policy_name(policy) << std::right
+           << std::setw(10) << s.throughput() << std::setw(9) << s.mean_latency()
+           << std::setw(9) << s.percentile(50) << std::setw(9) << s.percentile(95)
+           << std::setw(9) << s.percentile(99) << std::setw(12) << s.head_movement << "\n";
+    }
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
@@ -0,0 +1,84 @@
+#include "dev/disk_backend.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// 将整个镜像映射为 MAP_SHARED：读写都是 memcpy，脏页由内核回写，sync() 时 msync 强制落盘
+class MmapBackend : public DiskBackend {
+public:
+    ~MmapBackend() override {
+        if (base_) {
+            msync(base_, size_, MS_SYNC);
+            munmap(base_, size_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    bool open(const std::string& filename, size_t num_blocks, size_t block_size) override {
+        block_size_ = block_size;
+        size_ = num_blocks * block_size;
+
+        fd_ = ::open(filename.c_str(), O_RDWR);
+        if (fd_ < 0) {
+            return false;
+        }
+
+        // 映射超出文件末尾的部分会触发 SIGBUS，先保证文件足够大
+        struct stat st {};
+        if (fstat(fd_, &st) != 0) {
+            return false;
+        }
+        if (static_cast<size_t>(st.st_size) < size_ &&
+            ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+            return false;
+        }
+
+        void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        base_ = static_cast<uint8_t*>(p);
+        return true;
+    }
+
+    bool read(size_t block_id, uint8_t* out_buffer) override {
+        if (!base_) {
+            return false;
+        }
+        std::memcpy(out_buffer, base_ + block_id * block_size_, block_size_);
+        return true;
+    }
+
+    bool write(size_t block_id, const uint8_t* in_buffer) override {
+        if (!base_) {
+            return false;
+        }
+        std::memcpy(base_ + block_id * block_size_, in_buffer, block_size_);
+        return true;
+    }
+
+    bool sync() override {
+        return base_ && msync(base_, size_, MS_SYNC) == 0;
+    }
+
+    bool wants_write_back() const override { return false; }
+    bool thread_safe() const override { return true; }
+
+private:
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    size_t block_size_ = 0;
+};
+
+}  // namespace
+
+std::unique_ptr<DiskBackend> make_mmap_backend() {
+    return std::make_unique<MmapBackend>();
+}
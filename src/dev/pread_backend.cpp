@@ -0,0 +1,211 @@
+#include "dev/disk_backend.h"
+#include "common/log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// O_DIRECT 要求缓冲区地址、偏移与长度都按逻辑块对齐；4 KB 覆盖常见设备
+constexpr size_t kDirectAlignment = 4096;
+
+// 基于裸文件描述符的后端：pread/pwrite 按 block_id * block_size 定位，
+// 不共享文件偏移，可被多个线程同时调用。direct 模式以 O_DIRECT 打开以绕过页缓存。
+class PreadBackend : public DiskBackend {
+public:
+    explicit PreadBackend(bool direct) : direct_(direct) {}
+
+    ~PreadBackend() override {
+        if (fd_ >= 0) {
+            fdatasync(fd_);
+            close(fd_);
+        }
+    }
+
+    bool open(const std::string& filename, size_t /*num_blocks*/, size_t block_size) override {
+        block_size_ = block_size;
+        if (direct_) {
+            if (block_size_ % kDirectAlignment != 0) {
+                LOG_WARN(Disk, "[Disk] Block size " << block_size_
+                                   << " is not O_DIRECT aligned, using buffered I/O");
+                direct_ = false;
+            } else {
+                fd_ = ::open(filename.c_str(), O_RDWR | O_DIRECT);
+                if (fd_ < 0) {
+                    // 部分文件系统（如 tmpfs）不支持 O_DIRECT
+                    LOG_WARN(Disk, "[Disk] O_DIRECT unavailable for " << filename << " ("
+                                       << std::strerror(errno) << "), using buffered I/O");
+                    direct_ = false;
+                }
+            }
+        }
+        if (fd_ < 0) {
+            fd_ = ::open(filename.c_str(), O_RDWR);
+        }
+        return fd_ >= 0;
+    }
+
+    bool read(size_t block_id, uint8_t* out_buffer) override {
+        const off_t offset = static_cast<off_t>(block_id * block_size_);
+        if (!needs_bounce(out_buffer)) {
+            return full_pread(out_buffer, offset);
+        }
+        uint8_t* bounce = bounce_buffer();
+        if (!bounce || !full_pread(bounce, offset)) {
+            return false;
+        }
+        std::memcpy(out_buffer, bounce, block_size_);
+        return true;
+    }
+
+    bool write(size_t block_id, const uint8_t* in_buffer) override {
+        const off_t offset = static_cast<off_t>(block_id * block_size_);
+        if (!needs_bounce(in_buffer)) {
+            return full_pwrite(in_buffer, offset);
+        }
+        uint8_t* bounce = bounce_buffer();
+        if (!bounce) {
+            return false;
+        }
+        std::memcpy(bounce, in_buffer, block_size_);
+        return full_pwrite(bounce, offset);
+    }
+
+    // 一段连续块合并成一次 preadv/pwritev（超过 IOV_MAX 时分批）；
+    // O_DIRECT 下有未对齐的缓冲时退回逐块中转
+    bool read_run(size_t first_block, uint8_t* const* buffers, size_t count) override {
+        if (any_needs_bounce(buffers, count)) {
+            return DiskBackend::read_run(first_block, buffers, count);
+        }
+        return full_iov(false, const_cast<const uint8_t* const*>(buffers), count, first_block);
+    }
+
+    bool write_run(size_t first_block, const uint8_t* const* buffers, size_t count) override {
+        if (any_needs_bounce(buffers, count)) {
+            return DiskBackend::write_run(first_block, buffers, count);
+        }
+        return full_iov(true, buffers, count, first_block);
+    }
+
+    bool sync() override {
+        return fd_ >= 0 && fdatasync(fd_) == 0;
+    }
+
+    int fd() const override { return fd_; }
+    bool thread_safe() const override { return true; }
+
+private:
+    int fd_ = -1;
+    bool direct_;
+    size_t block_size_ = 0;
+
+    bool needs_bounce(const void* p) const {
+        return direct_ && reinterpret_cast<uintptr_t>(p) % kDirectAlignment != 0;
+    }
+
+    template <typename T>
+    bool any_needs_bounce(T* const* buffers, size_t count) const {
+        for (size_t i = 0; i < count; ++i) {
+            if (needs_bounce(buffers[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 每个线程一块对齐的中转缓冲，供未对齐的调用方缓冲区使用
+    uint8_t* bounce_buffer() const {
+        struct Bounce {
+            uint8_t* data = nullptr;
+            size_t size = 0;
+            ~Bounce() { std::free(data); }
+        };
+        thread_local Bounce bounce;
+        if (bounce.size < block_size_) {
+            std::free(bounce.data);
+            bounce.data = static_cast<uint8_t*>(std::aligned_alloc(kDirectAlignment, block_size_));
+            bounce.size = bounce.data ? block_size_ : 0;
+        }
+        return bounce.data;
+    }
+
+    bool full_pread(uint8_t* buf, off_t offset) const {
+        size_t done = 0;
+        while (done < block_size_) {
+            const ssize_t n = ::pread(fd_, buf + done, block_size_ - done, offset + done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool full_iov(bool write, const uint8_t* const* buffers, size_t count, size_t first_block) const {
+        std::vector<iovec> iov;
+        for (size_t base = 0; base < count; base += IOV_MAX) {
+            const size_t n = std::min<size_t>(count - base, IOV_MAX);
+            iov.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                iov[i].iov_base = const_cast<uint8_t*>(buffers[base + i]);
+                iov[i].iov_len = block_size_;
+            }
+            off_t offset = static_cast<off_t>((first_block + base) * block_size_);
+            iovec* cur = iov.data();
+            int left = static_cast<int>(n);
+            while (left > 0) {
+                const ssize_t r = write ? ::pwritev(fd_, cur, left, offset)
+                                        : ::preadv(fd_, cur, left, offset);
+                if (r < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (r <= 0) {
+                    return false;
+                }
+                // 短读写：跳过已完成的 iovec，调整剩余的第一项
+                offset += r;
+                size_t done = static_cast<size_t>(r);
+                while (left > 0 && done >= cur->iov_len) {
+                    done -= cur->iov_len;
+                    ++cur;
+                    --left;
+                }
+                if (left > 0) {
+                    cur->iov_base = static_cast<uint8_t*>(cur->iov_base) + done;
+                    cur->iov_len -= done;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool full_pwrite(const uint8_t* buf, off_t offset) const {
+        size_t done = 0;
+        while (done < block_size_) {
+            const ssize_t n = ::pwrite(fd_, buf + done, block_size_ - done, offset + done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<DiskBackend> make_pread_backend(bool direct) {
+    return std::make_unique<PreadBackend>(direct);
+}
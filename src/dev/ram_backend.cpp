@@ -0,0 +1,161 @@
+#include "dev/disk_backend.h"
+#include "common/log.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// 纯内存块设备：整个盘是一块预分配、按页对齐的匿名内存。
+// persist 模式下启动时把已有镜像读入内存，sync()（含退出）时只把写过的块写回镜像。
+class RamBackend : public DiskBackend {
+public:
+    explicit RamBackend(bool persist) : persist_(persist) {}
+
+    ~RamBackend() override {
+        if (base_) {
+            munmap(base_, size_);
+        }
+    }
+
+    bool open(const std::string& filename, size_t num_blocks, size_t block_size) override {
+        filename_ = filename;
+        block_size_ = block_size;
+        size_ = num_blocks * block_size;
+
+        // 2 MB 整数倍时先尝试显式大页（需要预留 hugetlb 页），失败则退回普通页并建议透明大页
+        void* p = MAP_FAILED;
+        if (size_ % kHugePageSize == 0) {
+            p = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+        if (p == MAP_FAILED) {
+            p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                LOG_ERROR(Disk, "[Disk] Cannot allocate " << size_ / 1024 << " KB RAM disk: "
+                                    << std::strerror(errno));
+                return false;
+            }
+            madvise(p, size_, MADV_HUGEPAGE);
+        } else {
+            LOG_INFO(Disk, "[Disk] RAM disk backed by hugetlb pages");
+        }
+        base_ = static_cast<uint8_t*>(p);
+        dirty_.assign(num_blocks, 0);
+
+        return !persist_ || load();
+    }
+
+    bool read(size_t block_id, uint8_t* out_buffer) override {
+        if (!base_) {
+            return false;
+        }
+        std::memcpy(out_buffer, base_ + block_id * block_size_, block_size_);
+        return true;
+    }
+
+    bool write(size_t block_id, const uint8_t* in_buffer) override {
+        if (!base_) {
+            return false;
+        }
+        std::memcpy(base_ + block_id * block_size_, in_buffer, block_size_);
+        dirty_[block_id] = 1;
+        return true;
+    }
+
+    bool sync() override {
+        return !persist_ || (base_ && save());
+    }
+
+    bool wants_write_back() const override { return false; }
+    bool thread_safe() const override { return true; }
+    bool benefits_from_async() const override { return false; }
+
+private:
+    bool persist_;
+    std::string filename_;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    size_t block_size_ = 0;
+    // 自上次保存以来写过的块。线程池引擎会从多个工作线程并发 write()，每块独占一个字节，
+    // 不能用按位打包的 vector<bool>（相邻块共用一个字，并发置位会丢失）
+    std::vector<uint8_t> dirty_;
+
+    // 镜像不存在时视为全零盘；比内存盘短的部分保持为零
+    bool load() {
+        const int fd = ::open(filename_.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return errno == ENOENT;
+        }
+        size_t done = 0;
+        while (done < size_) {
+            const ssize_t n = ::pread(fd, base_ + done, size_ - done, static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                close(fd);
+                return false;
+            }
+            if (n == 0) {
+                break;
+            }
+            done += static_cast<size_t>(n);
+        }
+        close(fd);
+        LOG_INFO(Disk, "[Disk] Loaded " << done / 1024 << " KB from " << filename_ << " into RAM disk");
+        return true;
+    }
+
+    bool save() {
+        const int fd = ::open(filename_.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) {
+            LOG_ERROR(Disk, "[Disk] Cannot save RAM disk to " << filename_ << ": "
+                                << std::strerror(errno));
+            return false;
+        }
+        // 镜像按内存盘大小截断（新文件为稀疏文件），之后只写回脏块
+        struct stat st {};
+        bool ok = fstat(fd, &st) == 0 &&
+                  (static_cast<size_t>(st.st_size) == size_ ||
+                   ftruncate(fd, static_cast<off_t>(size_)) == 0);
+        size_t saved = 0;
+        for (size_t b = 0; ok && b < dirty_.size(); ++b) {
+            if (!dirty_[b]) {
+                continue;
+            }
+            const off_t offset = static_cast<off_t>(b * block_size_);
+            size_t done = 0;
+            while (ok && done < block_size_) {
+                const ssize_t n = ::pwrite(fd, base_ + offset + done, block_size_ - done,
+                                           offset + static_cast<off_t>(done));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                ok = n > 0;
+                done += n > 0 ? static_cast<size_t>(n) : 0;
+            }
+            if (ok) {
+                dirty_[b] = 0;
+                ++saved;
+            }
+        }
+        ok = close(fd) == 0 && ok;
+        if (saved > 0) {
+            LOG_INFO(Disk, "[Disk] Saved " << saved << " blocks from RAM disk to " << filename_);
+        }
+        return ok;
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<DiskBackend> make_ram_backend(bool persist) {
+    return std::make_unique<RamBackend>(persist);
+}
@@ -0,0 +1,58 @@
+#include "dev/disk_backend.h"
+#include <fstream>
+
+namespace {
+
+// 原有实现：seek + read/write；写回缓冲由 DiskDevice 负责，这里不再逐块 flush
+class StreamBackend : public DiskBackend {
+public:
+    bool open(const std::string& filename, size_t /*num_blocks*/, size_t block_size) override {
+        block_size_ = block_size;
+        file_.open(filename, std::ios::binary | std::ios::in | std::ios::out);
+        return file_.is_open();
+    }
+
+    bool read(size_t block_id, uint8_t* out_buffer) override {
+        file_.seekg(block_id * block_size_, std::ios::beg);
+        file_.read(reinterpret_cast<char*>(out_buffer), block_size_);
+        return file_.good();
+    }
+
+    bool write(size_t block_id, const uint8_t* in_buffer) override {
+        file_.seekp(block_id * block_size_, std::ios::beg);
+        file_.write(reinterpret_cast<const char*>(in_buffer), block_size_);
+        return file_.good();
+    }
+
+    // 连续块只需定位一次，之后顺序读写由 fstream 的缓冲合并
+    bool read_run(size_t first_block, uint8_t* const* buffers, size_t count) override {
+        file_.seekg(first_block * block_size_, std::ios::beg);
+        for (size_t i = 0; i < count && file_.good(); ++i) {
+            file_.read(reinterpret_cast<char*>(buffers[i]), block_size_);
+        }
+        return file_.good();
+    }
+
+    bool write_run(size_t first_block, const uint8_t* const* buffers, size_t count) override {
+        file_.seekp(first_block * block_size_, std::ios::beg);
+        for (size_t i = 0; i < count && file_.good(); ++i) {
+            file_.write(reinterpret_cast<const char*>(buffers[i]), block_size_);
+        }
+        return file_.good();
+    }
+
+    bool sync() override {
+        file_.flush();
+        return file_.good();
+    }
+
+private:
+    std::fstream file_;
+    size_t block_size_ = 0;
+};
+
+}  // namespace
+
+std::unique_ptr<DiskBackend> make_stream_backend() {
+    return std::make_unique<StreamBackend>();
+}
@@ -1,112 +1,348 @@
 #include "fs/block_manager.h"
-#include <iostream>
+#include "common/log.h"
+#include "common/metrics.h"
+#include <algorithm>
+#include <bit>
 
-BlockManager::BlockManager(DiskDevice* disk) 
-    : disk_(disk), bitmap_dirty_(false) {
-    inode_bitmap_.resize(BLOCK_SIZE);
-    data_bitmap_.resize(BLOCK_SIZE);
+// 位图按 64 位字保存在内存中；位 i 在字 i / 64 的第 i % 64 位。小端主机上
+// 与磁盘上的字节布局（位 i 在字节 i / 8 的第 i % 8 位）一致，可直接整块读写
+static_assert(std::endian::native == std::endian::little, "bitmap words assume a little-endian host");
+
+namespace {
+struct BlockMetrics {
+    metrics::Counter& inode_allocs = metrics::registry().counter(
+        "fs_inode_allocs_total", "Inodes allocated from the inode bitmap");
+    metrics::Counter& inode_frees = metrics::registry().counter(
+        "fs_inode_frees_total", "Inodes returned to the inode bitmap");
+    metrics::Counter& block_allocs = metrics::registry().counter(
+        "fs_block_allocs_total", "Data blocks allocated from the data bitmap");
+    metrics::Counter& block_frees = metrics::registry().counter(
+        "fs_block_frees_total", "Data blocks returned to the data bitmap");
+    metrics::Counter& extent_allocs = metrics::registry().counter(
+        "fs_extent_allocs_total", "Contiguous block runs handed out by the extent allocator");
+    metrics::Counter& alloc_failures = metrics::registry().counter(
+        "fs_alloc_failures_total", "Inode or block allocations that found no free bit");
+    metrics::Counter& bitmap_saves = metrics::registry().counter(
+        "fs_bitmap_saves_total", "Bitmap write-backs to disk");
+    metrics::Counter& words_scanned = metrics::registry().counter(
+        "fs_bitmap_words_scanned_total", "64-bit bitmap words examined by allocation searches");
+};
+BlockMetrics g_block_metrics;
+
+constexpr uint32_t WORD_BITS = 64;
+
+// 从 bit 起第一个取值为 value 的位，[bit, limit) 内没有时返回 limit。
+// 整字跳过全满（或全空）的字，字内用 countr_zero 定位
+uint32_t find_next(const std::vector<uint64_t>& bitmap, uint32_t bit, uint32_t limit, bool value) {
+    uint64_t scanned = 0;
+    uint32_t found = limit;
+    while (bit < limit) {
+        ++scanned;
+        const uint32_t base = bit - bit % WORD_BITS;
+        uint64_t word = value ? bitmap[bit / WORD_BITS] : ~bitmap[bit / WORD_BITS];
+        word &= ~0ULL << (bit % WORD_BITS);
+        if (word != 0) {
+            found = std::min(limit, base + static_cast<uint32_t>(std::countr_zero(word)));
+            break;
+        }
+        bit = base + WORD_BITS;
+    }
+    g_block_metrics.words_scanned.inc(scanned);
+    return found;
+}
 }
 
+BlockManager::BlockManager(BufferCache* cache, const SuperBlock* sb)
+    : cache_(cache), sb_(sb), bitmap_dirty_(false) {}
+
+// 块组的数目与位置随超级块中的布局变化，每次加载时按其重新建立
 bool BlockManager::load_bitmaps() {
-    if (!disk_->read_block(INODE_BITMAP_BLOCK, inode_bitmap_.data())) {
-        return false;
-    }
-    if (!disk_->read_block(DATA_BITMAP_BLOCK, data_bitmap_.data())) {
-        return false;
+    groups_.assign(sb_->groups(), Group{});
+    free_inodes_ = 0;
+    free_blocks_ = 0;
+    for (uint32_t g = 0; g < groups_.size(); ++g) {
+        Group& group = groups_[g];
+        group.layout = sb_->group(g);
+        group.inode_bitmap.assign(BLOCK_SIZE / sizeof(uint64_t), 0);
+        group.data_bitmap.assign(
+            static_cast<size_t>(group.layout.data_bitmap_blocks) * BLOCK_SIZE / sizeof(uint64_t), 0);
+        if (!cache_->read(group.layout.inode_bitmap,
+                          reinterpret_cast<uint8_t*>(group.inode_bitmap.data()))) {
+            return false;
+        }
+        if (!cache_->read_range(group.layout.data_bitmap, group.layout.data_bitmap_blocks,
+                                reinterpret_cast<uint8_t*>(group.data_bitmap.data()))) {
+            return false;
+        }
+        group.free_inodes =
+            group.layout.inodes - count_set_bits(group.inode_bitmap, group.layout.inodes);
+        group.free_blocks =
+            group.layout.data_blocks - count_set_bits(group.data_bitmap, group.layout.data_blocks);
+        free_inodes_ += group.free_inodes;
+        free_blocks_ += group.free_blocks;
     }
     return true;
 }
 
 bool BlockManager::save_bitmaps() {
-    if (!disk_->write_block(INODE_BITMAP_BLOCK, inode_bitmap_.data())) {
-        return false;
-    }
-    if (!disk_->write_block(DATA_BITMAP_BLOCK, data_bitmap_.data())) {
-        return false;
+    g_block_metrics.bitmap_saves.inc();
+    for (Group& group : groups_) {
+        if (!group.dirty) {
+            continue;
+        }
+        if (!cache_->write(group.layout.inode_bitmap,
+                           reinterpret_cast<const uint8_t*>(group.inode_bitmap.data()), true)) {
+            return false;
+        }
+        if (!cache_->write_range(group.layout.data_bitmap, group.layout.data_bitmap_blocks,
+                                 reinterpret_cast<const uint8_t*>(group.data_bitmap.data()), true)) {
+            return false;
+        }
+        group.dirty = false;
     }
     bitmap_dirty_ = false;
     return true;
 }
 
-uint32_t BlockManager::alloc_inode() {
-    uint32_t inode_num = find_free_bit(inode_bitmap_, MAX_INODES);
-    if (inode_num == INVALID_INODE) {
-        std::cerr << "[FS] No free inodes available" << std::endl;
-        return INVALID_INODE;
+void BlockManager::set_bitmap_dirty(bool dirty) {
+    bitmap_dirty_ = dirty;
+    for (Group& group : groups_) {
+        group.dirty = dirty;
     }
-    
-    set_bit(inode_bitmap_, inode_num);
-    bitmap_dirty_ = true;
-    return inode_num;
+}
+
+// 有空闲 inode 的组中空闲块最多的一组；相同时取父目录所在组
+uint32_t BlockManager::directory_group(uint32_t parent) const {
+    const uint32_t n = static_cast<uint32_t>(groups_.size());
+    const uint32_t first = parent != INVALID_INODE ? sb_->group_of_inode(parent) : 0;
+    uint32_t best = first;
+    for (uint32_t k = 0; k < n; ++k) {
+        const uint32_t g = (first + k) % n;
+        if (groups_[g].free_inodes != 0 &&
+            (groups_[best].free_inodes == 0 || groups_[g].free_blocks > groups_[best].free_blocks)) {
+            best = g;
+        }
+    }
+    return best;
+}
+
+uint32_t BlockManager::alloc_inode(uint32_t parent, bool directory) {
+    const uint32_t n = static_cast<uint32_t>(groups_.size());
+    uint32_t first = 0;
+    if (directory) {
+        first = directory_group(parent);
+    } else if (parent != INVALID_INODE) {
+        first = sb_->group_of_inode(parent);
+    }
+    for (uint32_t k = 0; k < n; ++k) {
+        Group& group = groups_[(first + k) % n];
+        if (group.free_inodes == 0) {
+            continue;
+        }
+        const uint32_t bit = find_free_bit(group.inode_bitmap, group.layout.inodes, group.inode_hint);
+        if (bit == INVALID_INODE) {
+            continue;
+        }
+        set_bit(group.inode_bitmap, bit);
+        group.inode_hint = bit + 1;
+        group.free_inodes--;
+        group.dirty = true;
+        bitmap_dirty_ = true;
+        free_inodes_--;
+        g_block_metrics.inode_allocs.inc();
+        return group.layout.first_inode + bit;
+    }
+    g_block_metrics.alloc_failures.inc();
+    LOG_WARN(FS, "[FS] No free inodes available");
+    return INVALID_INODE;
 }
 
 void BlockManager::free_inode(uint32_t inode_num) {
-    clear_bit(inode_bitmap_, inode_num);
+    Group& group = groups_[sb_->group_of_inode(inode_num)];
+    const uint32_t bit = inode_num - group.layout.first_inode;
+    if (bit >= group.layout.inodes || !is_bit_set(group.inode_bitmap, bit)) {
+        return;
+    }
+    clear_bit(group.inode_bitmap, bit);
+    group.free_inodes++;
+    group.dirty = true;
     bitmap_dirty_ = true;
+    free_inodes_++;
+    g_block_metrics.inode_frees.inc();
 }
 
-uint32_t BlockManager::alloc_block() {
-    uint32_t block_num = find_free_bit(data_bitmap_, MAX_DATA_BLOCKS);
-    if (block_num == INVALID_BLOCK) {
-        std::cerr << "[FS] No free blocks available" << std::endl;
-        return INVALID_BLOCK;
+uint32_t BlockManager::alloc_block(uint32_t goal) {
+    return allocate(goal, 1).start;
+}
+
+Extent BlockManager::alloc_extent(uint32_t goal, uint32_t count) {
+    if (count == 0) {
+        return {INVALID_BLOCK, 0};
+    }
+    const Extent extent = allocate(goal, count);
+    if (extent.length != 0) {
+        g_block_metrics.extent_allocs.inc();
+    }
+    return extent;
+}
+
+// 先从 goal（通常是文件末块之后）接着分配，新块与文件已有的 extent 相连；
+// 否则从 goal 所在组起逐组查找：组内从轮转提示处起找第一段足够长的空闲段，
+// 各组都没有时取其中最长的一段
+Extent BlockManager::allocate(uint32_t goal, uint32_t count) {
+    const uint32_t n = static_cast<uint32_t>(groups_.size());
+    const uint32_t first = goal != INVALID_BLOCK ? sb_->group_of_block(goal) : 0;
+    {
+        Group& group = groups_[first];
+        const uint32_t data_blocks = group.layout.data_blocks;
+        if (goal >= group.layout.data_start && goal - group.layout.data_start < data_blocks) {
+            const uint32_t bit = goal - group.layout.data_start;
+            const uint32_t limit = bit + std::min(count, data_blocks - bit);
+            const uint32_t len = find_next(group.data_bitmap, bit, limit, true) - bit;
+            if (len != 0) {
+                return take(group, bit, len);
+            }
+        }
+    }
+
+    Group* best = nullptr;
+    uint32_t best_start = INVALID_BLOCK;
+    uint32_t best_len = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+        Group& group = groups_[(first + k) % n];
+        if (group.free_blocks <= best_len) {
+            continue;
+        }
+        uint32_t len = 0;
+        const uint32_t start = find_free_run(group.data_bitmap, group.layout.data_blocks,
+                                             group.data_hint, count, len);
+        if (len == count) {
+            return take(group, start, len);
+        }
+        if (len > best_len) {
+            best = &group;
+            best_start = start;
+            best_len = len;
+        }
     }
-    
-    set_bit(data_bitmap_, block_num);
+    if (!best) {
+        g_block_metrics.alloc_failures.inc();
+        LOG_WARN(FS, "[FS] No free blocks available");
+        return {INVALID_BLOCK, 0};
+    }
+    return take(*best, best_start, best_len);
+}
+
+Extent BlockManager::take(Group& group, uint32_t bit, uint32_t len) {
+    for (uint32_t i = 0; i < len; ++i) {
+        set_bit(group.data_bitmap, bit + i);
+    }
+    group.data_hint = bit + len;
+    group.free_blocks -= len;
+    group.dirty = true;
     bitmap_dirty_ = true;
-    
-    uint32_t actual_block = DATA_BLOCKS_START + block_num;
-    return actual_block;
+    free_blocks_ -= len;
+    g_block_metrics.block_allocs.inc(len);
+    return {group.layout.data_start + bit, len};
+}
+
+void BlockManager::free_extent(const Extent& extent) {
+    for (uint32_t i = 0; i < extent.length; ++i) {
+        free_block(extent.start + i);
+    }
 }
 
 void BlockManager::free_block(uint32_t block_num) {
-    uint32_t bitmap_index = block_num - DATA_BLOCKS_START;
-    clear_bit(data_bitmap_, bitmap_index);
+    Group& group = groups_[sb_->group_of_block(block_num)];
+    const uint32_t bit = block_num - group.layout.data_start;
+    if (block_num < group.layout.data_start || bit >= group.layout.data_blocks ||
+        !is_bit_set(group.data_bitmap, bit)) {
+        return;
+    }
+    clear_bit(group.data_bitmap, bit);
+    group.free_blocks++;
+    group.dirty = true;
     bitmap_dirty_ = true;
+    free_blocks_++;
+    g_block_metrics.block_frees.inc();
 }
 
-uint32_t BlockManager::free_inodes() const {
-    return MAX_INODES - count_set_bits(inode_bitmap_, MAX_INODES);
+uint32_t BlockManager::group_goal(uint32_t inode_num) const {
+    return groups_[sb_->group_of_inode(inode_num)].layout.data_start;
 }
 
-uint32_t BlockManager::free_blocks() const {
-    return MAX_DATA_BLOCKS - count_set_bits(data_bitmap_, MAX_DATA_BLOCKS);
+void BlockManager::dump(std::ostream& os) const {
+    for (uint32_t g = 0; g < groups_.size(); ++g) {
+        const Group& group = groups_[g];
+        os << "Group " << g << ": blocks " << group.layout.inode_bitmap << "-"
+           << group.layout.data_start + group.layout.data_blocks - 1 << ", inodes "
+           << group.layout.first_inode << "-" << group.layout.first_inode + group.layout.inodes - 1
+           << ", free blocks " << group.free_blocks << "/" << group.layout.data_blocks
+           << ", free inodes " << group.free_inodes << "/" << group.layout.inodes << "\n";
+    }
 }
 
-bool BlockManager::is_bit_set(const std::vector<uint8_t>& bitmap, uint32_t bit_index) const {
-    uint32_t byte_index = bit_index / 8;
-    uint32_t bit_offset = bit_index % 8;
-    return (bitmap[byte_index] & (1 << bit_offset)) != 0;
+bool BlockManager::is_bit_set(const std::vector<uint64_t>& bitmap, uint32_t bit_index) const {
+    return (bitmap[bit_index / WORD_BITS] >> (bit_index % WORD_BITS) & 1) != 0;
 }
 
-void BlockManager::set_bit(std::vector<uint8_t>& bitmap, uint32_t bit_index) {
-    uint32_t byte_index = bit_index / 8;
-    uint32_t bit_offset = bit_index % 8;
-    bitmap[byte_index] |= (1 << bit_offset);
+void BlockManager::set_bit(std::vector<uint64_t>& bitmap, uint32_t bit_index) {
+    bitmap[bit_index / WORD_BITS] |= 1ULL << (bit_index % WORD_BITS);
 }
 
-void BlockManager::clear_bit(std::vector<uint8_t>& bitmap, uint32_t bit_index) {
-    uint32_t byte_index = bit_index / 8;
-    uint32_t bit_offset = bit_index % 8;
-    bitmap[byte_index] &= ~(1 << bit_offset);
+void BlockManager::clear_bit(std::vector<uint64_t>& bitmap, uint32_t bit_index) {
+    bitmap[bit_index / WORD_BITS] &= ~(1ULL << (bit_index % WORD_BITS));
 }
 
-uint32_t BlockManager::find_free_bit(const std::vector<uint8_t>& bitmap, uint32_t max_bits) {
-    for (uint32_t i = 0; i < max_bits; i++) {
-        if (!is_bit_set(bitmap, i)) {
-            return i;
+// 循环首次适配：从 hint 找到末尾，再从头找到 hint
+uint32_t BlockManager::find_free_bit(const std::vector<uint64_t>& bitmap, uint32_t max_bits,
+                                     uint32_t hint) {
+    hint = hint < max_bits ? hint : 0;
+    uint32_t bit = find_next(bitmap, hint, max_bits, false);
+    if (bit == max_bits) {
+        bit = find_next(bitmap, 0, hint, false);
+        if (bit == hint) {
+            return INVALID_INODE;
         }
     }
-    return INVALID_INODE;
+    return bit;
 }
 
-uint32_t BlockManager::count_set_bits(const std::vector<uint8_t>& bitmap,
+// 从 hint 起循环查找第一段长度不小于 count 的连续空闲位（len 为 count）；
+// 没有这样的段时返回最长的一段（len < count），全满返回 INVALID_BLOCK。
+// 空闲段的起止都按字查找，跳过的整字不逐位检查
+uint32_t BlockManager::find_free_run(const std::vector<uint64_t>& bitmap, uint32_t max_bits,
+                                     uint32_t hint, uint32_t count, uint32_t& len) {
+    hint = hint < max_bits ? hint : 0;
+    uint32_t best_start = INVALID_BLOCK;
+    len = 0;
+    const uint32_t ranges[2][2] = {{hint, max_bits}, {0, hint}};
+    for (const auto& [from, to] : ranges) {
+        for (uint32_t bit = find_next(bitmap, from, to, false); bit < to;) {
+            const uint32_t end = find_next(bitmap, bit, to, true);
+            if (end - bit >= count) {
+                len = count;
+                return bit;
+            }
+            if (end - bit > len) {
+                best_start = bit;
+                len = end - bit;
+            }
+            bit = find_next(bitmap, end, to, false);
+        }
+    }
+    return best_start;
+}
+
+uint32_t BlockManager::count_set_bits(const std::vector<uint64_t>& bitmap,
                                       uint32_t max_bits) const {
     uint32_t count = 0;
-    for (uint32_t i = 0; i < max_bits; ++i) {
-        if (is_bit_set(bitmap, i)) {
-            ++count;
-        }
+    for (uint32_t w = 0; w < max_bits / WORD_BITS; ++w) {
+        count += static_cast<uint32_t>(std::popcount(bitmap[w]));
+    }
+    if (max_bits % WORD_BITS != 0) {
+        const uint64_t mask = (1ULL << (max_bits % WORD_BITS)) - 1;
+        count += static_cast<uint32_t>(std::popcount(bitmap[max_bits / WORD_BITS] & mask));
     }
     return count;
 }
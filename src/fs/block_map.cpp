@@ -0,0 +1,392 @@
+#include "fs/block_map.h"
+#include "common/log.h"
+#include "common/metrics.h"
+#include <algorithm>
+
+namespace {
+struct BlockMapMetrics {
+    metrics::Counter& block_reads = metrics::registry().counter(
+        "fs_bmap_block_reads_total", "Indirect or extent blocks fetched by block-map lookups");
+    metrics::Counter& block_allocs = metrics::registry().counter(
+        "fs_bmap_block_allocs_total", "Indirect or extent blocks allocated as files grow");
+    metrics::Counter& extents_merged = metrics::registry().counter(
+        "fs_bmap_extents_merged_total", "Appends that extended the file's last extent");
+    metrics::Counter& extents_added = metrics::registry().counter(
+        "fs_bmap_extents_added_total", "Appends that started a new extent");
+};
+BlockMapMetrics g_bmap_metrics;
+
+// extent 块：inode 内放不下的 extent 依次存放，块间以 next 链接
+constexpr uint32_t EXTENTS_PER_BLOCK = (BLOCK_SIZE - 8) / sizeof(Extent);
+
+struct ExtentBlock {
+    uint32_t count;  // 本块中的 extent 数
+    uint32_t next;   // 下一个 extent 块
+    Extent extents[EXTENTS_PER_BLOCK];
+};
+static_assert(sizeof(ExtentBlock) <= BLOCK_SIZE, "ExtentBlock must fit in a block");
+
+const uint32_t* ptrs(const BufferCache::Handle& block) {
+    return reinterpret_cast<const uint32_t*>(block.data());
+}
+
+uint32_t* mutable_ptrs(BufferCache::Handle& block) {
+    return reinterpret_cast<uint32_t*>(block.mutable_metadata());
+}
+
+const ExtentBlock* extent_block(const BufferCache::Handle& block) {
+    return reinterpret_cast<const ExtentBlock*>(block.data());
+}
+
+ExtentBlock* mutable_extent_block(BufferCache::Handle& block) {
+    return reinterpret_cast<ExtentBlock*>(block.mutable_metadata());
+}
+
+// 共 blocks 块的块指针格式文件需要的间接块数
+uint32_t indirect_blocks_for(uint32_t blocks) {
+    if (blocks <= DIRECT_BLOCKS) {
+        return 0;
+    }
+    if (blocks <= DIRECT_BLOCKS + PTRS_PER_BLOCK) {
+        return 1;
+    }
+    // 一级间接块 + 二级间接块 + 其下的各一级间接块
+    const uint32_t rest = blocks - DIRECT_BLOCKS - PTRS_PER_BLOCK;
+    return 2 + (rest + PTRS_PER_BLOCK - 1) / PTRS_PER_BLOCK;
+}
+
+// 共 extents 段时需要的 extent 块数
+uint32_t extent_blocks_for(uint64_t extents) {
+    if (extents <= INLINE_EXTENTS) {
+        return 0;
+    }
+    return static_cast<uint32_t>((extents - INLINE_EXTENTS + EXTENTS_PER_BLOCK - 1) /
+                                 EXTENTS_PER_BLOCK);
+}
+}
+
+BlockMap::BlockMap(BufferCache* cache, BlockManager* block_mgr)
+    : cache_(cache), block_mgr_(block_mgr) {}
+
+uint32_t BlockMap::metadata_blocks_for(const Inode& inode, uint32_t blocks) {
+    if (inode.uses_extents()) {
+        return extent_blocks_for(static_cast<uint64_t>(inode.extent_count) + blocks) -
+               extent_blocks_for(inode.extent_count);
+    }
+    return indirect_blocks_for(inode.blocks_used + blocks) - indirect_blocks_for(inode.blocks_used);
+}
+
+// 所需总块数随追加块数单调不减，二分查找
+uint32_t BlockMap::blocks_within(const Inode& inode, uint64_t budget, uint32_t max_blocks) {
+    uint32_t lo = 0;
+    uint32_t hi = static_cast<uint32_t>(std::min<uint64_t>(max_blocks, budget));
+    while (lo < hi) {
+        const uint32_t mid = hi - (hi - lo) / 2;
+        if (static_cast<uint64_t>(mid) + metadata_blocks_for(inode, mid) <= budget) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+BufferCache::Handle BlockMap::fetch(uint32_t block) {
+    g_bmap_metrics.block_reads.inc();
+    BufferCache::Handle handle = cache_->get(block);
+    if (!handle) {
+        LOG_ERROR(FS, "[FS] Unable to read block-map block " << block);
+    }
+    return handle;
+}
+
+// 新的映射块不读盘，在缓存中清零；与 goal（它所映射的数据块）分在同一组
+BufferCache::Handle BlockMap::new_map_block(uint32_t goal) {
+    const uint32_t block = block_mgr_->alloc_block(goal);
+    if (block == INVALID_BLOCK) {
+        return {};
+    }
+    BufferCache::Handle handle = cache_->get_zeroed(block);
+    if (!handle) {
+        block_mgr_->free_block(block);
+        return {};
+    }
+    handle.mutable_metadata();
+    g_bmap_metrics.block_allocs.inc();
+    return handle;
+}
+
+bool BlockMap::map(const Inode& inode, uint32_t first, uint32_t count, std::vector<uint32_t>& out) {
+    if (!inode.uses_extents()) {
+        return map_pointers(inode, first, count, out);
+    }
+    out.reserve(out.size() + count);
+    const uint64_t end = static_cast<uint64_t>(first) + count;
+    uint64_t logical = 0;  // 当前 extent 的第一个文件块索引
+    const bool ok = for_each_extent(inode, [&](const Extent& ext) {
+        const uint64_t lo = std::max<uint64_t>(first, logical);
+        const uint64_t hi = std::min<uint64_t>(end, logical + ext.length);
+        for (uint64_t idx = lo; idx < hi; ++idx) {
+            out.push_back(ext.start + static_cast<uint32_t>(idx - logical));
+        }
+        logical += ext.length;
+        return logical < end;
+    });
+    return ok && logical >= end;
+}
+
+uint32_t BlockMap::append(Inode& inode, uint32_t start, uint32_t count) {
+    count = std::min(count, MAX_FILE_BLOCKS - inode.blocks_used);
+    const uint32_t appended =
+        inode.uses_extents() ? append_extent(inode, start, count) : append_pointers(inode, start, count);
+    if (appended < count) {
+        LOG_WARN(FS, "[FS] Block map full or out of space for map blocks");
+    }
+    return appended;
+}
+
+void BlockMap::release(const Inode& inode) {
+    if (!inode.uses_extents()) {
+        release_pointers(inode);
+        return;
+    }
+    for_each_extent(inode, [this](const Extent& ext) {
+        block_mgr_->free_extent(ext);
+        return true;
+    });
+    uint32_t block = inode.extent_block;
+    for (uint32_t i = extent_blocks_for(inode.extent_count); i > 0; --i) {
+        const BufferCache::Handle handle = fetch(block);
+        block_mgr_->free_block(block);
+        if (!handle) {
+            break;
+        }
+        block = extent_block(handle)->next;
+    }
+}
+
+uint32_t BlockMap::goal(const Inode& inode) {
+    if (inode.blocks_used == 0) {
+        return INVALID_BLOCK;
+    }
+    if (inode.uses_extents()) {
+        if (inode.extent_count <= INLINE_EXTENTS) {
+            const Extent& last = inode.extents[inode.extent_count - 1];
+            return last.start + last.length;
+        }
+        const BufferCache::Handle block = last_extent_block(inode);
+        if (!block) {
+            return INVALID_BLOCK;
+        }
+        const ExtentBlock* eb = extent_block(block);
+        return eb->extents[eb->count - 1].start + eb->extents[eb->count - 1].length;
+    }
+    std::vector<uint32_t> last;
+    return map_pointers(inode, inode.blocks_used - 1, 1, last) ? last[0] + 1 : INVALID_BLOCK;
+}
+
+// 依次访问文件的各 extent，fn 返回 false 时停止；extent 块读失败返回 false
+bool BlockMap::for_each_extent(const Inode& inode, const std::function<bool(const Extent&)>& fn) {
+    const uint32_t inline_count = std::min(inode.extent_count, INLINE_EXTENTS);
+    for (uint32_t i = 0; i < inline_count; ++i) {
+        if (!fn(inode.extents[i])) {
+            return true;
+        }
+    }
+    uint32_t remaining = inode.extent_count - inline_count;
+    uint32_t block = inode.extent_block;
+    while (remaining != 0) {
+        const BufferCache::Handle handle = fetch(block);
+        if (!handle) {
+            return false;
+        }
+        const ExtentBlock* eb = extent_block(handle);
+        const uint32_t n = std::min(eb->count, remaining);
+        if (n == 0) {
+            LOG_ERROR(FS, "[FS] Extent block " << block << " is empty");
+            return false;
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            if (!fn(eb->extents[i])) {
+                return true;
+            }
+        }
+        remaining -= n;
+        block = eb->next;
+    }
+    return true;
+}
+
+// 链表中的最后一个 extent 块；要求 extent_count > INLINE_EXTENTS
+BufferCache::Handle BlockMap::last_extent_block(const Inode& inode) {
+    BufferCache::Handle handle = fetch(inode.extent_block);
+    for (uint32_t i = extent_blocks_for(inode.extent_count); handle && i > 1; --i) {
+        handle = fetch(extent_block(handle)->next);
+    }
+    return handle;
+}
+
+// 新段紧接末段时延长末段，否则在 inode 或 extent 块链表末尾加一段
+uint32_t BlockMap::append_extent(Inode& inode, uint32_t start, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    BufferCache::Handle tail;
+    if (inode.extent_count > INLINE_EXTENTS && !(tail = last_extent_block(inode))) {
+        return 0;
+    }
+
+    const Extent* last = nullptr;
+    if (tail) {
+        const ExtentBlock* eb = extent_block(tail);
+        last = &eb->extents[eb->count - 1];
+    } else if (inode.extent_count != 0) {
+        last = &inode.extents[inode.extent_count - 1];
+    }
+    if (last && last->start + last->length == start) {
+        if (tail) {
+            ExtentBlock* eb = mutable_extent_block(tail);
+            eb->extents[eb->count - 1].length += count;
+        } else {
+            inode.extents[inode.extent_count - 1].length += count;
+        }
+        inode.blocks_used += count;
+        g_bmap_metrics.extents_merged.inc();
+        return count;
+    }
+
+    if (inode.extent_count < INLINE_EXTENTS) {
+        inode.extents[inode.extent_count] = {start, count};
+    } else if ((inode.extent_count - INLINE_EXTENTS) % EXTENTS_PER_BLOCK == 0) {
+        // 当前链尾已满（或还没有 extent 块）：新块接到链尾
+        BufferCache::Handle block = new_map_block(start);
+        if (!block) {
+            return 0;
+        }
+        ExtentBlock* eb = mutable_extent_block(block);
+        eb->next = INVALID_BLOCK;
+        eb->count = 1;
+        eb->extents[0] = {start, count};
+        if (tail) {
+            mutable_extent_block(tail)->next = block.block();
+        } else {
+            inode.extent_block = block.block();
+        }
+    } else {
+        ExtentBlock* eb = mutable_extent_block(tail);
+        eb->extents[eb->count++] = {start, count};
+    }
+    ++inode.extent_count;
+    inode.blocks_used += count;
+    g_bmap_metrics.extents_added.inc();
+    return count;
+}
+
+// 顺序映射时当前的二级间接块与一级间接块保持钉住，跨入下一个间接块才重新取
+bool BlockMap::map_pointers(const Inode& inode, uint32_t first, uint32_t count,
+                            std::vector<uint32_t>& out) {
+    out.reserve(out.size() + count);
+    BufferCache::Handle dind;
+    BufferCache::Handle leaf;
+    for (uint32_t idx = first; idx < first + count; ++idx) {
+        if (idx < DIRECT_BLOCKS) {
+            out.push_back(inode.direct_blocks[idx]);
+            continue;
+        }
+        uint32_t leaf_block;
+        uint32_t slot;
+        if (idx < DIRECT_BLOCKS + PTRS_PER_BLOCK) {
+            leaf_block = inode.indirect_block;
+            slot = idx - DIRECT_BLOCKS;
+        } else {
+            const uint32_t rel = idx - DIRECT_BLOCKS - PTRS_PER_BLOCK;
+            if (!dind && !(dind = fetch(inode.double_indirect_block))) {
+                return false;
+            }
+            leaf_block = ptrs(dind)[rel / PTRS_PER_BLOCK];
+            slot = rel % PTRS_PER_BLOCK;
+        }
+        if (!leaf || leaf.block() != leaf_block) {
+            if (!(leaf = fetch(leaf_block))) {
+                return false;
+            }
+        }
+        out.push_back(ptrs(leaf)[slot]);
+    }
+    return true;
+}
+
+// 追加总是从 blocks_used 开始：每个间接块在写入其第一个指针时分配
+uint32_t BlockMap::append_pointers(Inode& inode, uint32_t start, uint32_t count) {
+    BufferCache::Handle dind;
+    BufferCache::Handle leaf;
+    uint32_t n = 0;
+    for (; n < count; ++n) {
+        const uint32_t idx = inode.blocks_used;
+        if (idx < DIRECT_BLOCKS) {
+            inode.direct_blocks[idx] = start + n;
+            ++inode.blocks_used;
+            continue;
+        }
+        uint32_t slot;
+        if (idx < DIRECT_BLOCKS + PTRS_PER_BLOCK) {
+            slot = idx - DIRECT_BLOCKS;
+            if (slot == 0) {
+                if (!(leaf = new_map_block(start))) {
+                    break;
+                }
+                inode.indirect_block = leaf.block();
+            } else if (!leaf && !(leaf = fetch(inode.indirect_block))) {
+                break;
+            }
+        } else {
+            const uint32_t rel = idx - DIRECT_BLOCKS - PTRS_PER_BLOCK;
+            slot = rel % PTRS_PER_BLOCK;
+            if (rel == 0) {
+                if (!(dind = new_map_block(start))) {
+                    break;
+                }
+                inode.double_indirect_block = dind.block();
+            } else if (!dind && !(dind = fetch(inode.double_indirect_block))) {
+                break;
+            }
+            if (slot == 0) {
+                if (!(leaf = new_map_block(start))) {
+                    if (rel == 0) {
+                        block_mgr_->free_block(dind.block());
+                    }
+                    break;
+                }
+                mutable_ptrs(dind)[rel / PTRS_PER_BLOCK] = leaf.block();
+            } else if (!leaf && !(leaf = fetch(ptrs(dind)[rel / PTRS_PER_BLOCK]))) {
+                break;
+            }
+        }
+        mutable_ptrs(leaf)[slot] = start + n;
+        ++inode.blocks_used;
+    }
+    return n;
+}
+
+void BlockMap::release_pointers(const Inode& inode) {
+    std::vector<uint32_t> blocks;
+    if (!map_pointers(inode, 0, inode.blocks_used, blocks)) {
+        LOG_ERROR(FS, "[FS] Block map unreadable, " << inode.blocks_used - blocks.size()
+                          << " blocks leaked");
+    }
+    for (uint32_t block : blocks) {
+        block_mgr_->free_block(block);
+    }
+    if (inode.blocks_used > DIRECT_BLOCKS) {
+        block_mgr_->free_block(inode.indirect_block);
+    }
+    if (inode.blocks_used > DIRECT_BLOCKS + PTRS_PER_BLOCK) {
+        const uint32_t leaves = indirect_blocks_for(inode.blocks_used) - 2;
+        if (BufferCache::Handle dind = fetch(inode.double_indirect_block)) {
+            for (uint32_t i = 0; i < leaves; ++i) {
+                block_mgr_->free_block(ptrs(dind)[i]);
+            }
+        }
+        block_mgr_->free_block(inode.double_indirect_block);
+    }
+}
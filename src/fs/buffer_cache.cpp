@@ -0,0 +1,465 @@
+#include "fs/buffer_cache.h"
+#include "common/log.h"
+#include "common/metrics.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace {
+struct CacheMetrics {
+    metrics::Counter& hits = metrics::registry().counter(
+        "fs_bcache_hits_total", "Block lookups served from the buffer cache");
+    metrics::Counter& misses = metrics::registry().counter(
+        "fs_bcache_misses_total", "Block lookups that had to read the disk");
+    metrics::Counter& writes = metrics::registry().counter(
+        "fs_bcache_writes_total", "Block updates absorbed by the buffer cache");
+    metrics::Counter& evictions = metrics::registry().counter(
+        "fs_bcache_evictions_total", "Buffers evicted to make room");
+    metrics::Counter& writebacks = metrics::registry().counter(
+        "fs_bcache_writebacks_total", "Dirty buffers written to the disk device");
+    metrics::Counter& readahead = metrics::registry().counter(
+        "fs_readahead_blocks_total", "Blocks read into the buffer cache by read-ahead");
+    metrics::Counter& readahead_hits = metrics::registry().counter(
+        "fs_readahead_hits_total", "Read-ahead blocks that were later accessed");
+    metrics::Counter& readahead_wasted = metrics::registry().counter(
+        "fs_readahead_wasted_total", "Read-ahead blocks evicted without being accessed");
+    metrics::Gauge& cached = metrics::registry().gauge(
+        "fs_bcache_blocks", "Blocks currently held in the buffer cache");
+    metrics::Gauge& dirty = metrics::registry().gauge(
+        "fs_bcache_dirty_blocks", "Dirty blocks currently held in the buffer cache");
+};
+CacheMetrics g_cache_metrics;
+}
+
+BufferCache::Handle& BufferCache::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        release();
+        cache_ = other.cache_;
+        buf_ = other.buf_;
+        other.buf_ = nullptr;
+    }
+    return *this;
+}
+
+void BufferCache::Handle::release() {
+    if (buf_) {
+        cache_->unpin(buf_);
+        buf_ = nullptr;
+    }
+}
+
+BufferCache::BufferCache(DiskDevice* disk, size_t capacity)
+    : disk_(disk), capacity_(std::max<size_t>(capacity, 1)) {
+    index_.reserve(capacity_);
+}
+
+BufferCache::~BufferCache() {
+    disk_->wait_io();
+    flush();
+}
+
+BufferCache::Buffer* BufferCache::lookup(uint32_t block) {
+    auto it = index_.find(block);
+    // 异步预读中的块先等它完成（读失败时完成回调会丢弃该块）
+    while (it != index_.end() && it->second->io_pending) {
+        disk_->wait_io();
+        it = index_.find(block);
+    }
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &*it->second;
+}
+
+BufferCache::Buffer* BufferCache::insert(uint32_t block) {
+    while (index_.size() >= capacity_ && evict_one()) {
+    }
+    lru_.emplace_front();
+    Buffer& buf = lru_.front();
+    buf.block = block;
+    if (!spare_.empty()) {
+        buf.data = std::move(spare_.back());
+        spare_.pop_back();
+    } else {
+        buf.data = std::make_unique<uint8_t[]>(BLOCK_SIZE);
+    }
+    index_[block] = lru_.begin();
+    g_cache_metrics.cached.set(static_cast<int64_t>(index_.size()));
+    return &buf;
+}
+
+void BufferCache::discard(Buffer* buf) {
+    auto it = index_.find(buf->block);
+    if (it == index_.end()) {
+        return;
+    }
+    auto node = it->second;
+    index_.erase(it);
+    spare_.push_back(std::move(node->data));
+    lru_.erase(node);
+    g_cache_metrics.cached.set(static_cast<int64_t>(index_.size()));
+}
+
+// 从表尾找最久未用且未被钉住的缓冲；全部被钉住时返回 false，缓存暂时超出容量
+bool BufferCache::evict_one() {
+    disk_->poll_completions();  // 回收已完成的预读，让它们可以被淘汰
+    for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+        Buffer& buf = *it;
+        if (buf.pins > 0) {
+            continue;
+        }
+        // 尚未写入日志的元数据、以及覆盖日志中有效块的数据，要等下一次 flush
+        if (buf.dirty && journaling() &&
+            (buf.metadata ? !buf.logged : journal_->contains(buf.block))) {
+            continue;
+        }
+        if (buf.dirty && !write_back(buf)) {
+            continue;
+        }
+        ++stats_.evictions;
+        g_cache_metrics.evictions.inc();
+        if (buf.readahead) {
+            ++stats_.readahead_wasted;
+            g_cache_metrics.readahead_wasted.inc();
+        }
+        discard(&buf);
+        return true;
+    }
+    return false;
+}
+
+bool BufferCache::write_back(Buffer& buf) {
+    if (!disk_->write_block(buf.block, buf.data.get())) {
+        LOG_ERROR(FS, "[FS] Buffer cache write-back failed for block " << buf.block);
+        return false;
+    }
+    mark_clean(buf);
+    ++stats_.writebacks;
+    g_cache_metrics.writebacks.inc();
+    return true;
+}
+
+void BufferCache::unpin(Buffer* buf) {
+    --buf->pins;
+}
+
+void BufferCache::mark_dirty(Buffer& buf, bool metadata) {
+    buf.metadata = metadata;
+    buf.logged = false;
+    if (!buf.dirty) {
+        buf.dirty = true;
+        ++dirty_count_;
+        g_cache_metrics.dirty.set(static_cast<int64_t>(dirty_count_));
+    }
+    g_cache_metrics.writes.inc();
+}
+
+void BufferCache::note_hit(Buffer& buf) {
+    ++stats_.hits;
+    g_cache_metrics.hits.inc();
+    if (buf.readahead) {
+        buf.readahead = false;
+        ++stats_.readahead_hits;
+        g_cache_metrics.readahead_hits.inc();
+    }
+}
+
+void BufferCache::mark_clean(Buffer& buf) {
+    buf.metadata = false;
+    buf.logged = false;
+    if (buf.dirty) {
+        buf.dirty = false;
+        --dirty_count_;
+        g_cache_metrics.dirty.set(static_cast<int64_t>(dirty_count_));
+    }
+}
+
+BufferCache::Handle BufferCache::get(uint32_t block) {
+    if (Buffer* buf = lookup(block)) {
+        note_hit(*buf);
+        ++buf->pins;
+        return Handle(this, buf);
+    }
+
+    ++stats_.misses;
+    g_cache_metrics.misses.inc();
+    Buffer* buf = insert(block);
+    if (!disk_->read_block(block, buf->data.get())) {
+        discard(buf);
+        return {};
+    }
+    ++buf->pins;
+    return Handle(this, buf);
+}
+
+bool BufferCache::get_many(const std::vector<uint32_t>& blocks, std::vector<Handle>& out) {
+    out.clear();
+    out.reserve(blocks.size());
+    std::vector<BlockRead> ios;
+    for (uint32_t block : blocks) {
+        Buffer* buf = lookup(block);
+        if (buf) {
+            note_hit(*buf);
+        } else {
+            ++stats_.misses;
+            g_cache_metrics.misses.inc();
+            buf = insert(block);
+            ios.push_back({block, buf->data.get()});
+        }
+        // 先钉住，后续未命中的插入不会淘汰本批次已取得的块
+        ++buf->pins;
+        out.push_back(Handle(this, buf));
+    }
+    if (ios.empty() || disk_->read_blocks(ios)) {
+        return true;
+    }
+
+    out.clear();
+    for (const auto& io : ios) {
+        if (Buffer* buf = lookup(static_cast<uint32_t>(io.block_id))) {
+            discard(buf);
+        }
+    }
+    return false;
+}
+
+BufferCache::Handle BufferCache::get_zeroed(uint32_t block) {
+    Buffer* buf = lookup(block);
+    if (!buf) {
+        buf = insert(block);
+    }
+    std::memset(buf->data.get(), 0, BLOCK_SIZE);
+    buf->readahead = false;
+    mark_dirty(*buf, false);
+    ++buf->pins;
+    return Handle(this, buf);
+}
+
+size_t BufferCache::prefetch(const std::vector<uint32_t>& blocks) {
+    std::vector<uint32_t> fresh;
+    for (uint32_t block : blocks) {
+        if (index_.count(block) > 0) {
+            continue;
+        }
+        Buffer* buf = insert(block);
+        buf->readahead = true;
+        buf->io_pending = true;
+        ++buf->pins;  // 读完成前不可淘汰
+        fresh.push_back(block);
+    }
+    if (fresh.empty()) {
+        return 0;
+    }
+    stats_.readahead += fresh.size();
+    g_cache_metrics.readahead.inc(fresh.size());
+
+    if (disk_->async_enabled()) {
+        for (uint32_t block : fresh) {
+            uint8_t* data = index_[block]->data.get();
+            if (!disk_->submit_read(block, data, [this, block](bool ok) { finish_prefetch(block, ok); })) {
+                finish_prefetch(block, false);
+            }
+        }
+    } else {
+        std::vector<BlockRead> ios;
+        ios.reserve(fresh.size());
+        for (uint32_t block : fresh) {
+            ios.push_back({block, index_[block]->data.get()});
+        }
+        const bool ok = disk_->read_blocks(ios);
+        for (uint32_t block : fresh) {
+            finish_prefetch(block, ok);
+        }
+    }
+    return fresh.size();
+}
+
+void BufferCache::finish_prefetch(uint32_t block, bool ok) {
+    auto it = index_.find(block);
+    if (it == index_.end() || !it->second->io_pending) {
+        return;
+    }
+    Buffer* buf = &*it->second;
+    buf->io_pending = false;
+    unpin(buf);
+    if (!ok) {
+        LOG_WARN(FS, "[FS] Read-ahead failed for block " << block);
+        discard(buf);
+    }
+}
+
+bool BufferCache::read(uint32_t block, uint8_t* out) {
+    Handle h = get(block);
+    if (!h) {
+        return false;
+    }
+    std::memcpy(out, h.data(), BLOCK_SIZE);
+    return true;
+}
+
+bool BufferCache::write(uint32_t block, const uint8_t* in, bool metadata) {
+    Buffer* buf = lookup(block);
+    if (!buf) {
+        buf = insert(block);
+    }
+    std::memcpy(buf->data.get(), in, BLOCK_SIZE);
+    buf->readahead = false;
+    mark_dirty(*buf, metadata);
+    return true;
+}
+
+bool BufferCache::read_range(uint32_t first, uint32_t count, uint8_t* out) {
+    std::vector<uint32_t> blocks(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        blocks[i] = first + i;
+    }
+    std::vector<Handle> handles;
+    if (!get_many(blocks, handles)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        std::memcpy(out + static_cast<size_t>(i) * BLOCK_SIZE, handles[i].data(), BLOCK_SIZE);
+    }
+    return true;
+}
+
+bool BufferCache::write_range(uint32_t first, uint32_t count, const uint8_t* in, bool metadata) {
+    for (uint32_t i = 0; i < count; ++i) {
+        write(first + i, in + static_cast<size_t>(i) * BLOCK_SIZE, metadata);
+    }
+    return true;
+}
+
+// 按块号排序后一次 write_blocks 原地写回，并标记为干净
+bool BufferCache::write_buffers(const std::vector<Buffer*>& bufs) {
+    if (bufs.empty()) {
+        return true;
+    }
+    std::vector<BlockWrite> ios;
+    ios.reserve(bufs.size());
+    for (const Buffer* buf : bufs) {
+        ios.push_back({buf->block, buf->data.get()});
+    }
+    if (!disk_->write_blocks(ios)) {
+        LOG_ERROR(FS, "[FS] Buffer cache flush failed (" << bufs.size() << " blocks)");
+        return false;
+    }
+    for (Buffer* buf : bufs) {
+        mark_clean(*buf);
+    }
+    stats_.writebacks += bufs.size();
+    g_cache_metrics.writebacks.inc(bufs.size());
+    return true;
+}
+
+bool BufferCache::flush() {
+    std::vector<Buffer*> dirty;
+    for (auto& buf : lru_) {
+        if (buf.dirty) {
+            dirty.push_back(&buf);
+        }
+    }
+    std::sort(dirty.begin(), dirty.end(),
+              [](const Buffer* a, const Buffer* b) { return a->block < b->block; });
+    if (!journaling()) {
+        return write_buffers(dirty);
+    }
+
+    std::vector<Buffer*> data;
+    std::vector<Buffer*> unlogged;
+    bool overwrites_log = false;
+    for (Buffer* buf : dirty) {
+        if (!buf->metadata) {
+            data.push_back(buf);
+            overwrites_log = overwrites_log || journal_->contains(buf->block);
+        } else if (!buf->logged) {
+            unlogged.push_back(buf);
+        }
+    }
+    if (!unlogged.empty() && !journal_->fits(unlogged.size()) && !checkpoint()) {
+        return false;
+    }
+    // 有序模式：数据块先于引用它们的元数据事务写出。例外是数据块覆盖了日志中
+    // 仍有效的块（例如删除的目录块被重新分配），此时先提交事务并检查点，再写数据
+    if (!overwrites_log && !write_buffers(data)) {
+        return false;
+    }
+    if (!unlogged.empty()) {
+        if (journal_->fits(unlogged.size())) {
+            std::vector<BlockWrite> ios;
+            ios.reserve(unlogged.size());
+            for (const Buffer* buf : unlogged) {
+                ios.push_back({buf->block, buf->data.get()});
+            }
+            if (!journal_->log(ios)) {
+                return false;
+            }
+            for (Buffer* buf : unlogged) {
+                buf->logged = true;
+            }
+        } else {
+            // 清空后的日志也放不下：退化为直接原地写回（失去原子性）
+            LOG_WARN(FS, "[FS] Transaction of " << unlogged.size()
+                             << " blocks exceeds the journal, writing in place");
+            if (!write_buffers(unlogged)) {
+                return false;
+            }
+        }
+    }
+    if (overwrites_log && !(checkpoint() && write_buffers(data))) {
+        return false;
+    }
+    if (journal_->wants_checkpoint()) {
+        return checkpoint();
+    }
+    return true;
+}
+
+bool BufferCache::checkpoint() {
+    if (!journaling()) {
+        return true;
+    }
+    std::vector<Buffer*> logged;
+    for (auto& buf : lru_) {
+        if (buf.dirty && buf.metadata && buf.logged) {
+            logged.push_back(&buf);
+        }
+    }
+    std::sort(logged.begin(), logged.end(),
+              [](const Buffer* a, const Buffer* b) { return a->block < b->block; });
+    return write_buffers(logged) && journal_->reset();
+}
+
+bool BufferCache::barrier() {
+    const bool ok = flush();
+    return disk_->barrier() && ok;
+}
+
+bool BufferCache::sync() {
+    const bool ok = flush();
+    return disk_->sync() && ok;
+}
+
+void BufferCache::set_capacity(size_t capacity) {
+    capacity_ = std::max<size_t>(capacity, 1);
+    disk_->wait_io();  // 在途的预读完成后才能淘汰
+    while (index_.size() > capacity_ && evict_one()) {
+    }
+    LOG_INFO(FS, "[FS] Buffer cache capacity set to " << capacity_ << " blocks");
+}
+
+void BufferCache::dump(std::ostream& os) const {
+    const auto old_flags = os.flags();
+    const auto old_precision = os.precision();
+    os << "=== Buffer Cache ===\n"
+       << "capacity: " << capacity_ << " blocks (" << capacity_ * BLOCK_SIZE / 1024
+       << " KB), cached: " << index_.size() << ", dirty: " << dirty_blocks() << "\n"
+       << "hits: " << stats_.hits << "  misses: " << stats_.misses << "  hit rate: "
+       << std::fixed << std::setprecision(1) << stats_.hit_rate() * 100.0 << "%\n"
+       << "evictions: " << stats_.evictions << "  writebacks: " << stats_.writebacks << "\n"
+       << "read-ahead: " << stats_.readahead << " blocks, hits: " << stats_.readahead_hits
+       << ", wasted: " << stats_.readahead_wasted << "\n";
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
@@ -1,10 +1,85 @@
 #include "fs/directory_manager.h"
+#include "common/event_trace.h"
+#include "common/log.h"
+#include "common/metrics.h"
 #include <iostream>
+#include <iomanip>
 #include <vector>
 #include <cstring>
 
-DirectoryManager::DirectoryManager(DiskDevice* disk, InodeManager* inode_mgr, BlockManager* block_mgr)
-    : disk_(disk), inode_mgr_(inode_mgr), block_mgr_(block_mgr) {}
+namespace {
+struct DirMetrics {
+    metrics::Counter& path_lookups = metrics::registry().counter(
+        "fs_path_lookups_total", "Full path resolutions");
+    metrics::Counter& dir_lookups = metrics::registry().counter(
+        "fs_dir_lookups_total", "Single-directory name lookups");
+    metrics::Counter& dir_blocks_scanned = metrics::registry().counter(
+        "fs_dir_blocks_scanned_total", "Directory blocks read while scanning entries");
+    metrics::Counter& entries_added = metrics::registry().counter(
+        "fs_dirents_added_total", "Directory entries added");
+    metrics::Counter& entries_removed = metrics::registry().counter(
+        "fs_dirents_removed_total", "Directory entries removed");
+    metrics::Histogram& lookup_ns = metrics::registry().histogram(
+        "fs_path_lookup_latency_ns", "Path resolution latency in nanoseconds");
+    metrics::Counter& dcache_hits = metrics::registry().counter(
+        "fs_dcache_hits_total", "Directory lookups answered by the dentry cache");
+    metrics::Counter& dcache_negative_hits = metrics::registry().counter(
+        "fs_dcache_negative_hits_total", "Dentry cache hits on a cached missing name");
+    metrics::Counter& dcache_misses = metrics::registry().counter(
+        "fs_dcache_misses_total", "Directory lookups that scanned directory blocks");
+    metrics::Gauge& dcache_entries = metrics::registry().gauge(
+        "fs_dcache_entries", "Entries currently held in the dentry cache");
+};
+DirMetrics g_dir_metrics;
+}
+
+DirectoryManager::DirectoryManager(BufferCache* cache, InodeManager* inode_mgr, BlockManager* block_mgr,
+                                   BlockMap* block_map)
+    : cache_(cache), inode_mgr_(inode_mgr), block_mgr_(block_mgr), block_map_(block_map) {
+    dentries_.reserve(config::DENTRY_CACHE_ENTRIES);
+}
+
+void DirectoryManager::cache_dentry(uint32_t parent, const std::string& name, uint32_t inode_num) {
+    // 满时随意丢弃一项；路径解析的工作集通常远小于容量
+    if (dentries_.size() >= config::DENTRY_CACHE_ENTRIES) {
+        dentries_.erase(dentries_.begin());
+    }
+    dentries_[DentryKey{parent, name}] = inode_num;
+    g_dir_metrics.dcache_entries.set(static_cast<int64_t>(dentries_.size()));
+}
+
+void DirectoryManager::forget_dentry(uint32_t parent, const std::string& name) {
+    dentries_.erase(DentryKey{parent, name});
+    g_dir_metrics.dcache_entries.set(static_cast<int64_t>(dentries_.size()));
+}
+
+// 目录被删除后其 inode 号可能重新分配给新目录，以它为父的缓存项须全部丢弃
+void DirectoryManager::forget_directory(uint32_t dir_inode) {
+    std::erase_if(dentries_, [dir_inode](const auto& item) { return item.first.parent == dir_inode; });
+    g_dir_metrics.dcache_entries.set(static_cast<int64_t>(dentries_.size()));
+}
+
+void DirectoryManager::invalidate_dentries() {
+    dentries_.clear();
+    g_dir_metrics.dcache_entries.set(0);
+}
+
+void DirectoryManager::dump_dentry_cache(std::ostream& os) const {
+    size_t negative = 0;
+    for (const auto& [key, inode_num] : dentries_) {
+        negative += inode_num == INVALID_INODE ? 1 : 0;
+    }
+    const auto old_flags = os.flags();
+    const auto old_precision = os.precision();
+    os << "=== Dentry Cache ===\n"
+       << "entries: " << dentries_.size() << " (negative: " << negative
+       << "), capacity: " << config::DENTRY_CACHE_ENTRIES << "\n"
+       << "hits: " << dstats_.hits << " (negative: " << dstats_.negative_hits
+       << ")  misses: " << dstats_.misses << "  hit rate: " << std::fixed
+       << std::setprecision(1) << dstats_.hit_rate() * 100.0 << "%\n";
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
 
 // 规范化：相对路径转换为绝对路径
 std::string DirectoryManager::normalize_path(const std::string& path, const std::string& current_dir) {
@@ -66,6 +141,8 @@ void DirectoryManager::split_path(const std::string& path, std::string& parent,
 
 // 根据路径查找inode编号，逐级解析路径组件
 uint32_t DirectoryManager::lookup_path(const std::string& path, const std::string& current_dir) {
+    metrics::ScopedTimer timer(g_dir_metrics.lookup_ns);
+    g_dir_metrics.path_lookups.inc();
     std::string norm_path = normalize_path(path, current_dir);
     
     if (norm_path == "/") {
@@ -99,6 +176,20 @@ uint32_t DirectoryManager::lookup_path(const std::string& path, const std::strin
 
 // 在指定目录中查找文件/子目录的inode编号
 uint32_t DirectoryManager::lookup_in_directory(uint32_t dir_inode, const std::string& name) {
+    g_dir_metrics.dir_lookups.inc();
+    auto cached = dentries_.find(DentryKey{dir_inode, name});
+    if (cached != dentries_.end()) {
+        ++dstats_.hits;
+        g_dir_metrics.dcache_hits.inc();
+        if (cached->second == INVALID_INODE) {
+            ++dstats_.negative_hits;
+            g_dir_metrics.dcache_negative_hits.inc();
+        }
+        return cached->second;
+    }
+    ++dstats_.misses;
+    g_dir_metrics.dcache_misses.inc();
+
     Inode inode;
     if (!inode_mgr_->read_inode(dir_inode, inode)) {
         return INVALID_INODE;
@@ -108,22 +199,27 @@ uint32_t DirectoryManager::lookup_in_directory(uint32_t dir_inode, const std::st
         return INVALID_INODE;
     }
     
-    for (uint32_t i = 0; i < inode.blocks_used; i++) {
-        std::vector<uint8_t> block_data(BLOCK_SIZE);
-        if (!disk_->read_block(inode.direct_blocks[i], block_data.data())) {
-            continue;
-        }
+    // 直接扫描缓存中的目录块；未命中的块合并为一次 read_blocks 读入
+    std::vector<uint32_t> blocks;
+    std::vector<BufferCache::Handle> handles;
+    if (!block_map_->map(inode, 0, inode.blocks_used, blocks) || !cache_->get_many(blocks, handles)) {
+        return INVALID_INODE;
+    }
+    for (const auto& block : handles) {
+        g_dir_metrics.dir_blocks_scanned.inc();
         
-        DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block_data.data());
+        const DirectoryEntry* entries = reinterpret_cast<const DirectoryEntry*>(block.data());
         uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
         
         for (uint32_t j = 0; j < num_entries; j++) {
             if (entries[j].is_valid() && name == entries[j].name) {
+                cache_dentry(dir_inode, name, entries[j].inode_num);
                 return entries[j].inode_num;
             }
         }
     }
     
+    cache_dentry(dir_inode, name, INVALID_INODE);
     return INVALID_INODE;
 }
 
@@ -135,49 +231,61 @@ bool DirectoryManager::add_directory_entry(uint32_t dir_inode, const std::string
     }
     
     // 查找空闲目录项
-    for (uint32_t i = 0; i < inode.blocks_used; i++) {
-        std::vector<uint8_t> block_data(BLOCK_SIZE);
-        if (!disk_->read_block(inode.direct_blocks[i], block_data.data())) {
+    std::vector<uint32_t> blocks;
+    if (!block_map_->map(inode, 0, inode.blocks_used, blocks)) {
+        return false;
+    }
+    for (uint32_t block_num : blocks) {
+        BufferCache::Handle block = cache_->get(block_num);
+        if (!block) {
             continue;
         }
         
-        DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block_data.data());
+        const DirectoryEntry* entries = reinterpret_cast<const DirectoryEntry*>(block.data());
         uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
         
         for (uint32_t j = 0; j < num_entries; j++) {
             if (!entries[j].is_valid()) {
-                entries[j] = DirectoryEntry(name.c_str(), inode_num);
-                disk_->write_block(inode.direct_blocks[i], block_data.data());
+                reinterpret_cast<DirectoryEntry*>(block.mutable_metadata())[j] =
+                    DirectoryEntry(name.c_str(), inode_num);
+                forget_dentry(dir_inode, name);
                 inode.size += DIRENT_SIZE;
                 inode_mgr_->write_inode(dir_inode, inode);
+                g_dir_metrics.entries_added.inc();
                 return true;
             }
         }
     }
     
-    if (inode.blocks_used >= DIRECT_BLOCKS) {
-        std::cerr << "[FS] Directory full" << std::endl;
+    if (inode.blocks_used >= MAX_FILE_BLOCKS) {
+        LOG_WARN(FS, "[FS] Directory full");
         return false;
     }
     
-    uint32_t new_block = block_mgr_->alloc_block();
+    // 新块尽量紧接目录的末块，与之合并为同一个 extent
+    const uint32_t new_block = block_mgr_->alloc_extent(block_map_->goal(inode), 1).start;
     if (new_block == INVALID_BLOCK) {
         return false;
     }
     
-    std::vector<uint8_t> block_data(BLOCK_SIZE, 0);
-    DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block_data.data());
+    // 新块无需从磁盘读入，直接在缓存中清零后填写
+    BufferCache::Handle block = cache_->get_zeroed(new_block);
+    DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block.mutable_metadata());
     const uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
     for (uint32_t i = 0; i < num_entries; ++i) {
         entries[i] = DirectoryEntry{};
     }
     entries[0] = DirectoryEntry(name.c_str(), inode_num);
     
-    disk_->write_block(new_block, block_data.data());
-    inode.direct_blocks[inode.blocks_used] = new_block;
-    inode.blocks_used++;
+    if (block_map_->append(inode, new_block, 1) != 1) {
+        block.release();
+        block_mgr_->free_block(new_block);
+        return false;
+    }
+    forget_dentry(dir_inode, name);
     inode.size += DIRENT_SIZE;
     inode_mgr_->write_inode(dir_inode, inode);
+    g_dir_metrics.entries_added.inc();
     
     return true;
 }
@@ -189,21 +297,26 @@ bool DirectoryManager::remove_directory_entry(uint32_t dir_inode, const std::str
         return false;
     }
     
-    for (uint32_t i = 0; i < inode.blocks_used; i++) {
-        std::vector<uint8_t> block_data(BLOCK_SIZE);
-        if (!disk_->read_block(inode.direct_blocks[i], block_data.data())) {
+    std::vector<uint32_t> blocks;
+    if (!block_map_->map(inode, 0, inode.blocks_used, blocks)) {
+        return false;
+    }
+    for (uint32_t block_num : blocks) {
+        BufferCache::Handle block = cache_->get(block_num);
+        if (!block) {
             continue;
         }
         
-        DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block_data.data());
+        const DirectoryEntry* entries = reinterpret_cast<const DirectoryEntry*>(block.data());
         uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
         
         for (uint32_t j = 0; j < num_entries; j++) {
             if (entries[j].is_valid() && name == entries[j].name) {
-                entries[j].inode_num = INVALID_INODE;
-                disk_->write_block(inode.direct_blocks[i], block_data.data());
+                reinterpret_cast<DirectoryEntry*>(block.mutable_metadata())[j].inode_num = INVALID_INODE;
+                forget_dentry(dir_inode, name);
                 inode.size -= DIRENT_SIZE;
                 inode_mgr_->write_inode(dir_inode, inode);
+                g_dir_metrics.entries_removed.inc();
                 return true;
             }
         }
@@ -219,21 +332,21 @@ bool DirectoryManager::create_directory(const std::string& path, const std::stri
     
     uint32_t parent_inode = lookup_path(parent_path, current_dir);
     if (parent_inode == INVALID_INODE) {
-        std::cerr << "[FS] Parent directory not found: " << parent_path << std::endl;
+        LOG_WARN(FS, "[FS] Parent directory not found: " << parent_path);
         return false;
     }
     
     if (lookup_in_directory(parent_inode, dir_name) != INVALID_INODE) {
-        std::cerr << "[FS] Directory already exists: " << path << std::endl;
+        LOG_WARN(FS, "[FS] Directory already exists: " << path);
         return false;
     }
     
-    uint32_t new_inode = block_mgr_->alloc_inode();
+    uint32_t new_inode = block_mgr_->alloc_inode(parent_inode, true);
     if (new_inode == INVALID_INODE) {
         return false;
     }
     
-    uint32_t data_block = block_mgr_->alloc_block();
+    uint32_t data_block = block_mgr_->alloc_block(block_mgr_->group_goal(new_inode));
     if (data_block == INVALID_BLOCK) {
         block_mgr_->free_inode(new_inode);
         return false;
@@ -242,19 +355,19 @@ bool DirectoryManager::create_directory(const std::string& path, const std::stri
     Inode inode;
     inode.type = FileType::DIRECTORY;
     inode.size = 2 * DIRENT_SIZE;
-    inode.blocks_used = 1;
-    inode.direct_blocks[0] = data_block;
+    block_map_->append(inode, data_block, 1);
     
-    std::vector<uint8_t> block_data(BLOCK_SIZE, 0);
-    DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block_data.data());
-    const uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
-    for (uint32_t i = 0; i < num_entries; ++i) {
-        entries[i] = DirectoryEntry{};
+    {
+        BufferCache::Handle block = cache_->get_zeroed(data_block);
+        DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block.mutable_metadata());
+        const uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
+        for (uint32_t i = 0; i < num_entries; ++i) {
+            entries[i] = DirectoryEntry{};
+        }
+        entries[0] = DirectoryEntry(".", new_inode);
+        entries[1] = DirectoryEntry("..", parent_inode);
     }
-    entries[0] = DirectoryEntry(".", new_inode);
-    entries[1] = DirectoryEntry("..", parent_inode);
     
-    disk_->write_block(data_block, block_data.data());
     inode_mgr_->write_inode(new_inode, inode);
     
     if (!add_directory_entry(parent_inode, dir_name, new_inode)) {
@@ -263,7 +376,9 @@ bool DirectoryManager::create_directory(const std::string& path, const std::stri
         return false;
     }
     
-    std::cerr << "[FS] Created directory: " << path << " (inode=" << new_inode << ")" << std::endl;
+    trace::record(trace::EventType::FsOp, -1,
+                  static_cast<uint32_t>(trace::FsOpKind::Mkdir), new_inode);
+    LOG_INFO(FS, "[FS] Created directory: " << path << " (inode=" << new_inode << ")");
     return true;
 }
 
@@ -271,7 +386,7 @@ bool DirectoryManager::create_directory(const std::string& path, const std::stri
 bool DirectoryManager::list_directory(const std::string& path, const std::string& current_dir) {
     uint32_t dir_inode = lookup_path(path, current_dir);
     if (dir_inode == INVALID_INODE) {
-        std::cerr << "[FS] Directory not found: " << path << std::endl;
+        LOG_WARN(FS, "[FS] Directory not found: " << path);
         return false;
     }
     
@@ -281,19 +396,23 @@ bool DirectoryManager::list_directory(const std::string& path, const std::string
     }
     
     if (inode.type != FileType::DIRECTORY) {
-        std::cerr << "[FS] Not a directory: " << path << std::endl;
+        LOG_WARN(FS, "[FS] Not a directory: " << path);
         return false;
     }
     
     std::cout << "Contents of " << path << ":" << std::endl;
     
-    for (uint32_t i = 0; i < inode.blocks_used; i++) {
-        std::vector<uint8_t> block_data(BLOCK_SIZE);
-        if (!disk_->read_block(inode.direct_blocks[i], block_data.data())) {
+    std::vector<uint32_t> blocks;
+    if (!block_map_->map(inode, 0, inode.blocks_used, blocks)) {
+        return false;
+    }
+    for (uint32_t block_num : blocks) {
+        BufferCache::Handle block = cache_->get(block_num);
+        if (!block) {
             continue;
         }
         
-        DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(block_data.data());
+        const DirectoryEntry* entries = reinterpret_cast<const DirectoryEntry*>(block.data());
         uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
         
         for (uint32_t j = 0; j < num_entries; j++) {
@@ -2,9 +2,9 @@
 
 FileDescriptorTable::FileDescriptorTable() : next_fd_(3) {}
 
-int FileDescriptorTable::alloc_fd(uint32_t inode_num) {
+int FileDescriptorTable::alloc_fd(uint32_t inode_num, Inode* inode) {
     int fd = next_fd_++;
-    open_files_[fd] = {inode_num, 0};
+    open_files_[fd] = {inode_num, 0, inode};
     return fd;
 }
 
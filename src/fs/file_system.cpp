@@ -1,125 +1,413 @@
 #include "fs/file_system.h"
+#include "common/event_trace.h"
+#include "common/log.h"
+#include "common/metrics.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
 #include <algorithm>
 
+namespace {
+struct FsMetrics {
+    metrics::Counter& reads = metrics::registry().counter(
+        "fs_file_reads_total", "read_file calls");
+    metrics::Counter& writes = metrics::registry().counter(
+        "fs_file_writes_total", "write_file calls");
+    metrics::Counter& read_bytes = metrics::registry().counter(
+        "fs_read_bytes_total", "Bytes returned by read_file");
+    metrics::Counter& write_bytes = metrics::registry().counter(
+        "fs_write_bytes_total", "Bytes accepted by write_file");
+    metrics::Counter& metadata_ops = metrics::registry().counter(
+        "fs_metadata_ops_total", "create/remove/mkdir operations");
+    metrics::Counter& metadata_commits = metrics::registry().counter(
+        "fs_metadata_commits_total", "Group commits of in-memory metadata changes");
+    metrics::Histogram& read_ns = metrics::registry().histogram(
+        "fs_read_latency_ns", "read_file latency in nanoseconds");
+    metrics::Histogram& write_ns = metrics::registry().histogram(
+        "fs_write_latency_ns", "write_file latency in nanoseconds");
+    metrics::Gauge& free_blocks = metrics::registry().gauge(
+        "fs_free_blocks", "Free data blocks after the last metadata update");
+    metrics::Gauge& free_inodes = metrics::registry().gauge(
+        "fs_free_inodes", "Free inodes after the last metadata update");
+    metrics::Counter& delalloc_flushes = metrics::registry().counter(
+        "fs_delalloc_flushes_total", "Flushes that allocated blocks for delayed file data");
+    metrics::Counter& delalloc_allocated = metrics::registry().counter(
+        "fs_delalloc_blocks_total", "Blocks allocated for delayed file data");
+    metrics::Counter& delalloc_extents = metrics::registry().counter(
+        "fs_delalloc_extents_total", "Contiguous block runs produced by delayed allocation");
+    metrics::Gauge& delalloc_pending = metrics::registry().gauge(
+        "fs_delalloc_pending_blocks", "File data blocks waiting for delayed allocation");
+};
+FsMetrics g_fs_metrics;
+
+// 按分区大小计算布局：[超级块][日志][块组 0][块组 1]...
+// 新格式化的分区按大小配日志：JOURNAL_BLOCKS 与分区 1/16 取小，太小则不建日志
+uint32_t journal_blocks_for(uint32_t fs_blocks) {
+    const uint32_t blocks = std::min(config::JOURNAL_BLOCKS, fs_blocks / 16);
+    return blocks < config::JOURNAL_MIN_BLOCKS ? 0 : blocks;
+}
+
+// 块组大小取 FS_BLOCKS_PER_GROUP（一个数据位图块最多表示 BITS_PER_BITMAP_BLOCK 块），
+// 每组按块数配 inode，不少于 MAX_INODES；末组放不下自身的位图、inode 表和至少一个数据块时舍去
+bool compute_layout(uint32_t fs_blocks, uint32_t journal_blocks, SuperBlock& sb) {
+    const uint32_t first_group = SUPERBLOCK_BLOCK + 1 + journal_blocks;
+    if (fs_blocks <= first_group) {
+        return false;
+    }
+    const uint32_t avail = fs_blocks - first_group;
+    const uint32_t per_group = std::min(config::FS_BLOCKS_PER_GROUP, BITS_PER_BITMAP_BLOCK);
+    uint32_t inodes = std::max(MAX_INODES, std::min(avail, per_group) / BLOCKS_PER_INODE);
+    inodes = (inodes + INODES_PER_BLOCK - 1) / INODES_PER_BLOCK * INODES_PER_BLOCK;
+    inodes = std::min(inodes, BITS_PER_BITMAP_BLOCK);  // inode 位图每组一块
+
+    const uint32_t overhead = 2 + inodes / INODES_PER_BLOCK;
+    uint32_t groups = (avail + per_group - 1) / per_group;
+    if (avail - (groups - 1) * per_group <= overhead + 1) {
+        --groups;
+    }
+    if (groups == 0) {
+        return false;
+    }
+
+    sb.total_blocks = fs_blocks;
+    sb.group_count = groups;
+    sb.blocks_per_group = per_group;
+    sb.inodes_per_group = inodes;
+    sb.first_group_block = first_group;
+    sb.total_inodes = groups * inodes;
+    sb.journal_start = journal_blocks != 0 ? SUPERBLOCK_BLOCK + 1 : 0;
+    sb.journal_blocks = journal_blocks;
+    const GroupLayout group0 = sb.group(0);
+    sb.inode_bitmap_block = group0.inode_bitmap;
+    sb.data_bitmap_block = group0.data_bitmap;
+    sb.data_bitmap_blocks = group0.data_bitmap_blocks;
+    sb.inode_table_start = group0.inode_table;
+    sb.inode_table_blocks = inodes / INODES_PER_BLOCK;
+    sb.data_blocks_start = group0.data_start;
+    return true;
+}
+}
+
 // 初始化文件系统，创建各个管理器
 FileSystem::FileSystem(DiskDevice* disk)
     : disk_(disk), mounted_(false), current_dir_("/") {
-    inode_mgr_ = std::make_unique<InodeManager>(disk_);
-    block_mgr_ = std::make_unique<BlockManager>(disk_);
-    dir_mgr_ = std::make_unique<DirectoryManager>(disk_, inode_mgr_.get(), block_mgr_.get());
+    journal_ = std::make_unique<Journal>(disk_);
+    cache_ = std::make_unique<BufferCache>(disk_, config::BUFFER_CACHE_BLOCKS);
+    cache_->set_journal(journal_.get());
+    inode_mgr_ = std::make_unique<InodeManager>(cache_.get(), &superblock_);
+    block_mgr_ = std::make_unique<BlockManager>(cache_.get(), &superblock_);
+    block_map_ = std::make_unique<BlockMap>(cache_.get(), block_mgr_.get());
+    dir_mgr_ = std::make_unique<DirectoryManager>(cache_.get(), inode_mgr_.get(), block_mgr_.get(),
+                                                  block_map_.get());
     fd_table_ = std::make_unique<FileDescriptorTable>();
 }
 
-// 卸载时保存修改过的数据
+// 卸载时提交未提交的元数据并做检查点，镜像不依赖日志重放即完整
 FileSystem::~FileSystem() {
-    if (mounted_ && block_mgr_->is_bitmap_dirty()) {
-        block_mgr_->save_bitmaps();
-        save_superblock();
+    if (mounted_) {
+        write_metadata();
+        cache_->flush();
+        cache_->checkpoint();
+        cache_->sync();
     }
 }
 
+// 提交元数据，把缓存中的脏块写到磁盘，再让磁盘把写回缓冲落盘
+bool FileSystem::sync() {
+    const bool ok = write_metadata();
+    return cache_->sync() && ok;
+}
+
+// 元数据提交点：内存中的元数据写入缓冲缓存，再把缓存中的脏块交给磁盘
+bool FileSystem::commit() {
+    const bool ok = write_metadata();
+    return cache_->barrier() && ok;
+}
+
+// 先落实延迟分配（数据块先于引用它的 inode 到达磁盘），再写位图与超级块
+// （自上次提交以来有改动时才写），最后按 inode 表块写回脏 inode
+bool FileSystem::write_metadata() {
+    allocate_delayed();
+    bool ok = true;
+    if (block_mgr_->is_bitmap_dirty()) {
+        refresh_space_counters_from_bitmaps();
+        ok = save_superblock() && block_mgr_->save_bitmaps();
+    }
+    if (pending_ops_ != 0) {
+        g_fs_metrics.metadata_commits.inc();
+        pending_ops_ = 0;
+    }
+    return inode_mgr_->flush() && ok;
+}
+
+// 元数据操作只改内存（位图、inode 表、目录块均在缓存中），累计到
+// commit_ops_ 个或由 tick 定时器成组提交
+void FileSystem::metadata_changed() {
+    g_fs_metrics.metadata_ops.inc();
+    refresh_space_counters_from_bitmaps();
+    if (pending_ops_++ == 0) {
+        pending_since_ = now_;
+    }
+    if (pending_ops_ >= commit_ops_) {
+        commit();
+    }
+}
+
+void FileSystem::set_commit_interval(size_t ops, uint64_t ticks) {
+    commit_ops_ = std::max<size_t>(ops, 1);
+    commit_ticks_ = ticks;
+    if (pending_ops_ >= commit_ops_) {
+        commit();
+    }
+}
+
+void FileSystem::tick(uint64_t now) {
+    now_ = now;
+    const bool metadata_due = pending_ops_ != 0 && now >= pending_since_ + commit_ticks_;
+    const bool data_due =
+        delalloc_blocks_ != 0 && now >= delalloc_since_ + config::DELALLOC_FLUSH_TICKS;
+    if (metadata_due || data_due) {
+        commit();
+    }
+}
+
+// 为所有延迟分配的数据分配块并写入缓冲缓存
+void FileSystem::allocate_delayed() {
+    if (delalloc_.empty()) {
+        return;
+    }
+    for (auto& [inode_num, data] : delalloc_) {
+        Inode* inode = inode_mgr_->get(inode_num);
+        if (!inode) {
+            LOG_ERROR(FS, "[FS] Delayed allocation lost: inode " << inode_num << " unreadable");
+            continue;
+        }
+        // 待分配的块索引紧接已分配块之后：按段分配，每段尽量紧接文件末块，
+        // 在块映射中记为一段（或延长末段）。映射块随段分配，不打断数据块的连续段
+        const uint32_t total = static_cast<uint32_t>(data.blocks.size());
+        auto next = data.blocks.begin();
+        // 空文件的第一段放在 inode 所在的块组
+        uint32_t goal = inode->blocks_used != 0 ? block_map_->goal(*inode)
+                                                : block_mgr_->group_goal(inode_num);
+        uint32_t i = 0;
+        while (i < total) {
+            const Extent run = block_mgr_->alloc_extent(goal, total - i);
+            if (run.length == 0) {
+                break;
+            }
+            const uint32_t appended = block_map_->append(*inode, run.start, run.length);
+            if (appended < run.length) {
+                block_mgr_->free_extent({run.start + appended, run.length - appended});
+            }
+            if (appended != 0 && (i == 0 || run.start != goal)) {
+                g_fs_metrics.delalloc_extents.inc();
+            }
+            for (uint32_t k = 0; k < appended; ++k, ++next) {
+                cache_->write(run.start + k, next->second.get());
+            }
+            i += appended;
+            if (appended < run.length) {
+                break;
+            }
+            goal = run.start + run.length;
+        }
+        if (i < total) {
+            LOG_ERROR(FS, "[FS] Delayed allocation short of space for inode " << inode_num);
+            inode->size = std::min<uint64_t>(inode->size,
+                                             static_cast<uint64_t>(inode->blocks_used) * BLOCK_SIZE);
+        }
+        g_fs_metrics.delalloc_allocated.inc(i);
+        inode_mgr_->mark_dirty(inode_num);
+        inode_mgr_->put(inode_num);
+    }
+    delalloc_.clear();
+    delalloc_blocks_ = 0;
+    delalloc_metadata_ = 0;
+    g_fs_metrics.delalloc_pending.set(0);
+    g_fs_metrics.delalloc_flushes.inc();
+}
+
+void FileSystem::drop_delayed(uint32_t inode_num) {
+    auto it = delalloc_.find(inode_num);
+    if (it == delalloc_.end()) {
+        return;
+    }
+    delalloc_blocks_ -= it->second.blocks.size();
+    delalloc_metadata_ -= it->second.metadata;
+    delalloc_.erase(it);
+    g_fs_metrics.delalloc_pending.set(static_cast<int64_t>(delalloc_blocks_));
+}
+
 // 格式化文件系统：初始化超级块、位图和根目录
 bool FileSystem::format() {
-    std::cerr << "[FS] Formatting file system..." << std::endl;
+    LOG_INFO(FS, "[FS] Formatting file system...");
     
-    // 初始化超级块
+    if (disk_->get_block_size() != BLOCK_SIZE) {
+        LOG_ERROR(FS, "[FS] Format failed: file system requires " << BLOCK_SIZE
+                          << "-byte blocks, disk has " << disk_->get_block_size());
+        return false;
+    }
+
+    // 旧文件系统的 inode 与目录项在格式化后全部失效
+    inode_mgr_->invalidate();
+    dir_mgr_->invalidate_dentries();
+    delalloc_.clear();
+    delalloc_blocks_ = 0;
+    delalloc_metadata_ = 0;
+    g_fs_metrics.delalloc_pending.set(0);
+    pending_ops_ = 0;
+
+    // 初始化超级块，布局按当前磁盘几何计算
     superblock_ = SuperBlock();
     superblock_.magic = FS_MAGIC;
-    superblock_.total_blocks = TOTAL_BLOCKS;
-    superblock_.total_inodes = MAX_INODES;
-    superblock_.free_blocks = MAX_DATA_BLOCKS;
-    superblock_.free_inodes = MAX_INODES;
-    
-    superblock_.inode_bitmap_block = INODE_BITMAP_BLOCK;
-    superblock_.data_bitmap_block = DATA_BITMAP_BLOCK;
-    superblock_.inode_table_start = INODE_TABLE_START;
-    superblock_.inode_table_blocks = INODE_TABLE_BLOCKS;
-    superblock_.data_blocks_start = DATA_BLOCKS_START;
-    
-    if (!save_superblock()) {
-        std::cerr << "[FS] Format failed: unable to write SuperBlock" << std::endl;
+    superblock_.block_size = BLOCK_SIZE;
+    superblock_.disk_blocks = static_cast<uint32_t>(disk_->get_num_blocks());
+    superblock_.swap_blocks = static_cast<uint32_t>(disk_->get_swap_blocks());
+    const uint32_t fs_blocks = static_cast<uint32_t>(disk_->swap_start());
+    if (!compute_layout(fs_blocks, journal_blocks_for(fs_blocks), superblock_)) {
+        LOG_ERROR(FS, "[FS] Format failed: partition of " << disk_->swap_start()
+                          << " blocks is too small");
+        return false;
+    }
+    superblock_.free_blocks = superblock_.data_blocks();
+    superblock_.free_inodes = superblock_.total_inodes;
+
+    // 旧日志中的事务不能在新文件系统上重放
+    journal_->attach(superblock_.journal_start, superblock_.journal_blocks);
+    if (!journal_->format()) {
+        LOG_ERROR(FS, "[FS] Format failed: unable to initialize journal");
         return false;
     }
     
-    // 初始化位图
-    std::vector<uint8_t> zero_bitmap(BLOCK_SIZE, 0);
-    if (!disk_->write_block(INODE_BITMAP_BLOCK, zero_bitmap.data()) ||
-        !disk_->write_block(DATA_BITMAP_BLOCK, zero_bitmap.data())) {
-        std::cerr << "[FS] Format failed: unable to initialize bitmaps"
-                  << std::endl;
+    if (!save_superblock()) {
+        LOG_ERROR(FS, "[FS] Format failed: unable to write SuperBlock");
         return false;
     }
     
-    // 清空inode表
-    std::vector<uint8_t> zero_block(BLOCK_SIZE, 0);
-    for (uint32_t i = 0; i < INODE_TABLE_BLOCKS; i++) {
-        if (!disk_->write_block(INODE_TABLE_START + i, zero_block.data())) {
-            std::cerr << "[FS] Format failed: unable to clear inode table"
-                      << std::endl;
-            return false;
+    // 初始化位图，清空inode表（镜像是稀疏文件，只有这些元数据块被真正写入）；
+    // 清零在缓存中完成，随下面的 barrier 一次合并写出
+    for (uint32_t g = 0; g < superblock_.groups(); g++) {
+        const GroupLayout group = superblock_.group(g);
+        cache_->get_zeroed(group.inode_bitmap);
+        for (uint32_t i = 0; i < group.data_bitmap_blocks; i++) {
+            cache_->get_zeroed(group.data_bitmap + i);
+        }
+        for (uint32_t i = 0; i < group.inodes / INODES_PER_BLOCK; i++) {
+            cache_->get_zeroed(group.inode_table + i);
         }
     }
 
     if (!block_mgr_->load_bitmaps()) {
-        std::cerr << "[FS] Format failed: unable to load bitmaps" << std::endl;
+        LOG_ERROR(FS, "[FS] Format failed: unable to load bitmaps");
         return false;
     }
 
     uint32_t root_inode = block_mgr_->alloc_inode();
     if (root_inode != ROOT_INODE) {
-        std::cerr << "[FS] Format failed: unable to reserve root inode"
-                  << std::endl;
+        LOG_ERROR(FS, "[FS] Format failed: unable to reserve root inode");
         return false;
     }
     
     if (!init_root_directory()) {
-        std::cerr << "[FS] Format failed: unable to create root directory" << std::endl;
+        LOG_ERROR(FS, "[FS] Format failed: unable to create root directory");
         return false;
     }
 
     refresh_space_counters_from_bitmaps();
     if (!save_superblock() || !block_mgr_->save_bitmaps()) {
-        std::cerr << "[FS] Format failed: unable to persist metadata"
-                  << std::endl;
+        LOG_ERROR(FS, "[FS] Format failed: unable to persist metadata");
         return false;
     }
 
     mounted_ = true;
+    if (!commit()) {
+        LOG_ERROR(FS, "[FS] Format failed: unable to flush metadata");
+        return false;
+    }
     
-    std::cerr << "[FS] Format complete!" << std::endl;
-    std::cerr << "[FS] Total blocks: " << superblock_.total_blocks 
-              << ", Total inodes: " << superblock_.total_inodes << std::endl;
+    LOG_INFO(FS, "[FS] Format complete!");
+    LOG_INFO(FS, "[FS] Total blocks: " << superblock_.total_blocks
+                     << ", Total inodes: " << superblock_.total_inodes);
     
     return true;
 }
 
 // 挂载文件系统：加载超级块和位图
 bool FileSystem::mount() {
-    std::cerr << "[FS] Mounting file system..." << std::endl;
-    
+    LOG_INFO(FS, "[FS] Mounting file system...");
+    
+    inode_mgr_->invalidate();
+    dir_mgr_->invalidate_dentries();
+    delalloc_.clear();
+    delalloc_blocks_ = 0;
+    delalloc_metadata_ = 0;
+    g_fs_metrics.delalloc_pending.set(0);
+    pending_ops_ = 0;
+
     if (!load_superblock()) {
-        std::cerr << "[FS] Mount failed: unable to read SuperBlock" << std::endl;
+        LOG_ERROR(FS, "[FS] Mount failed: unable to read SuperBlock");
         return false;
     }
     
     // 验证魔数
     if (superblock_.magic != FS_MAGIC) {
-        std::cerr << "[FS] Mount failed: magic number mismatch (expected: 0x" 
-                  << std::hex << FS_MAGIC << ", actual: 0x" 
-                  << superblock_.magic << std::dec << ")" << std::endl;
+        LOG_ERROR(FS, "[FS] Mount failed: magic number mismatch (expected: 0x"
+                          << std::hex << FS_MAGIC << ", actual: 0x"
+                          << superblock_.magic << std::dec << ")");
         return false;
     }
 
-    if (superblock_.total_blocks != TOTAL_BLOCKS || superblock_.total_inodes != MAX_INODES) {
-        std::cerr << "[FS] Mount failed: layout mismatch, please re-format" << std::endl;
+    // 旧版镜像没有记录几何与数据位图块数，按默认几何与单块数据位图解释
+    if (superblock_.block_size == 0) {
+        superblock_.block_size = BLOCK_SIZE;
+        superblock_.disk_blocks = static_cast<uint32_t>(config::DISK_NUM_BLOCKS);
+        superblock_.swap_blocks = static_cast<uint32_t>(config::SWAP_RESERVED_BLOCKS);
+        superblock_.data_bitmap_blocks = 1;
+    }
+
+    // 未显式指定 swap 大小时沿用镜像中记录的分区
+    if (!disk_->swap_blocks_requested() && superblock_.swap_blocks != disk_->get_swap_blocks() &&
+        superblock_.swap_blocks < disk_->get_num_blocks()) {
+        disk_->set_swap_blocks(superblock_.swap_blocks);
+    }
+
+    // 分组前的旧镜像只核对分区大小，其余布局按超级块中的字段使用
+    SuperBlock expected;
+    if (superblock_.block_size != disk_->get_block_size() ||
+        superblock_.disk_blocks != disk_->get_num_blocks() ||
+        superblock_.swap_blocks != disk_->get_swap_blocks() ||
+        superblock_.total_blocks != disk_->swap_start() ||
+        (superblock_.group_count != 0 &&
+         (!compute_layout(superblock_.total_blocks, superblock_.journal_blocks, expected) ||
+          superblock_.group_count != expected.group_count ||
+          superblock_.blocks_per_group != expected.blocks_per_group ||
+          superblock_.inodes_per_group != expected.inodes_per_group ||
+          superblock_.first_group_block != expected.first_group_block ||
+          superblock_.total_inodes != expected.total_inodes ||
+          superblock_.journal_start != expected.journal_start))) {
+        LOG_ERROR(FS, "[FS] Mount failed: layout mismatch, please re-format");
         return false;
     }
+
+    // 重放日志中已提交的事务：写入缓冲缓存后原地写回，再清空日志
+    journal_->attach(superblock_.journal_start, superblock_.journal_blocks);
+    uint32_t replayed = 0;
+    if (!journal_->recover(
+            [this](uint32_t block, const uint8_t* data) { return cache_->write(block, data); },
+            replayed)) {
+        LOG_ERROR(FS, "[FS] Mount failed: unable to read journal");
+        return false;
+    }
+    if (replayed != 0) {
+        if (!cache_->barrier() || !journal_->reset() || !load_superblock()) {
+            LOG_ERROR(FS, "[FS] Mount failed: journal recovery could not be written back");
+            return false;
+        }
+        LOG_WARN(FS, "[FS] Journal recovery replayed " << replayed << " transactions");
+    }
     
     if (!block_mgr_->load_bitmaps()) {
-        std::cerr << "[FS] Mount failed: unable to read bitmaps" << std::endl;
+        LOG_ERROR(FS, "[FS] Mount failed: unable to read bitmaps");
         return false;
     }
     
@@ -131,20 +419,18 @@ bool FileSystem::mount() {
     refresh_space_counters_from_bitmaps();
     if (old_free_blocks != superblock_.free_blocks ||
         old_free_inodes != superblock_.free_inodes) {
-        std::cerr << "[FS] SuperBlock free space mismatch corrected from bitmaps"
-                  << std::endl;
+        LOG_WARN(FS, "[FS] SuperBlock free space mismatch corrected from bitmaps");
         if (!save_superblock()) {
-            std::cerr << "[FS] Mount failed: unable to persist corrected "
-                         "SuperBlock"
-                      << std::endl;
+            LOG_ERROR(FS, "[FS] Mount failed: unable to persist corrected "
+                              "SuperBlock");
             mounted_ = false;
             return false;
         }
     }
     
-    std::cerr << "[FS] Mount successful!" << std::endl;
-    std::cerr << "[FS] Free blocks: " << superblock_.free_blocks 
-              << ", Free inodes: " << superblock_.free_inodes << std::endl;
+    LOG_INFO(FS, "[FS] Mount successful!");
+    LOG_INFO(FS, "[FS] Free blocks: " << superblock_.free_blocks
+                     << ", Free inodes: " << superblock_.free_inodes);
     
     return true;
 }
@@ -154,20 +440,19 @@ bool FileSystem::init_root_directory() {
     Inode root_inode;
     root_inode.type = FileType::DIRECTORY;
     root_inode.size = 2 * DIRENT_SIZE;  // . 和 ..
-    root_inode.blocks_used = 1;
     
     uint32_t root_data_block = block_mgr_->alloc_block();
     if (root_data_block == INVALID_BLOCK) {
         return false;
     }
-    root_inode.direct_blocks[0] = root_data_block;
+    block_map_->append(root_inode, root_data_block, 1);
     
     if (!inode_mgr_->write_inode(ROOT_INODE, root_inode)) {
         return false;
     }
     
-    std::vector<uint8_t> dir_block(BLOCK_SIZE, 0);
-    DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(dir_block.data());
+    BufferCache::Handle dir_block = cache_->get_zeroed(root_data_block);
+    DirectoryEntry* entries = reinterpret_cast<DirectoryEntry*>(dir_block.mutable_metadata());
     const uint32_t num_entries = BLOCK_SIZE / DIRENT_SIZE;
     for (uint32_t i = 0; i < num_entries; ++i) {
         entries[i] = DirectoryEntry{};
@@ -175,49 +460,43 @@ bool FileSystem::init_root_directory() {
     entries[0] = DirectoryEntry(".", ROOT_INODE);
     entries[1] = DirectoryEntry("..", ROOT_INODE);
     
-    if (!disk_->write_block(root_data_block, dir_block.data())) {
-        return false;
-    }
-    
-    std::cerr << "[FS] Root directory created (inode=" << ROOT_INODE 
-              << ", block=" << root_data_block << ")" << std::endl;
+    LOG_INFO(FS, "[FS] Root directory created (inode=" << ROOT_INODE
+                     << ", block=" << root_data_block << ")");
     
     return true;
 }
 
 bool FileSystem::load_superblock() {
-    std::vector<uint8_t> block_data(BLOCK_SIZE);
-    if (!disk_->read_block(SUPERBLOCK_BLOCK, block_data.data())) {
+    BufferCache::Handle block = cache_->get(SUPERBLOCK_BLOCK);
+    if (!block) {
         return false;
     }
-    memcpy(&superblock_, block_data.data(), sizeof(SuperBlock));
+    memcpy(&superblock_, block.data(), sizeof(SuperBlock));
     return true;
 }
 
 bool FileSystem::save_superblock() {
     std::vector<uint8_t> block_data(BLOCK_SIZE);
     memcpy(block_data.data(), &superblock_, sizeof(SuperBlock));
-    return disk_->write_block(SUPERBLOCK_BLOCK, block_data.data());
+    return cache_->write(SUPERBLOCK_BLOCK, block_data.data(), true);
 }
 
 bool FileSystem::create_directory(const std::string& path) {
     if (!mounted_) {
-        std::cerr << "[FS] File system not mounted" << std::endl;
+        LOG_WARN(FS, "[FS] File system not mounted");
         return false;
     }
     
     bool result = dir_mgr_->create_directory(path, current_dir_);
     if (result) {
-        refresh_space_counters_from_bitmaps();
-        save_superblock();
-        block_mgr_->save_bitmaps();
+        metadata_changed();
     }
     return result;
 }
 
 bool FileSystem::list_directory(const std::string& path) {
     if (!mounted_) {
-        std::cerr << "[FS] File system not mounted" << std::endl;
+        LOG_WARN(FS, "[FS] File system not mounted");
         return false;
     }
     return dir_mgr_->list_directory(path, current_dir_);
@@ -225,13 +504,13 @@ bool FileSystem::list_directory(const std::string& path) {
 
 bool FileSystem::change_directory(const std::string& path) {
     if (!mounted_) {
-        std::cerr << "[FS] File system not mounted" << std::endl;
+        LOG_WARN(FS, "[FS] File system not mounted");
         return false;
     }
 
     uint32_t inode_num = dir_mgr_->lookup_path(path, current_dir_);
     if (inode_num == INVALID_INODE) {
-        std::cerr << "[FS] Directory not found: " << path << std::endl;
+        LOG_WARN(FS, "[FS] Directory not found: " << path);
         return false;
     }
     
@@ -241,20 +520,20 @@ bool FileSystem::change_directory(const std::string& path) {
     }
     
     if (inode.type != FileType::DIRECTORY) {
-        std::cerr << "[FS] Not a directory: " << path << std::endl;
+        LOG_WARN(FS, "[FS] Not a directory: " << path);
         return false;
     }
     
     current_dir_ = dir_mgr_->normalize_path(path, current_dir_);
     
-    std::cerr << "[FS] Changed directory to: " << current_dir_ << std::endl;
+    LOG_INFO(FS, "[FS] Changed directory to: " << current_dir_);
     return true;
 }
 
 // 创建文件：分配inode，在父目录中添加目录项
 bool FileSystem::create_file(const std::string& path) {
     if (!mounted_) {
-        std::cerr << "[FS] File system not mounted" << std::endl;
+        LOG_WARN(FS, "[FS] File system not mounted");
         return false;
     }
     
@@ -264,16 +543,16 @@ bool FileSystem::create_file(const std::string& path) {
     
     uint32_t parent_inode = dir_mgr_->lookup_path(parent_path, current_dir_);
     if (parent_inode == INVALID_INODE) {
-        std::cerr << "[FS] Parent directory not found: " << parent_path << std::endl;
+        LOG_WARN(FS, "[FS] Parent directory not found: " << parent_path);
         return false;
     }
     
     if (dir_mgr_->lookup_in_directory(parent_inode, file_name) != INVALID_INODE) {
-        std::cerr << "[FS] File already exists: " << path << std::endl;
+        LOG_WARN(FS, "[FS] File already exists: " << path);
         return false;
     }
     
-    uint32_t new_inode = block_mgr_->alloc_inode();
+    uint32_t new_inode = block_mgr_->alloc_inode(parent_inode);
     if (new_inode == INVALID_INODE) {
         return false;
     }
@@ -290,18 +569,18 @@ bool FileSystem::create_file(const std::string& path) {
         return false;
     }
     
-    refresh_space_counters_from_bitmaps();
-    save_superblock();
-    block_mgr_->save_bitmaps();
+    metadata_changed();
     
-    std::cerr << "[FS] Created file: " << path << " (inode=" << new_inode << ")" << std::endl;
+    trace::record(trace::EventType::FsOp, -1,
+                  static_cast<uint32_t>(trace::FsOpKind::Create), new_inode);
+    LOG_INFO(FS, "[FS] Created file: " << path << " (inode=" << new_inode << ")");
     return true;
 }
 
 // 删除文件：释放所有数据块和inode
 bool FileSystem::remove_file(const std::string& path) {
     if (!mounted_) {
-        std::cerr << "[FS] File system not mounted" << std::endl;
+        LOG_WARN(FS, "[FS] File system not mounted");
         return false;
     }
     
@@ -315,7 +594,7 @@ bool FileSystem::remove_file(const std::string& path) {
     
     uint32_t file_inode = dir_mgr_->lookup_in_directory(parent_inode, file_name);
     if (file_inode == INVALID_INODE) {
-        std::cerr << "[FS] File not found: " << path << std::endl;
+        LOG_WARN(FS, "[FS] File not found: " << path);
         return false;
     }
     
@@ -324,65 +603,79 @@ bool FileSystem::remove_file(const std::string& path) {
         return false;
     }
     
-    for (uint32_t i = 0; i < inode.blocks_used; i++) {
-        block_mgr_->free_block(inode.direct_blocks[i]);
-    }
+    block_map_->release(inode);
+    drop_delayed(file_inode);  // 尚未分配块的数据直接丢弃
     
     block_mgr_->free_inode(file_inode);
     dir_mgr_->remove_directory_entry(parent_inode, file_name);
+    if (inode.type == FileType::DIRECTORY) {
+        dir_mgr_->forget_directory(file_inode);
+    }
     
-    refresh_space_counters_from_bitmaps();
-    save_superblock();
-    block_mgr_->save_bitmaps();
+    metadata_changed();
     
-    std::cerr << "[FS] Removed file: " << path << std::endl;
+    trace::record(trace::EventType::FsOp, -1,
+                  static_cast<uint32_t>(trace::FsOpKind::Remove), file_inode);
+    LOG_INFO(FS, "[FS] Removed file: " << path);
     return true;
 }
 
 int FileSystem::open_file(const std::string& path) {
     if (!mounted_) {
-        std::cerr << "[FS] File system not mounted" << std::endl;
+        LOG_WARN(FS, "[FS] File system not mounted");
         return -1;
     }
     
     uint32_t inode_num = dir_mgr_->lookup_path(path, current_dir_);
     if (inode_num == INVALID_INODE) {
-        std::cerr << "[FS] File not found: " << path << std::endl;
+        LOG_WARN(FS, "[FS] File not found: " << path);
         return -1;
     }
     
-    Inode inode;
-    if (!inode_mgr_->read_inode(inode_num, inode)) {
+    // 打开的文件持有内存 inode 的引用，读写时不再逐次查 inode 表
+    Inode* inode = inode_mgr_->get(inode_num);
+    if (!inode) {
         return -1;
     }
     
-    if (inode.type != FileType::REGULAR) {
-        std::cerr << "[FS] Not a regular file: " << path << std::endl;
+    if (inode->type != FileType::REGULAR) {
+        inode_mgr_->put(inode_num);
+        LOG_WARN(FS, "[FS] Not a regular file: " << path);
         return -1;
     }
     
-    int fd = fd_table_->alloc_fd(inode_num);
-    std::cerr << "[FS] Opened file: " << path << " (fd=" << fd << ")" << std::endl;
+    int fd = fd_table_->alloc_fd(inode_num, inode);
+    trace::record(trace::EventType::FsOp, -1,
+                  static_cast<uint32_t>(trace::FsOpKind::Open), inode_num);
+    LOG_INFO(FS, "[FS] Opened file: " << path << " (fd=" << fd << ")");
     return fd;
 }
 
 void FileSystem::close_file(int fd) {
-    if (fd_table_->free_fd(fd)) {
-        std::cerr << "[FS] Closed file (fd=" << fd << ")" << std::endl;
+    if (OpenFile* file = fd_table_->get_open_file(fd)) {
+        // 关闭时落实该文件的延迟分配
+        if (delalloc_.count(file->inode_num)) {
+            commit();
+        }
+        inode_mgr_->put(file->inode_num);
+        fd_table_->free_fd(fd);
+        trace::record(trace::EventType::FsOp, -1,
+                      static_cast<uint32_t>(trace::FsOpKind::Close),
+                      static_cast<uint64_t>(fd));
+        LOG_INFO(FS, "[FS] Closed file (fd=" << fd << ")");
     }
 }
 
 ssize_t FileSystem::read_file(int fd, void* buffer, size_t size) {
+    metrics::ScopedTimer timer(g_fs_metrics.read_ns);
+    g_fs_metrics.reads.inc();
     OpenFile* file = fd_table_->get_open_file(fd);
     if (!file) {
-        std::cerr << "[FS] Invalid file descriptor: " << fd << std::endl;
+        LOG_WARN(FS, "[FS] Invalid file descriptor: " << fd);
         return -1;
     }
     
-    Inode inode;
-    if (!inode_mgr_->read_inode(file->inode_num, inode)) {
-        return -1;
-    }
+    const Inode& inode = *file->inode;
     
     size_t available = (file->offset < inode.size) ? (inode.size - file->offset) : 0;
     size_t to_read = std::min(size, available);
@@ -391,94 +684,175 @@ ssize_t FileSystem::read_file(int fd, void* buffer, size_t size) {
         return 0;
     }
     
-    size_t bytes_read = 0;
     uint8_t* buf = static_cast<uint8_t*>(buffer);
-    
-    // 按块读取数据
-    while (bytes_read < to_read) {
-        uint32_t block_idx = file->offset / BLOCK_SIZE;
-        uint32_t block_offset = file->offset % BLOCK_SIZE;
-        
-        if (block_idx >= inode.blocks_used) {
-            break;
-        }
-        
-        std::vector<uint8_t> block_data(BLOCK_SIZE);
-        if (!disk_->read_block(inode.direct_blocks[block_idx], block_data.data())) {
-            break;
-        }
-        
-        size_t chunk = std::min(to_read - bytes_read, static_cast<size_t>(BLOCK_SIZE - block_offset));
-        memcpy(buf + bytes_read, block_data.data() + block_offset, chunk);
-        
-        bytes_read += chunk;
-        file->offset += chunk;
+    const auto delayed = delalloc_.find(file->inode_num);
+    const size_t pending = delayed == delalloc_.end() ? 0 : delayed->second.blocks.size();
+    const uint64_t start = file->offset;
+    const uint64_t end = std::min<uint64_t>(
+        start + to_read, static_cast<uint64_t>(inode.blocks_used + pending) * BLOCK_SIZE);
+    if (end <= start) {
+        return 0;
+    }
+
+    // 已分配的块经缓冲缓存取得，未命中的部分合并为一次 read_blocks，
+    // 块号相邻的由后端合并为一次系统调用；尚未分配的块从延迟分配的缓冲中拷贝
+    const uint32_t first_idx = start / BLOCK_SIZE;
+    const uint32_t last_idx = (end - 1) / BLOCK_SIZE;
+    std::vector<uint32_t> blocks;
+    std::vector<BufferCache::Handle> handles;
+    const uint32_t mapped = std::min(last_idx + 1, inode.blocks_used);
+    if ((mapped > first_idx && !block_map_->map(inode, first_idx, mapped - first_idx, blocks)) ||
+        !cache_->get_many(blocks, handles)) {
+        LOG_WARN(FS, "[FS] Read failed (fd=" << fd << ")");
+        return -1;
+    }
+    for (uint32_t idx = first_idx; idx <= last_idx; idx++) {
+        const uint64_t block_start = static_cast<uint64_t>(idx) * BLOCK_SIZE;
+        const uint64_t lo = std::max(start, block_start);
+        const uint64_t hi = std::min(end, block_start + BLOCK_SIZE);
+        const uint8_t* data = idx < inode.blocks_used
+                                  ? handles[idx - first_idx].data()
+                                  : delayed->second.blocks.at(idx).get();
+        memcpy(buf + (lo - start), data + (lo - block_start), hi - lo);
     }
+
+    const size_t bytes_read = end - start;
+    file->offset = end;
+    readahead(*file, inode, start, end);
     
+    g_fs_metrics.read_bytes.inc(bytes_read);
+    trace::record(trace::EventType::FsOp, -1,
+                  static_cast<uint32_t>(trace::FsOpKind::Read), bytes_read);
     return bytes_read;
 }
 
+// 本次读紧接上次结束处即视为顺序读。窗口从 READAHEAD_MIN_BLOCKS 开始，
+// 每当读者追到已预读区间的后半段就补一批并把窗口翻倍；非顺序读关闭预读
+void FileSystem::readahead(OpenFile& file, const Inode& inode, uint64_t start, uint64_t end) {
+    const bool sequential = start == file.ra_prev_end;
+    file.ra_prev_end = end;
+    if (!sequential) {
+        file.ra_window = 0;
+        file.ra_next = 0;
+        return;
+    }
+
+    const uint32_t next_idx = static_cast<uint32_t>((end + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    if (file.ra_window != 0 && file.ra_next > next_idx + file.ra_window / 2) {
+        return;  // 预读余量充足
+    }
+    const size_t max_window =
+        std::min(config::READAHEAD_MAX_BLOCKS, cache_->capacity() / 4);
+    if (max_window == 0) {
+        return;
+    }
+    file.ra_window = static_cast<uint32_t>(
+        file.ra_window == 0 ? std::min(config::READAHEAD_MIN_BLOCKS, max_window)
+                            : std::min<size_t>(file.ra_window * 2, max_window));
+
+    const uint32_t first = std::max(next_idx, file.ra_next);
+    const uint32_t limit = std::min(inode.blocks_used, next_idx + file.ra_window);
+    if (first >= limit) {
+        return;
+    }
+    std::vector<uint32_t> blocks;
+    if (block_map_->map(inode, first, limit - first, blocks)) {
+        cache_->prefetch(blocks);
+    }
+    file.ra_next = limit;
+}
+
 ssize_t FileSystem::write_file(int fd, const void* buffer, size_t size) {
+    metrics::ScopedTimer timer(g_fs_metrics.write_ns);
+    g_fs_metrics.writes.inc();
     OpenFile* file = fd_table_->get_open_file(fd);
     if (!file) {
-        std::cerr << "[FS] Invalid file descriptor: " << fd << std::endl;
+        LOG_WARN(FS, "[FS] Invalid file descriptor: " << fd);
         return -1;
     }
     
-    Inode inode;
-    if (!inode_mgr_->read_inode(file->inode_num, inode)) {
-        return -1;
-    }
+    Inode& inode = *file->inode;
+    DelayedData& delayed = delalloc_[file->inode_num];
     
-    size_t bytes_written = 0;
     const uint8_t* buf = static_cast<const uint8_t*>(buffer);
+    const uint64_t start = file->offset;
+    
+    // 超出已分配块的部分不立即分配，先留在内存中；可用空间扣除其他文件已预留给
+    // 延迟分配的数据块与映射块，保证刷出时一定分配得到
+    const uint32_t used = inode.blocks_used;
+    const uint64_t reserved =
+        delalloc_blocks_ + delalloc_metadata_ - delayed.blocks.size() - delayed.metadata;
+    const uint64_t available =
+        block_mgr_->free_blocks() > reserved ? block_mgr_->free_blocks() - reserved : 0;
+    const uint64_t limit =
+        used + static_cast<uint64_t>(BlockMap::blocks_within(inode, available, MAX_FILE_BLOCKS - used));
+    const uint64_t end = std::min<uint64_t>(start + size, limit * BLOCK_SIZE);
+    if (start + size > MAX_FILE_SIZE) {
+        LOG_WARN(FS, "[FS] File size limit reached");
+    }
     
-    // 按块写入数据，必要时分配新块
-    while (bytes_written < size) {
-        uint32_t block_idx = file->offset / BLOCK_SIZE;
-        uint32_t block_offset = file->offset % BLOCK_SIZE;
-        
-        // 需要新块时分配
-        if (block_idx >= inode.blocks_used) {
-            if (block_idx >= DIRECT_BLOCKS) {
-                std::cerr << "[FS] File size limit reached" << std::endl;
-                break;
+    size_t bytes_written = 0;
+    if (end > start) {
+        // 已分配的块：整块直接拷入缓存，首尾不完整的块在缓存中合并，写盘推迟到
+        // barrier/sync 或淘汰时。未分配的块：拷入按块索引组织的延迟缓冲（新块清零）
+        const uint32_t first_idx = start / BLOCK_SIZE;
+        const uint32_t last_idx = (end - 1) / BLOCK_SIZE;
+        std::vector<uint32_t> blocks;
+        const uint32_t mapped = std::min(last_idx + 1, used);
+        if (mapped > first_idx && !block_map_->map(inode, first_idx, mapped - first_idx, blocks)) {
+            LOG_WARN(FS, "[FS] Write failed (fd=" << fd << ")");
+            return -1;
+        }
+        for (uint32_t idx = first_idx; idx <= last_idx; idx++) {
+            const uint64_t block_start = static_cast<uint64_t>(idx) * BLOCK_SIZE;
+            const uint64_t lo = std::max(start, block_start);
+            const uint64_t hi = std::min(end, block_start + BLOCK_SIZE);
+            if (idx >= used) {
+                auto& data = delayed.blocks[idx];
+                if (!data) {
+                    data = std::make_unique<uint8_t[]>(BLOCK_SIZE);  // 值初始化为 0
+                    if (delalloc_blocks_++ == 0) {
+                        delalloc_since_ = now_;
+                    }
+                }
+                memcpy(data.get() + (lo - block_start), buf + (lo - start), hi - lo);
+                continue;
             }
-            
-            uint32_t new_block = block_mgr_->alloc_block();
-            if (new_block == INVALID_BLOCK) {
-                break;
+            if (hi - lo == BLOCK_SIZE) {
+                cache_->write(blocks[idx - first_idx], buf + (lo - start));
+                continue;
+            }
+            BufferCache::Handle block = cache_->get(blocks[idx - first_idx]);
+            if (block) {
+                memcpy(block.mutable_data() + (lo - block_start), buf + (lo - start), hi - lo);
             }
-            
-            inode.direct_blocks[block_idx] = new_block;
-            inode.blocks_used++;
-        }
-        
-        std::vector<uint8_t> block_data(BLOCK_SIZE, 0);
-        
-        // 部分块写入时需要先读取原数据
-        if (block_offset != 0 || (size - bytes_written) < BLOCK_SIZE) {
-            disk_->read_block(inode.direct_blocks[block_idx], block_data.data());
         }
         
-        size_t chunk = std::min(size - bytes_written, static_cast<size_t>(BLOCK_SIZE - block_offset));
-        memcpy(block_data.data() + block_offset, buf + bytes_written, chunk);
-        
-        disk_->write_block(inode.direct_blocks[block_idx], block_data.data());
-        
-        bytes_written += chunk;
-        file->offset += chunk;
-        
+        bytes_written = end - start;
+        file->offset = end;
         if (file->offset > inode.size) {
             inode.size = file->offset;
         }
     }
+    const uint32_t metadata =
+        BlockMap::metadata_blocks_for(inode, static_cast<uint32_t>(delayed.blocks.size()));
+    delalloc_metadata_ += metadata - delayed.metadata;
+    delayed.metadata = metadata;
+    if (delayed.blocks.empty()) {
+        delalloc_.erase(file->inode_num);
+    }
+    g_fs_metrics.delalloc_pending.set(static_cast<int64_t>(delalloc_blocks_));
     
-    inode_mgr_->write_inode(file->inode_num, inode);
-    refresh_space_counters_from_bitmaps();
-    save_superblock();
-    block_mgr_->save_bitmaps();
+    // 元数据只在刷出时写一次：这里仅标记 inode 为脏。
+    // 延迟的数据过多（内存压力）时立即刷出
+    inode_mgr_->mark_dirty(file->inode_num);
+    if (delalloc_blocks_ >= config::DELALLOC_MAX_BLOCKS) {
+        commit();
+    }
     
+    g_fs_metrics.write_bytes.inc(bytes_written);
+    trace::record(trace::EventType::FsOp, -1,
+                  static_cast<uint32_t>(trace::FsOpKind::Write), bytes_written);
     return bytes_written;
 }
 
@@ -490,6 +864,20 @@ void FileSystem::print_superblock() const {
     std::cerr << "Free blocks: " << superblock_.free_blocks << std::endl;
     std::cerr << "Free inodes: " << superblock_.free_inodes << std::endl;
     std::cerr << "Data blocks start: " << superblock_.data_blocks_start << std::endl;
+    std::cerr << "Inode table: " << superblock_.inode_table_start << " (+"
+              << superblock_.inode_table_blocks << "), data bitmap blocks: "
+              << superblock_.data_bitmap_blocks << std::endl;
+    std::cerr << "Journal: " << superblock_.journal_start << " (+"
+              << superblock_.journal_blocks << ")" << std::endl;
+    std::cerr << "Disk: " << superblock_.disk_blocks << " x " << superblock_.block_size
+              << " B, swap " << superblock_.swap_blocks << " blocks" << std::endl;
+    if (superblock_.group_count != 0) {
+        std::cerr << "Groups: " << superblock_.group_count << " x " << superblock_.blocks_per_group
+                  << " blocks, " << superblock_.inodes_per_group << " inodes each" << std::endl;
+    } else {
+        std::cerr << "Groups: 1 (image formatted before block groups)" << std::endl;
+    }
+    block_mgr_->dump(std::cerr);
     std::cerr << "===============================" << std::endl;
 }
 
@@ -503,15 +891,47 @@ void FileSystem::print_inode(uint32_t inode_num) const {
     std::cerr << "Type: " << (inode.type == FileType::DIRECTORY ? "Directory" : "File") << std::endl;
     std::cerr << "Size: " << inode.size << " bytes" << std::endl;
     std::cerr << "Blocks used: " << inode.blocks_used << std::endl;
+    std::cerr << "Group: " << superblock_.group_of_inode(inode_num) << std::endl;
+    if (inode.uses_extents()) {
+        std::cerr << "Extents: " << inode.extent_count << " (";
+        for (uint32_t i = 0; i < inode.extent_count && i < INLINE_EXTENTS; i++) {
+            std::cerr << (i ? " " : "") << inode.extents[i].start << "+" << inode.extents[i].length;
+        }
+        std::cerr << (inode.extent_count > INLINE_EXTENTS ? " ...)" : ")") << std::endl;
+        std::cerr << "===============================" << std::endl;
+        return;
+    }
     std::cerr << "Direct blocks: ";
     for (uint32_t i = 0; i < inode.blocks_used && i < DIRECT_BLOCKS; i++) {
         std::cerr << inode.direct_blocks[i] << " ";
     }
     std::cerr << std::endl;
+    if (inode.blocks_used > DIRECT_BLOCKS) {
+        std::cerr << "Indirect block: " << inode.indirect_block << std::endl;
+    }
+    if (inode.blocks_used > DIRECT_BLOCKS + PTRS_PER_BLOCK) {
+        std::cerr << "Double indirect block: " << inode.double_indirect_block << std::endl;
+    }
     std::cerr << "===============================" << std::endl;
 }
 
+bool FileSystem::stat_file(const std::string& path) {
+    if (!mounted_) {
+        LOG_WARN(FS, "[FS] File system not mounted");
+        return false;
+    }
+    const uint32_t inode_num = dir_mgr_->lookup_path(path, current_dir_);
+    if (inode_num == INVALID_INODE) {
+        LOG_WARN(FS, "[FS] File not found: " << path);
+        return false;
+    }
+    print_inode(inode_num);
+    return true;
+}
+
 void FileSystem::refresh_space_counters_from_bitmaps() {
     superblock_.free_inodes = block_mgr_->free_inodes();
     superblock_.free_blocks = block_mgr_->free_blocks();
+    g_fs_metrics.free_inodes.set(superblock_.free_inodes);
+    g_fs_metrics.free_blocks.set(superblock_.free_blocks);
 }
@@ -1,38 +1,157 @@
 #include "fs/inode_manager.h"
+#include "common/log.h"
+#include "common/metrics.h"
 #include <cstring>
+#include <map>
 #include <vector>
 
-InodeManager::InodeManager(DiskDevice* disk) : disk_(disk) {}
+namespace {
+struct InodeCacheMetrics {
+    metrics::Counter& hits = metrics::registry().counter(
+        "fs_icache_hits_total", "Inode lookups served from the in-core inode table");
+    metrics::Counter& misses = metrics::registry().counter(
+        "fs_icache_misses_total", "Inode lookups that loaded the inode-table block");
+    metrics::Counter& writebacks = metrics::registry().counter(
+        "fs_icache_writebacks_total", "Dirty inodes written back to the inode table");
+    metrics::Counter& block_updates = metrics::registry().counter(
+        "fs_icache_block_updates_total", "Inode-table block updates issued by inode flushes");
+    metrics::Gauge& cached = metrics::registry().gauge(
+        "fs_icache_inodes", "Inodes currently held in the in-core inode table");
+};
+InodeCacheMetrics g_icache_metrics;
+}
+
+InodeManager::InodeManager(BufferCache* cache, const SuperBlock* sb, size_t capacity)
+    : cache_(cache), sb_(sb), capacity_(capacity) {}
+
+// inode 表按块组分片，组内编号连续；每组 inode 数是 INODES_PER_BLOCK 的倍数
+uint32_t InodeManager::block_of(uint32_t inode_num) const {
+    const GroupLayout group = sb_->group(sb_->group_of_inode(inode_num));
+    return group.inode_table + (inode_num - group.first_inode) / INODES_PER_BLOCK;
+}
+
+InodeManager::CachedInode* InodeManager::lookup(uint32_t inode_num) {
+    auto it = table_.find(inode_num);
+    if (it != table_.end()) {
+        g_icache_metrics.hits.inc();
+        return &it->second;
+    }
+
+    g_icache_metrics.misses.inc();
+    BufferCache::Handle block = cache_->get(block_of(inode_num));
+    if (!block) {
+        return nullptr;
+    }
+    make_room();
+    CachedInode& entry = table_[inode_num];
+    const uint32_t offset = (inode_num % INODES_PER_BLOCK) * sizeof(Inode);
+    memcpy(&entry.inode, block.data() + offset, sizeof(Inode));
+    g_icache_metrics.cached.set(static_cast<int64_t>(table_.size()));
+    return &entry;
+}
+
+// 满时先丢弃未被引用的干净项；仍然不够则写回脏项后再丢弃。
+// 全部被引用时暂时超出容量
+void InodeManager::make_room() {
+    if (table_.size() < capacity_) {
+        return;
+    }
+    for (int pass = 0; pass < 2 && table_.size() >= capacity_; ++pass) {
+        if (pass == 1 && !flush()) {
+            return;
+        }
+        for (auto it = table_.begin(); it != table_.end() && table_.size() >= capacity_;) {
+            if (it->second.refs == 0 && !it->second.dirty) {
+                it = table_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    g_icache_metrics.cached.set(static_cast<int64_t>(table_.size()));
+}
 
 bool InodeManager::read_inode(uint32_t inode_num, Inode& out_inode) {
-    uint32_t inodes_per_block = BLOCK_SIZE / sizeof(Inode);
-    uint32_t block_num = INODE_TABLE_START + inode_num / inodes_per_block;
-    uint32_t offset = (inode_num % inodes_per_block) * sizeof(Inode);
-    
-    std::vector<uint8_t> block_data(BLOCK_SIZE);
-    if (!disk_->read_block(block_num, block_data.data())) {
+    CachedInode* entry = lookup(inode_num);
+    if (!entry) {
         return false;
     }
-    
-    memcpy(&out_inode, block_data.data() + offset, sizeof(Inode));
+    out_inode = entry->inode;
     return true;
 }
 
+// 整个 inode 被覆盖，未缓存时也无需先读入所在的 inode 表块
 bool InodeManager::write_inode(uint32_t inode_num, const Inode& inode) {
-    uint32_t inodes_per_block = BLOCK_SIZE / sizeof(Inode);
-    uint32_t block_num = INODE_TABLE_START + inode_num / inodes_per_block;
-    uint32_t offset = (inode_num % inodes_per_block) * sizeof(Inode);
-    
-    std::vector<uint8_t> block_data(BLOCK_SIZE);
-    if (!disk_->read_block(block_num, block_data.data())) {
-        return false;
-    }
-    
-    memcpy(block_data.data() + offset, &inode, sizeof(Inode));
-    
-    if (!disk_->write_block(block_num, block_data.data())) {
-        return false;
+    auto it = table_.find(inode_num);
+    if (it == table_.end()) {
+        make_room();
+        it = table_.emplace(inode_num, CachedInode{}).first;
+        g_icache_metrics.cached.set(static_cast<int64_t>(table_.size()));
     }
-    
+    it->second.inode = inode;
+    it->second.dirty = true;
     return true;
 }
+
+Inode* InodeManager::get(uint32_t inode_num) {
+    CachedInode* entry = lookup(inode_num);
+    if (!entry) {
+        return nullptr;
+    }
+    ++entry->refs;
+    return &entry->inode;
+}
+
+void InodeManager::put(uint32_t inode_num) {
+    auto it = table_.find(inode_num);
+    if (it != table_.end() && it->second.refs > 0) {
+        --it->second.refs;
+    }
+}
+
+void InodeManager::mark_dirty(uint32_t inode_num) {
+    auto it = table_.find(inode_num);
+    if (it != table_.end()) {
+        it->second.dirty = true;
+    }
+}
+
+bool InodeManager::flush() {
+    std::map<uint32_t, std::vector<std::pair<uint32_t, CachedInode*>>> by_block;
+    for (auto& [num, entry] : table_) {
+        if (entry.dirty) {
+            by_block[block_of(num)].push_back({num, &entry});
+        }
+    }
+
+    bool ok = true;
+    for (auto& [block_num, inodes] : by_block) {
+        BufferCache::Handle block = cache_->get(block_num);
+        if (!block) {
+            LOG_ERROR(FS, "[FS] Inode write-back failed for inode-table block " << block_num);
+            ok = false;
+            continue;
+        }
+        uint8_t* data = block.mutable_metadata();
+        for (auto& [num, entry] : inodes) {
+            const uint32_t offset = (num % INODES_PER_BLOCK) * sizeof(Inode);
+            memcpy(data + offset, &entry->inode, sizeof(Inode));
+            entry->dirty = false;
+        }
+        g_icache_metrics.writebacks.inc(inodes.size());
+        g_icache_metrics.block_updates.inc();
+    }
+    return ok;
+}
+
+void InodeManager::invalidate() {
+    for (auto it = table_.begin(); it != table_.end();) {
+        if (it->second.refs == 0) {
+            it = table_.erase(it);
+        } else {
+            it->second.dirty = false;
+            ++it;
+        }
+    }
+    g_icache_metrics.cached.set(static_cast<int64_t>(table_.size()));
+}
@@ -0,0 +1,222 @@
+#include "fs/journal.h"
+#include "common/log.h"
+#include "common/metrics.h"
+#include <memory>
+
+namespace {
+constexpr uint32_t JOURNAL_MAGIC = 0x4A524E4C;  // "JRNL"
+
+enum class RecordType : uint32_t {
+    Header = 1,
+    Descriptor = 2,
+    Commit = 3,
+};
+
+// 日志头、描述块、提交块共用的块格式
+struct JournalRecord {
+    uint32_t magic;
+    RecordType type;
+    uint32_t sequence;
+    uint32_t count;     // 描述块/提交块：事务中的元数据块数
+    uint32_t checksum;  // 提交块：块号与块内容的校验和
+    uint32_t blocks[(BLOCK_SIZE - 20) / sizeof(uint32_t)];  // 描述块：原位置块号
+};
+static_assert(sizeof(JournalRecord) <= BLOCK_SIZE, "JournalRecord must fit in a block");
+
+// FNV-1a
+uint32_t checksum_of(const std::vector<BlockWrite>& blocks) {
+    uint32_t h = 2166136261u;
+    auto mix = [&h](const uint8_t* p, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            h = (h ^ p[i]) * 16777619u;
+        }
+    };
+    for (const BlockWrite& w : blocks) {
+        const uint32_t block = static_cast<uint32_t>(w.block_id);
+        mix(reinterpret_cast<const uint8_t*>(&block), sizeof(block));
+        mix(w.data, BLOCK_SIZE);
+    }
+    return h;
+}
+
+struct JournalMetrics {
+    metrics::Counter& transactions = metrics::registry().counter(
+        "fs_journal_transactions_total", "Metadata transactions committed to the journal");
+    metrics::Counter& blocks = metrics::registry().counter(
+        "fs_journal_blocks_total", "Metadata blocks written to the journal");
+    metrics::Counter& checkpoints = metrics::registry().counter(
+        "fs_journal_checkpoints_total", "Journal checkpoints (logged blocks written in place)");
+    metrics::Counter& replayed = metrics::registry().counter(
+        "fs_journal_replayed_transactions_total", "Transactions replayed from the journal at mount");
+};
+JournalMetrics g_journal_metrics;
+}
+
+void Journal::attach(uint32_t start, uint32_t blocks) {
+    start_ = start;
+    blocks_ = blocks;
+    head_ = 1;
+    live_.clear();
+}
+
+bool Journal::write_header() {
+    auto block = std::make_unique<uint8_t[]>(BLOCK_SIZE);  // 值初始化为 0
+    auto* rec = reinterpret_cast<JournalRecord*>(block.get());
+    rec->magic = JOURNAL_MAGIC;
+    rec->type = RecordType::Header;
+    rec->sequence = sequence_;
+    return disk_->write_block(start_, block.get());
+}
+
+// 日志头之后的整个日志区清零。旧文件系统残留的事务序号与校验和仍然有效，
+// 序号从 1 重新开始时，新事务的末尾可能正好接上一个序号相符的旧事务而被一并重放
+bool Journal::wipe() {
+    const auto zero = std::make_unique<uint8_t[]>(BLOCK_SIZE);
+    std::vector<BlockWrite> ios;
+    ios.reserve(blocks_ - 1);
+    for (uint32_t i = 1; i < blocks_; ++i) {
+        ios.push_back({start_ + i, zero.get()});
+    }
+    return disk_->write_blocks(ios);
+}
+
+bool Journal::format() {
+    if (!enabled()) {
+        return true;
+    }
+    attach(start_, blocks_);
+    sequence_ = 1;
+    return wipe() && write_header() && disk_->barrier();
+}
+
+bool Journal::recover(const std::function<bool(uint32_t, const uint8_t*)>& apply,
+                      uint32_t& replayed) {
+    replayed = 0;
+    if (!enabled()) {
+        return true;
+    }
+    auto rec_buf = std::make_unique<uint8_t[]>(BLOCK_SIZE);
+    auto* rec = reinterpret_cast<JournalRecord*>(rec_buf.get());
+    if (!disk_->read_block(start_, rec_buf.get())) {
+        return false;
+    }
+    if (rec->magic != JOURNAL_MAGIC || rec->type != RecordType::Header) {
+        LOG_WARN(FS, "[FS] Journal header invalid, starting with an empty journal");
+        sequence_ = 1;
+        head_ = 1;
+        return wipe() && write_header() && disk_->barrier();
+    }
+    sequence_ = rec->sequence;
+
+    uint32_t pos = 1;
+    std::vector<uint32_t> targets;
+    std::vector<uint8_t> data;
+    while (pos + 2 <= blocks_) {
+        if (!disk_->read_block(start_ + pos, rec_buf.get())) {
+            return false;
+        }
+        if (rec->magic != JOURNAL_MAGIC || rec->type != RecordType::Descriptor ||
+            rec->sequence != sequence_ || rec->count == 0 || pos + rec->count + 2 > blocks_) {
+            break;
+        }
+        const uint32_t count = rec->count;
+        targets.assign(rec->blocks, rec->blocks + count);
+        data.resize(static_cast<size_t>(count) * BLOCK_SIZE);
+        if (!disk_->read_blocks(start_ + pos + 1, count, data.data()) ||
+            !disk_->read_block(start_ + pos + 1 + count, rec_buf.get())) {
+            return false;
+        }
+        std::vector<BlockWrite> ios;
+        for (uint32_t i = 0; i < count; ++i) {
+            ios.push_back({targets[i], data.data() + static_cast<size_t>(i) * BLOCK_SIZE});
+        }
+        // 没有完整提交块的事务（写到一半掉电）不重放
+        if (rec->magic != JOURNAL_MAGIC || rec->type != RecordType::Commit ||
+            rec->sequence != sequence_ || rec->count != count || rec->checksum != checksum_of(ios)) {
+            break;
+        }
+        for (const BlockWrite& w : ios) {
+            if (!apply(static_cast<uint32_t>(w.block_id), w.data)) {
+                return false;
+            }
+        }
+        LOG_INFO(FS, "[FS] Journal: replayed transaction " << sequence_ << " (" << count
+                         << " blocks)");
+        ++replayed;
+        ++sequence_;
+        ++stats_.replayed_transactions;
+        stats_.replayed_blocks += count;
+        g_journal_metrics.replayed.inc();
+        pos += count + 2;
+    }
+    return true;
+}
+
+bool Journal::log(const std::vector<BlockWrite>& blocks) {
+    const uint32_t count = static_cast<uint32_t>(blocks.size());
+    auto desc_buf = std::make_unique<uint8_t[]>(BLOCK_SIZE);
+    auto commit_buf = std::make_unique<uint8_t[]>(BLOCK_SIZE);
+    auto* desc = reinterpret_cast<JournalRecord*>(desc_buf.get());
+    auto* commit = reinterpret_cast<JournalRecord*>(commit_buf.get());
+    desc->magic = commit->magic = JOURNAL_MAGIC;
+    desc->type = RecordType::Descriptor;
+    commit->type = RecordType::Commit;
+    desc->sequence = commit->sequence = sequence_;
+    desc->count = commit->count = count;
+    commit->checksum = checksum_of(blocks);
+
+    // 描述块、元数据块、提交块在日志区内连续，由磁盘合并为一次顺序写
+    std::vector<BlockWrite> ios;
+    ios.reserve(count + 2);
+    ios.push_back({start_ + head_, desc_buf.get()});
+    for (uint32_t i = 0; i < count; ++i) {
+        desc->blocks[i] = static_cast<uint32_t>(blocks[i].block_id);
+        ios.push_back({start_ + head_ + 1 + i, blocks[i].data});
+    }
+    ios.push_back({start_ + head_ + 1 + count, commit_buf.get()});
+    // 事务必须先于原地写回到达镜像
+    if (!disk_->write_blocks(ios) || !disk_->barrier()) {
+        LOG_ERROR(FS, "[FS] Journal write failed for transaction " << sequence_);
+        return false;
+    }
+    for (const BlockWrite& w : blocks) {
+        live_.insert(static_cast<uint32_t>(w.block_id));
+    }
+    head_ += count + 2;
+    ++sequence_;
+    ++stats_.transactions;
+    stats_.blocks += count;
+    g_journal_metrics.transactions.inc();
+    g_journal_metrics.blocks.inc(count);
+    return true;
+}
+
+// 先让原地写回到达镜像，再推进日志头；两次 barrier 之间掉电时重放旧事务无害
+bool Journal::reset() {
+    if (!enabled()) {
+        return true;
+    }
+    if (!disk_->barrier() || !write_header() || !disk_->barrier()) {
+        LOG_ERROR(FS, "[FS] Journal checkpoint failed");
+        return false;
+    }
+    head_ = 1;
+    live_.clear();
+    ++stats_.checkpoints;
+    g_journal_metrics.checkpoints.inc();
+    return true;
+}
+
+void Journal::dump(std::ostream& os) const {
+    os << "=== Journal ===\n";
+    if (!enabled()) {
+        os << "disabled (image formatted without a journal)\n";
+        return;
+    }
+    os << "region: " << start_ << " (+" << blocks_ << "), used: " << head_ - 1
+       << " blocks, next sequence: " << sequence_ << "\n"
+       << "transactions: " << stats_.transactions << "  logged blocks: " << stats_.blocks
+       << "  checkpoints: " << stats_.checkpoints << "\n"
+       << "replayed at mount: " << stats_.replayed_transactions << " transactions, "
+       << stats_.replayed_blocks << " blocks\n";
+}
@@ -1,10 +1,52 @@
 #include "kernel.h"
-#include <iostream>
+#include "common/log.h"
+#include <fstream>
+#include <stdexcept>
+#include <string>
 
-Kernel::Kernel() : disk_(), dev_mgr_(), fs_(&disk_), mm_(disk_), pm_(mm_, dev_mgr_, fs_) {
+namespace {
+// 已有镜像的超级块记录了格式化时的几何：未显式指定的参数沿用它，显式指定且不一致时拒绝启动。
+// 否则镜像会按新几何扩展，挂载因布局不符失败后被自动格式化，已有数据随之丢失
+DiskGeometry resolve_geometry(DiskBackendKind backend, DiskGeometry requested) {
+    if (backend == DiskBackendKind::Ram) {
+        return requested;
+    }
+    std::ifstream image(config::DISK_IMAGE_NAME, std::ios::binary);
+    SuperBlock sb;
+    if (!image.read(reinterpret_cast<char*>(&sb), sizeof(sb)) || sb.magic != FS_MAGIC) {
+        return requested;
+    }
+    // 旧版镜像没有记录几何，按默认几何解释（与 mount 一致）
+    if (sb.block_size == 0) {
+        sb.block_size = BLOCK_SIZE;
+        sb.disk_blocks = static_cast<uint32_t>(config::DISK_NUM_BLOCKS);
+        sb.swap_blocks = static_cast<uint32_t>(config::SWAP_RESERVED_BLOCKS);
+    }
+    auto adopt = [](const char* flag, size_t& value, uint32_t recorded) {
+        if (value != 0 && value != recorded) {
+            throw std::runtime_error(std::string("Disk geometry error: ") + config::DISK_IMAGE_NAME +
+                                     " was formatted with " + flag + std::to_string(recorded) +
+                                     ", requested " + flag + std::to_string(value) +
+                                     " (remove the image to start over)");
+        }
+        value = recorded;
+    };
+    adopt("--disk-blocks=", requested.num_blocks, sb.disk_blocks);
+    adopt("--swap-blocks=", requested.swap_blocks, sb.swap_blocks);
+    adopt("block size ", requested.block_size, sb.block_size);
+    return requested;
+}
+}
+
+Kernel::Kernel(DiskBackendKind disk_backend, DiskGeometry disk_geometry)
+    : disk_(config::DISK_IMAGE_NAME, disk_backend, resolve_geometry(disk_backend, disk_geometry)),
+      dev_mgr_(),
+      fs_(&disk_),
+      mm_(disk_),
+      pm_(mm_, dev_mgr_, fs_) {
     // 自动挂载文件系统，如果失败则格式化
     if (!fs_.mount()) {
-        std::cerr << "[Kernel] File system not found, formatting..." << std::endl;
+        LOG_INFO(Kernel, "[Kernel] File system not found, formatting...");
         fs_.format();
     }
 }
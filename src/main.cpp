@@ -1,9 +1,153 @@
 #include "kernel.h"
 #include "shell/shell.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 
-int main() {
-    Kernel kernel; 
-    Shell shell(kernel);
-    shell.run();
+namespace {
+constexpr const char* kUsage =
+    "Usage: tinix [--disk-backend=stream|mmap|pread|direct|ram|ram-persist] "
+    "[--io-engine=auto|uring|pool|sync] [--io-queue-depth=N]\n"
+    "             [--disk-blocks=N] [--swap-blocks=N]\n"
+    "             [--disk-sched=fcfs|sstf|scan|clook] [--disk-timing=key=value,...]\n"
+    "             [--buffer-cache=N] [--commit-ops=N] [--commit-ticks=N]\n";
+
+bool parse_count(const std::string& s, size_t& out) {
+    if (s.empty()) {
+        return true;
+    }
+    char* end = nullptr;
+    const unsigned long long v = std::strtoull(s.c_str(), &end, 10);
+    if (*end != '\0' || v == 0 || v > UINT32_MAX) {
+        return false;
+    }
+    out = static_cast<size_t>(v);
+    return true;
+}
+}
+
+int main(int argc, char** argv) {
+    // 命令行参数优先，其次环境变量：
+    //   --disk-backend=<stream|mmap|pread|direct|ram|ram-persist>  TINIX_DISK_BACKEND
+    //   --io-engine=<auto|uring|pool|sync>                         TINIX_IO_ENGINE
+    //   --io-queue-depth=<N>                                       TINIX_IO_QUEUE_DEPTH
+    //   --disk-blocks=<N>     TINIX_DISK_BLOCKS（默认沿用已有镜像大小）
+    //   --swap-blocks=<N>     TINIX_SWAP_BLOCKS（默认沿用镜像中记录的值）
+    //   --disk-sched=<fcfs|sstf|scan|clook>                        TINIX_DISK_SCHED
+    //   --disk-timing=settle=,track=,rotation=,transfer=,bpt=      TINIX_DISK_TIMING
+    //     两者任一给出即启用模拟磁盘时序（只给时序参数时策略为 fcfs）
+    //   --buffer-cache=<N>    TINIX_BUFFER_CACHE（文件系统缓冲缓存的块数）
+    //   --commit-ops=<N>      TINIX_COMMIT_OPS（累计多少个元数据操作提交一次，1 为逐操作提交）
+    //   --commit-ticks=<N>    TINIX_COMMIT_TICKS（未提交的元数据最多停留的 tick 数）
+    struct Option {
+        const char* flag;
+        const char* env;
+        std::string value;
+    };
+    Option options[] = {
+        {"--disk-backend=", "TINIX_DISK_BACKEND", {}},
+        {"--io-engine=", "TINIX_IO_ENGINE", {}},
+        {"--io-queue-depth=", "TINIX_IO_QUEUE_DEPTH", {}},
+        {"--disk-blocks=", "TINIX_DISK_BLOCKS", {}},
+        {"--swap-blocks=", "TINIX_SWAP_BLOCKS", {}},
+        {"--disk-sched=", "TINIX_DISK_SCHED", {}},
+        {"--disk-timing=", "TINIX_DISK_TIMING", {}},
+        {"--buffer-cache=", "TINIX_BUFFER_CACHE", {}},
+        {"--commit-ops=", "TINIX_COMMIT_OPS", {}},
+        {"--commit-ticks=", "TINIX_COMMIT_TICKS", {}},
+    };
+    auto& [backend_opt, engine_opt, depth_opt, blocks_opt, swap_opt, sched_opt, timing_opt,
+           cache_opt, commit_ops_opt, commit_ticks_opt] = options;
+    for (auto& opt : options) {
+        if (const char* env = std::getenv(opt.env)) {
+            opt.value = env;
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        bool matched = false;
+        for (auto& opt : options) {
+            const std::string key = opt.flag;
+            if (arg.rfind(key, 0) == 0) {
+                opt.value = arg.substr(key.size());
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            std::cerr << kUsage;
+            return 2;
+        }
+    }
+
+    DiskBackendKind backend = DiskBackendKind::Stream;
+    if (!backend_opt.value.empty() && !parse_disk_backend(backend_opt.value, backend)) {
+        std::cerr << "Unknown disk backend: " << backend_opt.value << "\n";
+        return 2;
+    }
+    AsyncEngineKind engine = AsyncEngineKind::Auto;
+    if (!engine_opt.value.empty() && !parse_async_engine(engine_opt.value, engine)) {
+        std::cerr << "Unknown I/O engine: " << engine_opt.value << "\n";
+        return 2;
+    }
+    size_t depth = config::DISK_IO_QUEUE_DEPTH;
+    if (!parse_count(depth_opt.value, depth)) {
+        std::cerr << "Invalid I/O queue depth: " << depth_opt.value << "\n";
+        return 2;
+    }
+    DiskGeometry geometry;
+    if (!parse_count(blocks_opt.value, geometry.num_blocks)) {
+        std::cerr << "Invalid disk block count: " << blocks_opt.value << "\n";
+        return 2;
+    }
+    if (!parse_count(swap_opt.value, geometry.swap_blocks)) {
+        std::cerr << "Invalid swap block count: " << swap_opt.value << "\n";
+        return 2;
+    }
+
+    DiskSchedPolicy sched = DiskSchedPolicy::Fcfs;
+    if (!sched_opt.value.empty() && !parse_disk_sched_policy(sched_opt.value, sched)) {
+        std::cerr << "Unknown disk scheduling policy: " << sched_opt.value << "\n";
+        return 2;
+    }
+    DiskTiming timing;
+    if (!timing_opt.value.empty() && !parse_disk_timing(timing_opt.value, timing)) {
+        std::cerr << "Invalid disk timing: " << timing_opt.value << "\n";
+        return 2;
+    }
+    size_t cache_blocks = config::BUFFER_CACHE_BLOCKS;
+    if (!parse_count(cache_opt.value, cache_blocks)) {
+        std::cerr << "Invalid buffer cache size: " << cache_opt.value << "\n";
+        return 2;
+    }
+    size_t commit_ops = config::METADATA_COMMIT_OPS;
+    if (!parse_count(commit_ops_opt.value, commit_ops)) {
+        std::cerr << "Invalid commit op count: " << commit_ops_opt.value << "\n";
+        return 2;
+    }
+    size_t commit_ticks = config::METADATA_COMMIT_TICKS;
+    if (!parse_count(commit_ticks_opt.value, commit_ticks)) {
+        std::cerr << "Invalid commit tick interval: " << commit_ticks_opt.value << "\n";
+        return 2;
+    }
+
+    try {
+        Kernel kernel(backend, geometry);
+        kernel.get_disk_device().configure_async(engine, depth);
+        if (!cache_opt.value.empty()) {
+            kernel.get_file_system().buffer_cache().set_capacity(cache_blocks);
+        }
+        kernel.get_file_system().set_commit_interval(commit_ops, commit_ticks);
+        if (!sched_opt.value.empty() || !timing_opt.value.empty()) {
+            kernel.enable_disk_timing(sched, timing);
+        }
+        Shell shell(kernel);
+        shell.run();
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
     return 0;
 }
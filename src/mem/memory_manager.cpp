@@ -1,8 +1,32 @@
 #include "mem/memory_manager.h"
+#include "common/event_trace.h"
+#include "common/log.h"
+#include "common/metrics.h"
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <stdexcept>
 
+namespace {
+struct MemMetrics {
+    metrics::Counter& accesses = metrics::registry().counter(
+        "mem_accesses_total", "Virtual memory accesses");
+    metrics::Counter& invalid = metrics::registry().counter(
+        "mem_invalid_accesses_total", "Accesses outside the process address space");
+    metrics::Counter& faults = metrics::registry().counter(
+        "mem_page_faults_total", "Page faults");
+    metrics::Counter& evictions = metrics::registry().counter(
+        "mem_evictions_total", "Frames reclaimed by the Clock algorithm");
+    metrics::Counter& swap_ins = metrics::registry().counter(
+        "mem_swap_ins_total", "Pages read back from swap");
+    metrics::Counter& swap_outs = metrics::registry().counter(
+        "mem_swap_outs_total", "Dirty pages written to swap");
+    metrics::Histogram& fault_ns = metrics::registry().histogram(
+        "mem_page_fault_latency_ns", "Page fault handling latency in nanoseconds");
+};
+MemMetrics g_mem_metrics;
+}
+
 MemoryManager::MemoryManager(DiskDevice& disk)
     : physical_memory_(), disk_(disk) {}
 
@@ -11,8 +35,8 @@ void MemoryManager::create_process_memory(int pid, size_t num_pages) {
     page_tables_[pid] = std::make_unique<PageTable>(num_pages);
     process_stats_[pid] = MemoryStats{};
 
-    std::cerr << "[Memory] Created page table for PID " << pid << " ("
-              << num_pages << " pages)" << std::endl;
+    LOG_INFO(Memory, "[Memory] Created page table for PID " << pid << " ("
+                         << num_pages << " pages)");
 }
 
 // 释放进程的所有内存（页表和物理页框）
@@ -36,7 +60,7 @@ void MemoryManager::free_process_memory(int pid) {
     page_tables_.erase(it);
     process_stats_.erase(pid);
 
-    std::cerr << "[Memory] Freed memory for PID " << pid << std::endl;
+    LOG_INFO(Memory, "[Memory] Freed memory for PID " << pid);
 }
 
 bool MemoryManager::access_memory(int pid,
@@ -54,12 +78,14 @@ bool MemoryManager::access_memory(int pid,
 
     PageTable* pt = it->second.get();
     if (page_number >= pt->size()) {
-        std::cerr << "[Memory] Invalid address: page " << page_number
-                  << " out of range" << std::endl;
+        g_mem_metrics.invalid.inc();
+        LOG_WARN(Memory, "[Memory] Invalid address: page " << page_number
+                             << " out of range");
         return false;
     }
 
     stats_.memory_accesses++;
+    g_mem_metrics.accesses.inc();
     process_stats_[pid].memory_accesses++;
 
     auto& entry = (*pt)[page_number];
@@ -67,11 +93,12 @@ bool MemoryManager::access_memory(int pid,
     // 缺页
     if (!entry.present) {
         stats_.page_faults++;
+        g_mem_metrics.faults.inc();
         process_stats_[pid].page_faults++;
 
-        std::cerr << "[PageFault] PID=" << pid << ", VPage=" << page_number
-                  << ", VAddr=0x" << std::hex << virtual_addr << std::dec
-                  << std::endl;
+        LOG_INFO(Memory, "[PageFault] PID=" << pid << ", VPage=" << page_number
+                             << ", VAddr=0x" << std::hex << virtual_addr
+                             << std::dec);
 
         // 处理缺页
         if (!handle_page_fault(pid, page_number, type)) {
@@ -87,9 +114,9 @@ bool MemoryManager::access_memory(int pid,
 
     uint64_t physical_addr = (uint64_t)entry.frame_number * page_size_ + offset;
 
-    std::cerr << "[Memory] PID=" << pid << ", VAddr=0x" << std::hex
-              << virtual_addr << " -> PAddr=0x" << physical_addr << std::dec
-              << ", Frame=" << entry.frame_number << std::endl;
+    LOG_DEBUG(Memory, "[Memory] PID=" << pid << ", VAddr=0x" << std::hex
+                          << virtual_addr << " -> PAddr=0x" << physical_addr
+                          << std::dec << ", Frame=" << entry.frame_number);
 
     return true;
 }
@@ -97,14 +124,21 @@ bool MemoryManager::access_memory(int pid,
 bool MemoryManager::handle_page_fault(int pid,
                                       size_t page_number,
                                       AccessType type) {
+    metrics::ScopedTimer timer(g_mem_metrics.fault_ns);
+    disk_.poll_completions();  // 顺便回收此前异步换出的完成项
     auto& entry = (*page_tables_[pid])[page_number];
+    trace::record(trace::EventType::PageFault, pid,
+                  type == AccessType::Write ? 1 : 0, page_number);
 
     if (entry.on_disk) {
-        std::cerr << "[Swap] Reading PID=" << pid << " VPage=" << page_number
-                  << " from Disk Block " << entry.swap_block << std::endl;
+        g_mem_metrics.swap_ins.inc();
+        trace::record(trace::EventType::SwapIn, pid,
+                      static_cast<uint32_t>(entry.swap_block), page_number);
+        LOG_INFO(Swap, "[Swap] Reading PID=" << pid << " VPage=" << page_number
+                           << " from Disk Block " << entry.swap_block);
 
         // 使用哑数据模拟换入
-        std::vector<uint8_t> dummy_data(page_size_);
+        std::vector<uint8_t> dummy_data(disk_.get_block_size());
         disk_.read_block(entry.swap_block, dummy_data.data());
     }
 
@@ -146,30 +180,41 @@ bool MemoryManager::handle_page_fault(int pid,
                 clock_ptr_ = (clock_ptr_ + 1) % total_frames;
             } else {
                 // 牺牲
-                std::cerr << "[Evict] Replacing Frame " << clock_ptr_
-                          << " from PID=" << victim_pid
-                          << ", VPage=" << victim_vpage << std::endl;
+                g_mem_metrics.evictions.inc();
+                trace::record(trace::EventType::Evict, victim_pid,
+                              static_cast<uint32_t>(clock_ptr_), victim_vpage);
+                LOG_INFO(Memory, "[Evict] Replacing Frame " << clock_ptr_
+                                     << " from PID=" << victim_pid
+                                     << ", VPage=" << victim_vpage);
 
                 if (victim_entry.dirty) {
                     // 脏页写回磁盘（交换出）
                     if (!victim_entry.on_disk) {
-                        if (next_swap_block_ >= config::DISK_NUM_BLOCKS) {
-                            std::cerr << "[Swap] Out of swap blocks" << std::endl;
+                        next_swap_block_ = std::max(next_swap_block_, disk_.swap_start());
+                        if (next_swap_block_ >= disk_.get_num_blocks()) {
+                            LOG_ERROR(Swap, "[Swap] Out of swap blocks");
                             return false;
                         }
                         victim_entry.swap_block = next_swap_block_++;
                         victim_entry.on_disk = true;
                     }
 
-                    std::cerr << "[Swap] Writing PID=" << victim_pid
-                              << " VPage=" << victim_vpage << " to Disk Block "
-                              << victim_entry.swap_block << std::endl;
+                    LOG_INFO(Swap, "[Swap] Writing PID=" << victim_pid
+                                       << " VPage=" << victim_vpage
+                                       << " to Disk Block "
+                                       << victim_entry.swap_block);
+
+                    g_mem_metrics.swap_outs.inc();
+                    trace::record(trace::EventType::SwapOut, victim_pid,
+                                  static_cast<uint32_t>(victim_entry.swap_block),
+                                  victim_vpage);
 
-                    // 使用哑数据模拟写回
-                    std::vector<uint8_t> dummy_data(page_size_,
+                    // 使用哑数据模拟写回；异步提交，与后续模拟重叠，
+                    // 之后换入同一块时 read_block 会先等待它完成
+                    std::vector<uint8_t> dummy_data(disk_.get_block_size(),
                                                     0xAA);  // 0xAA 表示标记数据
-                    disk_.write_block(victim_entry.swap_block,
-                                      dummy_data.data());
+                    disk_.submit_write(victim_entry.swap_block,
+                                       dummy_data.data());
                 }
 
                 victim_entry.clear();
@@ -187,8 +232,8 @@ bool MemoryManager::handle_page_fault(int pid,
     entry.referenced = true;
     entry.dirty = (type == AccessType::Write);
 
-    std::cerr << "[PageFault] Allocated Frame " << frame_number
-              << " for PID=" << pid << ", VPage=" << page_number << std::endl;
+    LOG_INFO(Memory, "[PageFault] Allocated Frame " << frame_number
+                         << " for PID=" << pid << ", VPage=" << page_number);
 
     return true;
 }
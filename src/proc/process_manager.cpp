@@ -4,12 +4,41 @@
 #include <vector>
 #include "proc/program.h"
 #include "common/config.h"
+#include "common/event_trace.h"
+#include "common/log.h"
+#include "common/metrics.h"
 
 namespace {
 constexpr uint64_t kAutoScriptFd = std::numeric_limits<uint64_t>::max();
 constexpr size_t kMaxScriptIoBytes = 1 << 20;  // 1 MiB safety cap
 constexpr char kWriteFillByte = 'x';
 
+struct ProcMetrics {
+    metrics::Counter& ticks = metrics::registry().counter(
+        "proc_ticks_total", "Simulated clock ticks");
+    metrics::Counter& idle_ticks = metrics::registry().counter(
+        "proc_idle_ticks_total", "Ticks with no runnable process");
+    metrics::Counter& instructions = metrics::registry().counter(
+        "proc_instructions_total", "Instructions executed");
+    metrics::Counter& dispatches = metrics::registry().counter(
+        "proc_dispatches_total", "Scheduling decisions that picked a process");
+    metrics::Counter& slice_expirations = metrics::registry().counter(
+        "proc_slice_expirations_total", "Processes preempted at time slice end");
+    metrics::Counter& blocks = metrics::registry().counter(
+        "proc_blocks_total", "Processes blocked during execution");
+    metrics::Counter& wakeups = metrics::registry().counter(
+        "proc_wakeups_total", "Blocked processes made ready again");
+    metrics::Counter& created = metrics::registry().counter(
+        "proc_created_total", "Processes created");
+    metrics::Counter& terminated = metrics::registry().counter(
+        "proc_terminated_total", "Processes completed or killed");
+    metrics::Gauge& live = metrics::registry().gauge(
+        "proc_live", "Processes currently in the process table");
+    metrics::Histogram& tick_ns = metrics::registry().histogram(
+        "proc_tick_latency_ns", "Wall-clock cost of one simulated tick in nanoseconds");
+};
+ProcMetrics g_proc_metrics;
+
 // 把设备转交给“仍在等待”的进程，并唤醒它；无效/不匹配的 pid 会被跳过。
 void wakeup_device_waiter(DeviceManager& device_manager,
                           std::map<int, PCB>& processes,
@@ -33,8 +62,9 @@ void wakeup_device_waiter(DeviceManager& device_manager,
             pcb.blocked_reason = BlockReason::None;
             pcb.waiting_device = UINT32_MAX;
             ready_queue.push(pid);
-            std::cerr << "[Dev] Wakeup pid=" << pid << " for dev=" << dev_id
-                      << "\n";
+            g_proc_metrics.wakeups.inc();
+            trace::record(trace::EventType::Wakeup, pid);
+            LOG_INFO(Dev, "[Dev] Wakeup pid=" << pid << " for dev=" << dev_id);
             return;
         }
 
@@ -50,6 +80,33 @@ ProcessManager::ProcessManager(MemoryManager& memory_manager,
       device_manager_(device_manager),
       file_system_(file_system) {}
 
+ProcessManager::~ProcessManager() {
+    // 磁盘设备比进程管理器活得久，卸下观察者以免析构时的回写回调到这里
+    if (timed_disk_) {
+        timed_disk_->set_access_observer({});
+    }
+}
+
+void ProcessManager::enable_disk_timing(DiskDevice& disk, DiskSchedPolicy policy,
+                                        DiskTiming timing) {
+    if (disk_sched_) {
+        disk_sched_->set_policy(policy);
+        return;
+    }
+    disk_sched_ = std::make_unique<DiskScheduler>(policy, timing, disk.get_num_blocks());
+    timed_disk_ = &disk;
+    disk.set_access_observer([this](size_t first_block, size_t count, bool write) {
+        if (io_pid_ == -1) {
+            return;  // shell 命令等进程之外的访问不计时
+        }
+        // 指令在本 tick 末尾执行完，请求在下一 tick 的起点到达
+        disk_sched_->submit(io_pid_, first_block, count, write, next_tick_);
+        ++processes_[io_pid_].disk_io_pending;
+    });
+    LOG_INFO(Disk, "[DiskSched] Disk timing model enabled, policy="
+                       << disk_sched_policy_name(policy));
+}
+
 int ProcessManager::create_process(int total_time) {
     auto program = Program::create_default(total_time);
     return create_process_with_program(program);
@@ -58,7 +115,7 @@ int ProcessManager::create_process(int total_time) {
 int ProcessManager::create_process_from_file(const std::string& filename) {
     auto program = Program::load_from_file(filename);
     if (!program) {
-        std::cerr << "Failed to load program from " << filename << std::endl;
+        LOG_ERROR(Proc, "Failed to load program from " << filename);
         return -1;
     }
     return create_process_with_program(program);
@@ -76,19 +133,21 @@ int ProcessManager::create_process_with_program(
 
     processes_[pid] = pcb;
     ready_queue_.push(pid);
+    g_proc_metrics.created.inc();
+    g_proc_metrics.live.set(static_cast<int64_t>(processes_.size()));
     
     // 为进程创建内存空间
     memory_manager_.create_process_memory(pid, pcb.virtual_pages);
 
-    std::cerr << "Process " << pid << " created with " << program->size()
-              << " instructions\n";
+    LOG_INFO(Proc, "Process " << pid << " created with " << program->size()
+                       << " instructions");
     return pid;
 }
 
 void ProcessManager::terminate_process(int pid) {
     auto it = processes_.find(pid);
     if (it == processes_.end()) {
-        std::cerr << "Process " << pid << " not found.\n";
+        LOG_WARN(Proc, "Process " << pid << " not found.");
         return;
     }
     
@@ -107,7 +166,10 @@ void ProcessManager::terminate_process(int pid) {
     if (pid == cur_pid_) {
         cur_pid_ = -1;
     }
-    std::cerr << "Process " << pid << " terminated.\n";
+    g_proc_metrics.terminated.inc();
+    g_proc_metrics.live.set(static_cast<int64_t>(processes_.size()));
+    trace::record(trace::EventType::Exit, pid);
+    LOG_INFO(Proc, "Process " << pid << " terminated.");
 }
 
 void ProcessManager::dump_processes() const {
@@ -143,13 +205,20 @@ void ProcessManager::dump_processes() const {
 }
 
 void ProcessManager::tick() {
-    std::cerr << "=== Tick " << next_tick_++ << " === (Total: " << processes_.size();
+    metrics::ScopedTimer timer(g_proc_metrics.tick_ns);
+    g_proc_metrics.ticks.inc();
+    const int tick_no = next_tick_++;
+    trace::g_ring.set_tick(static_cast<uint64_t>(tick_no));
+    trace::record(trace::EventType::TickStart, cur_pid_,
+                  static_cast<uint32_t>(processes_.size()));
     if (cur_pid_ != -1) {
-        std::cerr << " | Running: PID=" << cur_pid_ << " PC=" << processes_[cur_pid_].pc;
+        LOG_DEBUG(Proc, "=== Tick " << tick_no << " === (Total: "
+                            << processes_.size() << " | Running: PID=" << cur_pid_
+                            << " PC=" << processes_[cur_pid_].pc << ")");
     } else {
-        std::cerr << " | CPU Idle";
+        LOG_DEBUG(Proc, "=== Tick " << tick_no << " === (Total: "
+                            << processes_.size() << " | CPU Idle)");
     }
-    std::cerr << ")\n";
 
     if (cur_pid_ == -1) {
         schedule();
@@ -162,18 +231,29 @@ void ProcessManager::tick() {
         auto& pcb = processes_[cur_pid_];
         // 执行下一条指令
         if (pcb.pc < pcb.program->size()) {
+            io_pid_ = cur_pid_;
             execute_instruction(pcb, pcb.program->get_instruction(pcb.pc));
+            io_pid_ = -1;
             pcb.pc++;
+            g_proc_metrics.instructions.inc();
+        }
+        if (pcb.disk_io_pending > 0 && pcb.state == ProcessState::Running) {
+            pcb.state = ProcessState::Blocked;
+            pcb.blocked_time = 0;
+            pcb.blocked_reason = BlockReason::DiskIo;
         }
 
         pcb.time_slice_left--;
         pcb.cpu_time++;
-        std::cerr << "[Tick] Process " << cur_pid_
-                  << " executing (PC=" << pcb.pc << "/" << pcb.program->size()
-                  << ", slice remaining: " << pcb.time_slice_left << ")\n";
+        // 指令执行完毕后的状态转换记在下一 tick 的起点
+        trace::g_ring.set_tick(static_cast<uint64_t>(tick_no) + 1);
+        LOG_DEBUG(Proc, "[Tick] Process " << cur_pid_ << " executing (PC="
+                            << pcb.pc << "/" << pcb.program->size()
+                            << ", slice remaining: " << pcb.time_slice_left << ")");
 
         if (pcb.pc >= pcb.program->size()) {  // 进程完成
-            std::cerr << "[Tick] Process " << cur_pid_ << " completed\n";
+            LOG_INFO(Proc, "[Tick] Process " << cur_pid_ << " completed");
+            trace::record(trace::EventType::Exit, cur_pid_);
             pcb.state = ProcessState::Terminated;
             for (const auto& [dev_id, next_owner_pid] :
                  device_manager_.release_all(cur_pid_)) {
@@ -184,23 +264,77 @@ void ProcessManager::tick() {
             memory_manager_.free_process_memory(cur_pid_);
             processes_.erase(cur_pid_);
             cur_pid_ = -1;
+            g_proc_metrics.terminated.inc();
+            g_proc_metrics.live.set(static_cast<int64_t>(processes_.size()));
+        } else if (pcb.blocked_reason == BlockReason::DiskIo) {  // 等待磁盘，先于时间片判断
+            g_proc_metrics.blocks.inc();
+            trace::record(trace::EventType::Block, cur_pid_,
+                          static_cast<uint32_t>(BlockReason::DiskIo),
+                          static_cast<uint64_t>(pcb.disk_io_pending));
+            LOG_INFO(Proc, "[Tick] Process " << cur_pid_ << " blocked on "
+                               << pcb.disk_io_pending << " disk request(s)");
+            if (pcb.time_slice_left <= 0) {
+                pcb.time_slice_left = pcb.time_slice;
+            }
+            cur_pid_ = -1;
         } else if (pcb.time_slice_left <= 0) {  // 时间片完
-            std::cerr << "[Tick] Process " << cur_pid_
-                      << " time slice exhausted\n";
+            g_proc_metrics.slice_expirations.inc();
+            trace::record(trace::EventType::SliceExpired, cur_pid_);
+            LOG_INFO(Proc, "[Tick] Process " << cur_pid_
+                               << " time slice exhausted");
             pcb.state = ProcessState::Ready;
             pcb.time_slice_left = pcb.time_slice;
             ready_queue_.push(cur_pid_);
             cur_pid_ = -1;
         } else if (pcb.state == ProcessState::Blocked) {  // 进程阻塞
-            std::cerr << "[Tick] Process " << cur_pid_
-                      << " blocked during execution\n";
+            g_proc_metrics.blocks.inc();
+            trace::record(trace::EventType::Block, cur_pid_,
+                          static_cast<uint32_t>(pcb.blocked_reason),
+                          pcb.blocked_reason == BlockReason::Device
+                              ? pcb.waiting_device
+                              : static_cast<uint64_t>(pcb.blocked_time));
+            LOG_INFO(Proc, "[Tick] Process " << cur_pid_
+                               << " blocked during execution");
             cur_pid_ = -1;
         }
+    } else {
+        g_proc_metrics.idle_ticks.inc();
     }
 
+    trace::g_ring.set_tick(static_cast<uint64_t>(tick_no) + 1);
+    // 周期性刷出延迟分配的文件数据（不归属任何进程，类似后台回写线程）
+    file_system_.tick(static_cast<uint64_t>(tick_no) + 1);
+    if (disk_sched_) {
+        complete_disk_io(static_cast<double>(tick_no) + 1);
+    }
     check_blocked_processes();
 }
 
+void ProcessManager::complete_disk_io(double now) {
+    completed_io_.clear();
+    disk_sched_->advance(now, completed_io_);
+    for (const auto& req : completed_io_) {
+        const auto it = processes_.find(req.pid);
+        if (it == processes_.end()) {
+            continue;  // 发起者已退出，请求照常完成
+        }
+        PCB& pcb = it->second;
+        if (pcb.disk_io_pending > 0) {
+            --pcb.disk_io_pending;
+        }
+        if (pcb.disk_io_pending == 0 && pcb.state == ProcessState::Blocked &&
+            pcb.blocked_reason == BlockReason::DiskIo) {
+            pcb.state = ProcessState::Ready;
+            pcb.blocked_reason = BlockReason::None;
+            ready_queue_.push(req.pid);
+            g_proc_metrics.wakeups.inc();
+            trace::record(trace::EventType::Wakeup, req.pid);
+            LOG_INFO(Proc, "[Tick] Process " << req.pid << " disk I/O completed after "
+                               << req.finish - req.arrival << " ticks");
+        }
+    }
+}
+
 void ProcessManager::schedule() {
     while (ready_queue_.size()) {
         int pid = ready_queue_.front();
@@ -215,45 +349,49 @@ void ProcessManager::schedule() {
         // 调度进程开始运行
         cur_pid_ = pcb.pid;
         pcb.state = ProcessState::Running;
-        std::cerr << "[Schedule] Process " << pid << " is now running\n";
+        g_proc_metrics.dispatches.inc();
+        trace::record(trace::EventType::Schedule, pid);
+        LOG_INFO(Proc, "[Schedule] Process " << pid << " is now running");
         return;
     }
     // 未能调度任何进程
-    std::cerr << "[Schedule] CPU idle - no ready processes\n";
+    LOG_INFO(Proc, "[Schedule] CPU idle - no ready processes");
 }
 
 void ProcessManager::run_process(int pid) {
     if (processes_.find(pid) == processes_.end()) {
-        std::cerr << "Process " << pid << " not found.\n";
+        LOG_WARN(Proc, "Process " << pid << " not found.");
         return;
     }
     if (processes_[pid].state != ProcessState::Ready) {
-        std::cerr << "Process " << pid << " is not in Ready state\n";
+        LOG_WARN(Proc, "Process " << pid << " is not in Ready state");
         return;
     }
 
     if (cur_pid_ != -1) {  // 抢占，改变当前进程状态
         processes_[cur_pid_].state = ProcessState::Ready;
         ready_queue_.push(cur_pid_);
-        std::cerr << "Process " << cur_pid_ << " preempted\n";
+        trace::record(trace::EventType::Preempt, cur_pid_);
+        LOG_INFO(Proc, "Process " << cur_pid_ << " preempted");
     }
 
     auto& pcb = processes_[pid];
     cur_pid_ = pid;
     pcb.state = ProcessState::Running;
-    std::cerr << "Process " << pid << " is now running\n";
+    trace::record(trace::EventType::Schedule, pid);
+    LOG_INFO(Proc, "Process " << pid << " is now running");
 }
 
 void ProcessManager::block_process(int pid, int duration) {
     if (processes_.find(pid) == processes_.end()) {
-        std::cerr << "Process " << pid << " not found.\n";
+        LOG_WARN(Proc, "Process " << pid << " not found.");
         return;
     }
     auto& pcb = processes_[pid];
     if (pcb.state != ProcessState::Running &&
         pcb.state != ProcessState::Ready) {
-        std::cerr << "Process " << pid
-                  << " cannot be blocked in its current state\n";
+        LOG_WARN(Proc, "Process " << pid
+                           << " cannot be blocked in its current state");
         return;
     }
 
@@ -261,8 +399,11 @@ void ProcessManager::block_process(int pid, int duration) {
     pcb.blocked_time = duration;
     pcb.blocked_reason = BlockReason::Sleep;
     pcb.waiting_device = UINT32_MAX;
-    std::cerr << "Process " << pid << " is blocked for " << duration
-              << " ticks\n";
+    trace::record(trace::EventType::Block, pid,
+                  static_cast<uint32_t>(BlockReason::Sleep),
+                  static_cast<uint64_t>(duration));
+    LOG_INFO(Proc, "Process " << pid << " is blocked for " << duration
+                       << " ticks");
 
     if (pid == cur_pid_) {  // 当前进程被阻塞，触发调度
         cur_pid_ = -1;
@@ -273,12 +414,12 @@ void ProcessManager::block_process(int pid, int duration) {
 
 void ProcessManager::wakeup_process(int pid) {
     if (processes_.find(pid) == processes_.end()) {
-        std::cerr << "Process " << pid << " not found.\n";
+        LOG_WARN(Proc, "Process " << pid << " not found.");
         return;
     }
     auto& pcb = processes_[pid];
     if (pcb.state != ProcessState::Blocked) {
-        std::cerr << "Process " << pid << " is not blocked\n";
+        LOG_WARN(Proc, "Process " << pid << " is not blocked");
         return;
     }
 
@@ -288,7 +429,9 @@ void ProcessManager::wakeup_process(int pid) {
     pcb.waiting_device = UINT32_MAX;
     device_manager_.cancel_wait(pid);
     ready_queue_.push(pid);
-    std::cerr << "Process " << pid << " woken up and added to ready queue\n";
+    g_proc_metrics.wakeups.inc();
+    trace::record(trace::EventType::Wakeup, pid);
+    LOG_INFO(Proc, "Process " << pid << " woken up and added to ready queue");
 }
 
 void ProcessManager::check_blocked_processes() {
@@ -301,7 +444,9 @@ void ProcessManager::check_blocked_processes() {
                 pcb.state = ProcessState::Ready;
                 ready_queue_.push(pid);
                 pcb.blocked_reason = BlockReason::None;
-                std::cerr << "[Tick] Process " << pid << " auto-woken up\n";
+                g_proc_metrics.wakeups.inc();
+                trace::record(trace::EventType::Wakeup, pid);
+                LOG_INFO(Proc, "[Tick] Process " << pid << " auto-woken up");
             }
         }
     }
@@ -324,41 +469,39 @@ void ProcessManager::close_all_process_files(PCB& pcb) {
         file_system_.close_file(fs_fd);
     }
     if (!pcb.fd_map.empty()) {
-        std::cerr << "[Exec] Closed " << pcb.fd_map.size()
-                  << " open file(s) for PID " << pcb.pid << "\n";
+        LOG_INFO(Proc, "[Exec] Closed " << pcb.fd_map.size()
+                           << " open file(s) for PID " << pcb.pid);
     }
     pcb.fd_map.clear();
 }
 
 void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
-    std::cerr << "[Exec] ";
     switch (inst.type) {
         case OpType::Compute:
-            std::cerr << "Compute\n";
+            LOG_DEBUG(Proc, "[Exec] Compute");
             break;
         case OpType::MemRead:
-            std::cerr << "MemRead addr=" << inst.arg1 << "\n";
+            LOG_DEBUG(Proc, "[Exec] MemRead addr=" << inst.arg1);
             memory_manager_.access_memory(pcb.pid, inst.arg1, AccessType::Read);
             break;
         case OpType::MemWrite:
-            std::cerr << "MemWrite addr=" << inst.arg1 << "\n";
+            LOG_DEBUG(Proc, "[Exec] MemWrite addr=" << inst.arg1);
             memory_manager_.access_memory(pcb.pid, inst.arg1, AccessType::Write);
             break;
         case OpType::FileOpen: {
             int script_fd = -1;
             if (inst.arg1 != kAutoScriptFd) {
                 if (inst.arg1 > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
-                    std::cerr << "FileOpen invalid fd=" << inst.arg1 << "\n";
+                    LOG_WARN(Proc, "[Exec] FileOpen invalid fd=" << inst.arg1);
                     break;
                 }
                 script_fd = static_cast<int>(inst.arg1);
                 if (script_fd < 3) {
-                    std::cerr << "FileOpen invalid fd=" << script_fd << "\n";
+                    LOG_WARN(Proc, "[Exec] FileOpen invalid fd=" << script_fd);
                     break;
                 }
                 if (pcb.fd_map.find(script_fd) != pcb.fd_map.end()) {
-                    std::cerr << "FileOpen fd already in use: " << script_fd
-                              << "\n";
+                    LOG_WARN(Proc, "[Exec] FileOpen fd already in use: " << script_fd);
                     break;
                 }
                 if (script_fd >= pcb.next_script_fd) {
@@ -368,7 +511,7 @@ void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
 
             int fs_fd = file_system_.open_file(inst.str_arg);
             if (fs_fd < 0) {
-                std::cerr << "FileOpen failed: " << inst.str_arg << "\n";
+                LOG_WARN(Proc, "[Exec] FileOpen failed: " << inst.str_arg);
                 break;
             }
 
@@ -376,41 +519,41 @@ void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
                 script_fd = allocate_script_fd(pcb);
                 if (script_fd < 0) {
                     file_system_.close_file(fs_fd);
-                    std::cerr << "FileOpen failed: no available script fd\n";
+                    LOG_WARN(Proc, "[Exec] FileOpen failed: no available script fd");
                     break;
                 }
             }
 
             pcb.fd_map[script_fd] = fs_fd;
-            std::cerr << "FileOpen file=" << inst.str_arg
-                      << " -> fd=" << script_fd << "\n";
+            LOG_DEBUG(Proc, "[Exec] FileOpen file=" << inst.str_arg
+                                << " -> fd=" << script_fd);
             break;
         }
         case OpType::FileClose: {
             if (inst.arg1 > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
-                std::cerr << "FileClose invalid fd=" << inst.arg1 << "\n";
+                LOG_WARN(Proc, "[Exec] FileClose invalid fd=" << inst.arg1);
                 break;
             }
             const int script_fd = static_cast<int>(inst.arg1);
             auto it = pcb.fd_map.find(script_fd);
             if (it == pcb.fd_map.end()) {
-                std::cerr << "FileClose unknown fd=" << script_fd << "\n";
+                LOG_WARN(Proc, "[Exec] FileClose unknown fd=" << script_fd);
                 break;
             }
             file_system_.close_file(it->second);
             pcb.fd_map.erase(it);
-            std::cerr << "FileClose fd=" << script_fd << "\n";
+            LOG_DEBUG(Proc, "[Exec] FileClose fd=" << script_fd);
             break;
         }
         case OpType::FileRead: {
             if (inst.arg1 > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
-                std::cerr << "FileRead invalid fd=" << inst.arg1 << "\n";
+                LOG_WARN(Proc, "[Exec] FileRead invalid fd=" << inst.arg1);
                 break;
             }
             const int script_fd = static_cast<int>(inst.arg1);
             auto it = pcb.fd_map.find(script_fd);
             if (it == pcb.fd_map.end()) {
-                std::cerr << "FileRead unknown fd=" << script_fd << "\n";
+                LOG_WARN(Proc, "[Exec] FileRead unknown fd=" << script_fd);
                 break;
             }
 
@@ -421,23 +564,23 @@ void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
             std::vector<char> buf(req == 0 ? 1 : req);
             const ssize_t n = file_system_.read_file(it->second, buf.data(), req);
             if (n < 0) {
-                std::cerr << "FileRead failed fd=" << script_fd
-                          << " size=" << req << "\n";
+                LOG_WARN(Proc, "[Exec] FileRead failed fd=" << script_fd
+                                   << " size=" << req);
             } else {
-                std::cerr << "FileRead fd=" << script_fd << " size=" << req
-                          << " -> " << n << " bytes\n";
+                LOG_DEBUG(Proc, "[Exec] FileRead fd=" << script_fd << " size=" << req
+                                    << " -> " << n << " bytes");
             }
             break;
         }
         case OpType::FileWrite: {
             if (inst.arg1 > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
-                std::cerr << "FileWrite invalid fd=" << inst.arg1 << "\n";
+                LOG_WARN(Proc, "[Exec] FileWrite invalid fd=" << inst.arg1);
                 break;
             }
             const int script_fd = static_cast<int>(inst.arg1);
             auto it = pcb.fd_map.find(script_fd);
             if (it == pcb.fd_map.end()) {
-                std::cerr << "FileWrite unknown fd=" << script_fd << "\n";
+                LOG_WARN(Proc, "[Exec] FileWrite unknown fd=" << script_fd);
                 break;
             }
 
@@ -448,16 +591,16 @@ void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
             std::vector<char> buf(req, kWriteFillByte);
             const ssize_t n = file_system_.write_file(it->second, buf.data(), req);
             if (n < 0) {
-                std::cerr << "FileWrite failed fd=" << script_fd
-                          << " size=" << req << "\n";
+                LOG_WARN(Proc, "[Exec] FileWrite failed fd=" << script_fd
+                                   << " size=" << req);
             } else {
-                std::cerr << "FileWrite fd=" << script_fd << " size=" << req
-                          << " -> " << n << " bytes\n";
+                LOG_DEBUG(Proc, "[Exec] FileWrite fd=" << script_fd << " size=" << req
+                                    << " -> " << n << " bytes");
             }
             break;
         }
         case OpType::DevRequest:
-            std::cerr << "DevRequest dev=" << inst.arg1 << "\n";
+            LOG_DEBUG(Proc, "[Exec] DevRequest dev=" << inst.arg1);
             if (!device_manager_.request(pcb.pid,
                                          static_cast<uint32_t>(inst.arg1))) {
                 pcb.state = ProcessState::Blocked;
@@ -467,7 +610,7 @@ void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
             }
             break;
         case OpType::DevRelease:
-            std::cerr << "DevRelease dev=" << inst.arg1 << "\n";
+            LOG_DEBUG(Proc, "[Exec] DevRelease dev=" << inst.arg1);
             wakeup_device_waiter(device_manager_, processes_, ready_queue_,
                                  static_cast<uint32_t>(inst.arg1),
                                  device_manager_.release(
@@ -475,7 +618,7 @@ void ProcessManager::execute_instruction(PCB& pcb, const Instruction& inst) {
                                      static_cast<uint32_t>(inst.arg1)));
             break;
         case OpType::Sleep:
-            std::cerr << "Sleep " << inst.arg1 << "\n";
+            LOG_DEBUG(Proc, "[Exec] Sleep " << inst.arg1);
             pcb.state = ProcessState::Blocked;
             pcb.blocked_time = inst.arg1;
             pcb.blocked_reason = BlockReason::Sleep;
@@ -1,9 +1,10 @@
 #include "proc/program.h"
+#include "common/log.h"
 #include <fstream>
 #include <sstream>
-#include <iostream>
 #include <iomanip>
 #include <limits>
+#include <utility>
 
 std::shared_ptr<Program> Program::load_from_file(const std::string& filename) {
     auto instructions = parse_file(filename);
@@ -28,6 +29,12 @@ std::shared_ptr<Program> Program::create_compute_only(int length) {
     return prog;
 }
 
+std::shared_ptr<Program> Program::from_instructions(std::vector<Instruction> instructions) {
+    auto prog = std::shared_ptr<Program>(new Program());
+    prog->instructions_ = std::move(instructions);
+    return prog;
+}
+
 const Instruction& Program::get_instruction(size_t pc) const {
     return instructions_[pc];
 }
@@ -37,7 +44,7 @@ std::vector<Instruction> Program::parse_file(const std::string& filename) {
     std::ifstream file(filename);
     
     if (!file.is_open()) {
-        std::cerr << "Cannot open file: " << filename << std::endl;
+        LOG_ERROR(Proc, "Cannot open file: " << filename);
         return instructions;
     }
     
@@ -62,8 +69,8 @@ std::vector<Instruction> Program::parse_file(const std::string& filename) {
         } else if (op == "FO" || op == "FILEOPEN") {
             std::string first;
             if (!(iss >> first)) {
-                std::cerr << "Invalid FO syntax (missing arguments) in "
-                          << filename << std::endl;
+                LOG_WARN(Proc, "Invalid FO syntax (missing arguments) in "
+                                   << filename);
                 continue;
             }
 
@@ -73,8 +80,7 @@ std::vector<Instruction> Program::parse_file(const std::string& filename) {
                 std::istringstream fd_iss(first);
                 fd_iss >> std::setbase(0) >> fd;
                 if (fd_iss.fail()) {
-                    std::cerr << "Invalid FO syntax (bad fd): " << line
-                              << std::endl;
+                    LOG_WARN(Proc, "Invalid FO syntax (bad fd): " << line);
                     continue;
                 }
                 instructions.emplace_back(OpType::FileOpen, fd, 0, second);
@@ -111,6 +117,6 @@ std::vector<Instruction> Program::parse_file(const std::string& filename) {
         }
     }
     
-    std::cerr << "Loaded " << instructions.size() << " instructions from " << filename << std::endl;
+    LOG_INFO(Proc, "Loaded " << instructions.size() << " instructions from " << filename);
     return instructions;
 }
@@ -0,0 +1,224 @@
+#include "proc/workload.h"
+#include "proc/program.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <utility>
+
+namespace workload {
+
+namespace {
+
+// splitmix64：实现简单且输出与平台无关，保证同一种子在任何编译器下生成相同负载
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, n)
+    uint64_t below(uint64_t n) { return n == 0 ? 0 : next() % n; }
+
+    // [lo, hi]
+    uint64_t between(uint64_t lo, uint64_t hi) {
+        return hi <= lo ? lo : lo + below(hi - lo + 1);
+    }
+
+    // [0, 1)
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+private:
+    uint64_t state_;
+};
+
+enum class Op { Compute, MemRead, MemWrite, File, Device, Sleep };
+
+constexpr uint64_t kScriptFd = 3;
+
+}  // namespace
+
+std::string file_path(uint32_t index) {
+    return "/wl" + std::to_string(index);
+}
+
+bool parse_access_pattern(const std::string& s, AccessPattern& out) {
+    if (s == "uniform") {
+        out = AccessPattern::Uniform;
+    } else if (s == "sequential" || s == "seq") {
+        out = AccessPattern::Sequential;
+    } else if (s == "strided" || s == "stride") {
+        out = AccessPattern::Strided;
+    } else if (s == "zipfian" || s == "zipf") {
+        out = AccessPattern::Zipfian;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* access_pattern_name(AccessPattern p) {
+    switch (p) {
+        case AccessPattern::Uniform: return "uniform";
+        case AccessPattern::Sequential: return "sequential";
+        case AccessPattern::Strided: return "strided";
+        case AccessPattern::Zipfian: return "zipfian";
+    }
+    return "?";
+}
+
+bool parse_mix(const std::string& s, Mix& out) {
+    Mix mix{0, 0, 0, 0, 0, 0};
+    std::istringstream iss(s);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        const auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        const std::string key = item.substr(0, eq);
+        uint32_t value = 0;
+        try {
+            value = static_cast<uint32_t>(std::stoul(item.substr(eq + 1)));
+        } catch (...) {
+            return false;
+        }
+        if (key == "compute") {
+            mix.compute = value;
+        } else if (key == "read") {
+            mix.mem_read = value;
+        } else if (key == "write") {
+            mix.mem_write = value;
+        } else if (key == "file") {
+            mix.file = value;
+        } else if (key == "device") {
+            mix.device = value;
+        } else if (key == "sleep") {
+            mix.sleep = value;
+        } else {
+            return false;
+        }
+    }
+    if (mix.compute + mix.mem_read + mix.mem_write + mix.file + mix.device +
+            mix.sleep == 0) {
+        return false;
+    }
+    out = mix;
+    return true;
+}
+
+Generator::Generator(Params params) : params_(std::move(params)) {
+    params_.virtual_pages = std::max<size_t>(params_.virtual_pages, 1);
+    params_.num_files = std::max<uint32_t>(params_.num_files, 1);
+    params_.num_devices = std::max<uint32_t>(params_.num_devices, 1);
+    params_.max_io_bytes = std::max(params_.max_io_bytes, params_.min_io_bytes);
+
+    if (params_.access == AccessPattern::Zipfian) {
+        // 第 k 页（从 0 开始）的权重为 1/(k+1)^theta
+        zipf_cdf_.resize(params_.virtual_pages);
+        double sum = 0;
+        for (size_t k = 0; k < params_.virtual_pages; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), params_.zipf_theta);
+            zipf_cdf_[k] = sum;
+        }
+        for (double& c : zipf_cdf_) {
+            c /= sum;
+        }
+    }
+}
+
+std::vector<Instruction> Generator::generate(uint64_t index) const {
+    const Params& p = params_;
+    Rng rng(p.seed * 0x100000001b3ULL + index);
+
+    const Mix& m = p.mix;
+    const std::pair<Op, uint32_t> weights[] = {
+        {Op::Compute, m.compute}, {Op::MemRead, m.mem_read}, {Op::MemWrite, m.mem_write},
+        {Op::File, m.file},       {Op::Device, m.device},    {Op::Sleep, m.sleep},
+    };
+    uint64_t total_weight = 0;
+    for (const auto& w : weights) {
+        total_weight += w.second;
+    }
+
+    const uint64_t page_size = config::PAGE_SIZE;
+    uint64_t cursor = rng.below(p.virtual_pages);
+    auto next_page = [&]() -> uint64_t {
+        switch (p.access) {
+            case AccessPattern::Uniform:
+                return rng.below(p.virtual_pages);
+            case AccessPattern::Sequential:
+                cursor = (cursor + 1) % p.virtual_pages;
+                return cursor;
+            case AccessPattern::Strided:
+                cursor = (cursor + p.stride_pages) % p.virtual_pages;
+                return cursor;
+            case AccessPattern::Zipfian: {
+                const double u = rng.unit();
+                auto it = std::lower_bound(zipf_cdf_.begin(), zipf_cdf_.end(), u);
+                return std::min<uint64_t>(it - zipf_cdf_.begin(), p.virtual_pages - 1);
+            }
+        }
+        return 0;
+    };
+
+    std::vector<Instruction> out;
+    out.reserve(p.program_length + 4);
+    while (out.size() < p.program_length) {
+        uint64_t pick = rng.below(total_weight);
+        Op op = Op::Compute;
+        for (const auto& w : weights) {
+            if (pick < w.second) {
+                op = w.first;
+                break;
+            }
+            pick -= w.second;
+        }
+
+        switch (op) {
+            case Op::Compute:
+                out.emplace_back(OpType::Compute);
+                break;
+            case Op::MemRead:
+            case Op::MemWrite: {
+                const uint64_t addr = next_page() * page_size + rng.below(page_size);
+                out.emplace_back(op == Op::MemRead ? OpType::MemRead : OpType::MemWrite,
+                                 addr);
+                break;
+            }
+            case Op::File: {
+                const uint32_t file = static_cast<uint32_t>(rng.below(p.num_files));
+                const uint64_t bytes = rng.between(p.min_io_bytes, p.max_io_bytes);
+                const bool write = rng.below(100) < p.write_percent;
+                out.emplace_back(OpType::FileOpen, kScriptFd, 0, file_path(file));
+                out.emplace_back(write ? OpType::FileWrite : OpType::FileRead, kScriptFd,
+                                 bytes);
+                out.emplace_back(OpType::FileClose, kScriptFd);
+                break;
+            }
+            case Op::Device: {
+                const uint64_t dev = rng.below(p.num_devices);
+                out.emplace_back(OpType::DevRequest, dev);
+                for (uint32_t i = 0; i < p.device_hold; ++i) {
+                    out.emplace_back(OpType::Compute);
+                }
+                out.emplace_back(OpType::DevRelease, dev);
+                break;
+            }
+            case Op::Sleep:
+                out.emplace_back(OpType::Sleep, rng.between(1, std::max<uint32_t>(p.max_sleep, 1)));
+                break;
+        }
+    }
+    return out;
+}
+
+std::shared_ptr<Program> Generator::make_program(uint64_t index) const {
+    return Program::from_instructions(generate(index));
+}
+
+}  // namespace workload
@@ -1,5 +1,10 @@
 #include "shell/shell.h"
 #include "kernel.h"
+#include "common/event_trace.h"
+#include "common/log.h"
+#include "common/metrics.h"
+#include "common/timeline.h"
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -19,6 +24,11 @@ void Shell::run() {
             execute_command(args);
         }
     }
+
+    if (!trace::g_timeline.finish()) {
+        std::cerr << "Failed to write timeline on exit.\n";
+    }
+    kernel_.get_file_system().sync();
 }
 
 std::vector<std::string> Shell::parse_command(const std::string& input) {
@@ -49,6 +59,20 @@ void Shell::execute_command(const std::vector<std::string>& args) {
                   << "  memstats [pid]   - Display memory statistics (system or per-process)\n"
                   << "  script <file>    - Execute commands from a script file\n"
                   << "  dev [id]         - Display device status (all or by device id)\n"
+                  << "  log [sub] [lvl]  - Show or set log levels (sub: all|kernel|proc|memory|swap|fs|dev|disk,\n"
+                  << "                     lvl: off|error|warn|info|debug)\n"
+                  << "  trace [n]        - Dump the last n trace events (default: 20)\n"
+                  << "  trace save <f>   - Save the trace ring buffer to a binary file\n"
+                  << "  trace stream <f> - Stream trace events to a binary file ('stream off' to stop)\n"
+                  << "  trace on|off|clear - Enable, disable or clear event tracing\n"
+                  << "  timeline start [f] - Record a scheduling timeline (auto-saved to f on exit)\n"
+                  << "  timeline save <f>  - Write the timeline as Chrome trace-event JSON\n"
+                  << "  timeline stop      - Stop recording the timeline\n"
+                  << "  stats [reset]    - Display (or reset) all subsystem metrics\n"
+                  << "  stats export <f> [prom|json] - Export metrics to a file\n"
+                  << "  iosched [policy] - Show simulated disk scheduler stats, or enable/switch\n"
+                  << "                     the timing model (policy: fcfs|sstf|scan|clook)\n"
+                  << "  iosched compare|reset - Replay recorded requests under every policy, or reset stats\n"
                   << "\n"
                   << "  === File System Commands ===\n"
                   << "  format           - Format the file system\n"
@@ -62,6 +86,12 @@ void Shell::execute_command(const std::vector<std::string>& args) {
                   << "  cat <file>       - Display file contents\n"
                   << "  echo <text>      - Write text to file (use > for redirection)\n"
                   << "  fsinfo           - Display file system information\n"
+                  << "  stat <path>      - Display a file's inode and block layout\n"
+                  << "  bcache [n|reset] - Show buffer cache stats, resize it to n blocks, or reset stats\n"
+                  << "  dcache [reset]   - Show (or reset) dentry cache hit rates\n"
+                  << "  journal          - Show metadata journal state\n"
+                  << "  sync             - Flush all written blocks to the disk image\n"
+                  << "  crash            - Simulate power loss: drop unflushed writes and quit\n"
                   << "\n"
                   << "  exit             - Shutdown the simulation\n";
     } else if (cmd == "ps") {
@@ -197,7 +227,153 @@ void Shell::execute_command(const std::vector<std::string>& args) {
         } catch (const std::exception&) {
             std::cerr << "Usage: dev [device_id]\n";
         }
-    
+    } else if (cmd == "log") {
+        if (args.size() == 1) {
+            std::cerr << "=== Log Levels ===\n";
+            for (size_t i = 0; i < logging::kSubsystemCount; ++i) {
+                const auto sub = static_cast<logging::Subsystem>(i);
+                std::cerr << logging::subsystem_name(sub) << "="
+                          << logging::level_name(logging::get_level(sub)) << "\n";
+            }
+            return;
+        }
+        if (args.size() != 3) {
+            std::cerr << "Usage: log [subsystem|all] [level]\n";
+            return;
+        }
+        const auto level = logging::parse_level(args[2]);
+        if (!level) {
+            std::cerr << "Unknown log level: " << args[2] << "\n";
+            return;
+        }
+        if (args[1] == "all") {
+            logging::set_all_levels(*level);
+        } else if (const auto sub = logging::parse_subsystem(args[1])) {
+            logging::set_level(*sub, *level);
+        } else {
+            std::cerr << "Unknown log subsystem: " << args[1] << "\n";
+            return;
+        }
+        std::cerr << "Log level of " << args[1] << " set to " << args[2] << "\n";
+    } else if (cmd == "trace") {
+        auto& ring = trace::g_ring;
+        const std::string sub = args.size() > 1 ? args[1] : "";
+        if (sub == "on" || sub == "off") {
+            ring.set_enabled(sub == "on");
+            std::cerr << "Event tracing " << (sub == "on" ? "enabled" : "disabled") << "\n";
+        } else if (sub == "clear") {
+            ring.clear();
+            std::cerr << "Trace buffer cleared.\n";
+        } else if (sub == "save") {
+            if (args.size() < 3) {
+                std::cerr << "Usage: trace save <file>\n";
+            } else if (ring.save(args[2])) {
+                std::cerr << "Saved " << ring.size() << " events to " << args[2] << "\n";
+            } else {
+                std::cerr << "Failed to save trace to " << args[2] << "\n";
+            }
+        } else if (sub == "stream") {
+            if (args.size() < 3) {
+                std::cerr << "Usage: trace stream <file>|off\n";
+            } else if (args[2] == "off") {
+                ring.stop_stream();
+                std::cerr << "Trace streaming stopped.\n";
+            } else if (ring.start_stream(args[2])) {
+                std::cerr << "Streaming trace events to " << args[2] << "\n";
+            } else {
+                std::cerr << "Failed to open trace stream " << args[2] << "\n";
+            }
+        } else {
+            size_t n = 20;
+            if (!sub.empty()) {
+                try {
+                    n = std::stoul(sub);
+                } catch (const std::exception&) {
+                    std::cerr << "Usage: trace [n|on|off|clear|save <file>|stream <file>|stream off]\n";
+                    return;
+                }
+            }
+            std::cerr << "=== Trace (" << ring.size() << "/" << ring.capacity()
+                      << " buffered, " << ring.total_recorded() << " recorded, "
+                      << ring.overwritten() << " overwritten) ===\n";
+            ring.dump_text(std::cerr, n);
+        }
+    } else if (cmd == "timeline") {
+        auto& timeline = trace::g_timeline;
+        const std::string sub = args.size() > 1 ? args[1] : "";
+        if (sub == "start") {
+            timeline.start(args.size() > 2 ? args[2] : "");
+            std::cerr << "Timeline recording started.\n";
+        } else if (sub == "stop") {
+            timeline.stop();
+            std::cerr << "Timeline recording stopped (" << timeline.size() << " events).\n";
+        } else if (sub == "save" && args.size() > 2) {
+            if (timeline.write_chrome_json(args[2])) {
+                std::cerr << "Timeline (" << timeline.size() << " events) written to "
+                          << args[2] << "\n";
+            } else {
+                std::cerr << "Failed to write timeline to " << args[2] << "\n";
+            }
+        } else {
+            std::cerr << "Usage: timeline start [file] | stop | save <file>\n";
+        }
+    } else if (cmd == "stats") {
+        auto& reg = metrics::registry();
+        if (args.size() == 1) {
+            std::cerr << "=== Metrics ===\n";
+            reg.dump_table(std::cerr);
+        } else if (args[1] == "reset") {
+            reg.reset();
+            std::cerr << "Metrics reset.\n";
+        } else if (args[1] == "export" && args.size() > 2) {
+            const std::string& filename = args[2];
+            std::string format = args.size() > 3 ? args[3] : "";
+            if (format.empty()) {
+                const bool is_json = filename.size() >= 5 &&
+                                     filename.compare(filename.size() - 5, 5, ".json") == 0;
+                format = is_json ? "json" : "prom";
+            }
+            if (format != "prom" && format != "json") {
+                std::cerr << "Unknown metrics format: " << format << "\n";
+                return;
+            }
+            std::ofstream out(filename);
+            if (!out.is_open()) {
+                std::cerr << "Failed to open " << filename << "\n";
+                return;
+            }
+            if (format == "json") {
+                reg.write_json(out);
+            } else {
+                reg.write_prometheus(out);
+            }
+            std::cerr << "Metrics exported to " << filename << " (" << format << ")\n";
+        } else {
+            std::cerr << "Usage: stats [reset | export <file> [prom|json]]\n";
+        }
+    } else if (cmd == "iosched") {
+        auto& pm = kernel_.get_process_manager();
+        DiskScheduler* sched = pm.get_disk_scheduler();
+        const std::string sub = args.size() > 1 ? args[1] : "";
+        DiskSchedPolicy policy;
+        if (sub.empty() || sub == "compare" || sub == "reset") {
+            if (!sched) {
+                std::cerr << "Disk timing model disabled (use 'iosched <policy>' or --disk-sched).\n";
+            } else if (sub.empty()) {
+                sched->dump(std::cerr);
+            } else if (sub == "compare") {
+                sched->dump_comparison(std::cerr);
+            } else {
+                sched->reset_stats();
+                std::cerr << "Disk scheduler stats reset.\n";
+            }
+        } else if (parse_disk_sched_policy(sub, policy)) {
+            kernel_.enable_disk_timing(policy);
+            std::cerr << "Disk scheduling policy: " << disk_sched_policy_name(policy) << "\n";
+        } else {
+            std::cerr << "Usage: iosched [fcfs|sstf|scan|clook | compare | reset]\n";
+        }
+
     // === File System Commands ===
     } else if (cmd == "format") {
         if (kernel_.get_file_system().format()) {
@@ -244,10 +420,18 @@ void Shell::execute_command(const std::vector<std::string>& args) {
         if (args.size() > 1) {
             int fd = kernel_.get_file_system().open_file(args[1]);
             if (fd >= 0) {
-                std::vector<char> buffer(4096);
-                ssize_t bytes_read = kernel_.get_file_system().read_file(fd, buffer.data(), buffer.size());
-                if (bytes_read > 0) {
-                    std::cout.write(buffer.data(), bytes_read);
+                // 每次读取 DIRECT_BLOCKS 块，多块一批走一次向量化读
+                std::vector<char> buffer(DIRECT_BLOCKS * BLOCK_SIZE);
+                size_t total = 0;
+                ssize_t bytes_read;
+                do {
+                    bytes_read = kernel_.get_file_system().read_file(fd, buffer.data(), buffer.size());
+                    if (bytes_read > 0) {
+                        std::cout.write(buffer.data(), bytes_read);
+                        total += static_cast<size_t>(bytes_read);
+                    }
+                } while (bytes_read == static_cast<ssize_t>(buffer.size()));
+                if (total > 0) {
                     std::cout << "\n";
                 }
                 kernel_.get_file_system().close_file(fd);
@@ -288,7 +472,60 @@ void Shell::execute_command(const std::vector<std::string>& args) {
         }
     } else if (cmd == "fsinfo") {
         kernel_.get_file_system().print_superblock();
+    } else if (cmd == "stat") {
+        if (args.size() > 1) {
+            kernel_.get_file_system().stat_file(args[1]);
+        } else {
+            std::cerr << "Usage: stat <path>\n";
+        }
     
+    } else if (cmd == "bcache") {
+        BufferCache& cache = kernel_.get_file_system().buffer_cache();
+        if (args.size() < 2) {
+            cache.dump(std::cerr);
+        } else if (args[1] == "reset") {
+            cache.reset_stats();
+            std::cerr << "Buffer cache stats reset.\n";
+        } else {
+            size_t n = 0;
+            try {
+                n = std::stoul(args[1]);
+            } catch (const std::exception&) {
+            }
+            if (n == 0) {
+                std::cerr << "Usage: bcache [<blocks> | reset]\n";
+            } else {
+                cache.set_capacity(n);
+                std::cerr << "Buffer cache capacity: " << cache.capacity() << " blocks\n";
+            }
+        }
+    } else if (cmd == "dcache") {
+        DirectoryManager& dirs = kernel_.get_file_system().directories();
+        if (args.size() < 2) {
+            dirs.dump_dentry_cache(std::cerr);
+        } else if (args[1] == "reset") {
+            dirs.reset_dentry_stats();
+            std::cerr << "Dentry cache stats reset.\n";
+        } else {
+            std::cerr << "Usage: dcache [reset]\n";
+        }
+    } else if (cmd == "sync") {
+        auto& disk = kernel_.get_disk_device();
+        if (kernel_.get_file_system().sync()) {
+            std::cerr << "Disk synced (backend: "
+                      << disk_backend_name(disk.get_backend_kind())
+                      << ", io engine: " << disk.async_engine() << ").\n";
+        } else {
+            std::cerr << "Disk sync failed.\n";
+        }
+    } else if (cmd == "journal") {
+        kernel_.get_file_system().journal().dump(std::cerr);
+    } else if (cmd == "crash") {
+        // 不经过卸载时的提交与检查点：缓冲缓存与磁盘写回缓冲中的内容全部丢失
+        std::cout.flush();
+        std::cerr << "Simulated power loss.\n";
+        kernel_.get_disk_device().power_loss();
+        std::_Exit(0);
     } else if (cmd == "exit") {
         running_ = false;
     } else {
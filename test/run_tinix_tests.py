@@ -2,6 +2,7 @@
 from __future__ import annotations
 
 import argparse
+import json
 import os
 import re
 import subprocess
@@ -79,9 +80,9 @@ def _load_fs_layout(repo: Path) -> tuple[int, int]:
     return max_inodes, max_data_blocks
 
 
-def _run(exe: Path, commands: str, cwd: Path) -> RunResult:
+def _run(exe: Path, commands: str, cwd: Path, args: list[str] | None = None) -> RunResult:
     p = subprocess.run(
-        [str(exe)],
+        [str(exe), *(args or [])],
         input=commands,
         text=True,
         stdout=subprocess.PIPE,
@@ -98,6 +99,18 @@ def _require_contains(out: str, needle: str) -> None:
         raise AssertionError(f"missing substring: {needle}\n--- output ---\n{out}")
 
 
+# stats 输出中名为 name 的计数器（或仪表）的各次取值；行首锚定，避免匹配到更长名字的后缀
+def _counters(err: str, name: str) -> list[int]:
+    return [int(v) for v in re.findall(rf"^{re.escape(name)}\s+(?:counter|gauge)\s+(\d+)", err, re.M)]
+
+
+def _counter(err: str, name: str) -> int:
+    values = _counters(err, name)
+    if not values:
+        raise AssertionError(f"missing {name}\n--- stderr ---\n{err}")
+    return values[0]
+
+
 def _swap_blocks(out: str) -> list[int]:
     blocks: list[int] = []
     for line in out.splitlines():
@@ -769,6 +782,1088 @@ def case_pc_file_ops_invalid_fd(exe: Path, repo: Path) -> None:
             raise AssertionError(f"expected process completion\n--- stderr ---\n{r.err}")
 
 
+def case_log_levels(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "log all warn",
+                    "create 3",
+                    "tick 5",
+                    "log proc info",
+                    "create 2",
+                    "tick 5",
+                    "log",
+                    "log nope info",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        _require_contains(r.err, "Log level of all set to warn")
+        _require_contains(r.err, "proc=info")
+        _require_contains(r.err, "memory=warn")
+        _require_contains(r.err, "Unknown log subsystem: nope")
+        if "[Tick] Process 1 completed" in r.err:
+            raise AssertionError(f"proc info log not suppressed\n--- stderr ---\n{r.err}")
+        if "[Memory] Created page table for PID 2" in r.err:
+            raise AssertionError(f"memory info log not suppressed\n--- stderr ---\n{r.err}")
+        _require_contains(r.err, "[Tick] Process 2 completed")
+        if "[Exec] Compute" in r.err:
+            raise AssertionError(f"proc debug log not suppressed\n--- stderr ---\n{r.err}")
+
+
+def case_trace_ring(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        pc = cwd / "tr.pc"
+        lines = ["DR 0", *[f"W {i * 0x1000}" for i in range(0, 10)], "DD 0"]
+        pc.write_text("\n".join(lines) + "\n", encoding="utf-8")
+
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "log all off",
+                    "touch f",
+                    f"create -f {pc.name}",
+                    "tick 30",
+                    "trace 1000",
+                    "trace save t.bin",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        for name in ("TickStart", "Schedule", "PageFault", "Evict", "SwapOut", "DevGrant", "DevRelease"):
+            if not re.search(rf"tick=\d+ {name} pid=", r.err):
+                raise AssertionError(f"missing {name} event\n--- stderr ---\n{r.err}")
+        _require_contains(r.err, "FsOp pid=-1 op=create")
+
+        m = re.search(r"Saved (\d+) events to t\.bin", r.err)
+        if not m:
+            raise AssertionError(f"trace save failed\n--- stderr ---\n{r.err}")
+        data = (cwd / "t.bin").read_bytes()
+        if data[:8] != b"TNXTRACE":
+            raise AssertionError("bad trace file magic")
+        event_size = int.from_bytes(data[12:16], "little")
+        if event_size != 32 or len(data) != 16 + event_size * int(m.group(1)):
+            raise AssertionError(f"bad trace file size {len(data)}")
+
+
+def case_stats_metrics(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "stats reset",
+                    "touch f",
+                    "echo hi > f",
+                    "cat f",
+                    "create 3",
+                    "tick 10",
+                    "stats",
+                    "stats export m.prom",
+                    "stats export m.json",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        if _counter(r.err, "proc_ticks_total") != 10:
+            raise AssertionError(f"unexpected tick counter\n--- stderr ---\n{r.err}")
+        if _counter(r.err, "proc_instructions_total") != 3:
+            raise AssertionError(f"unexpected instruction counter\n--- stderr ---\n{r.err}")
+        if _counter(r.err, "fs_write_bytes_total") != 3:
+            raise AssertionError(f"unexpected fs write bytes\n--- stderr ---\n{r.err}")
+
+        prom = (cwd / "m.prom").read_text(encoding="utf-8")
+        _require_contains(prom, "# TYPE tinix_disk_writes_total counter")
+        _require_contains(prom, "tinix_fs_file_reads_total 1")
+        _require_contains(prom, 'tinix_disk_write_latency_ns_bucket{le="+Inf"}')
+
+        data = json.loads((cwd / "m.json").read_text(encoding="utf-8"))
+        if data["counters"]["proc_created_total"] != 1:
+            raise AssertionError(f"unexpected json metrics: {data}")
+        if data["histograms"]["proc_tick_latency_ns"]["count"] != 10:
+            raise AssertionError(f"unexpected json metrics: {data}")
+
+        # stats reset 只清零计数器与直方图，仪表仍反映当前状态
+        r = _run(exe, "format\ncreate 50\nstats reset\nstats\nexit\n", cwd)
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        if _counter(r.err, "proc_created_total") != 0 or _counter(r.err, "proc_live") != 1:
+            raise AssertionError(f"stats reset cleared a gauge\n--- stderr ---\n{r.err}")
+
+
+def case_timeline_export(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        pc = cwd / "tl.pc"
+        pc.write_text("DR 0\nW 0\nW 4096\nS 2\nR 0\nDD 0\n", encoding="utf-8")
+
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "log all off",
+                    "timeline start auto.json",
+                    f"create -f {pc.name}",
+                    f"create -f {pc.name}",
+                    "tick 30",
+                    "timeline save tl.json",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        data = json.loads((cwd / "tl.json").read_text(encoding="utf-8"))
+        events = data["traceEvents"]
+        names = {e["name"] for e in events}
+        for name in ("Running", "Blocked (Sleep)", "Blocked (Device)", "PageFault", "pid 1"):
+            if name not in names:
+                raise AssertionError(f"missing {name} in timeline: {sorted(names)}")
+
+        threads = {e["args"]["name"] for e in events if e["name"] == "thread_name"}
+        for name in ("PID 1", "PID 2", "dev 0"):
+            if name not in threads:
+                raise AssertionError(f"missing track {name}: {sorted(threads)}")
+
+        for e in events:
+            if e["ph"] == "X" and e["dur"] < 1:
+                raise AssertionError(f"empty slice: {e}")
+
+        auto = json.loads((cwd / "auto.json").read_text(encoding="utf-8"))
+        if len(auto["traceEvents"]) != len(events):
+            raise AssertionError("auto-saved timeline differs from explicit save")
+
+
+def case_mmap_backend(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        r1 = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "mkdir /a",
+                    "touch /a/f",
+                    "echo mapped > /a/f",
+                    "sync",
+                    "stats",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+            ["--disk-backend=mmap"],
+        )
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        _require_contains(r1.err, "Disk synced (backend: mmap,")
+        if _counter(r1.err, "disk_syncs_total") != 1:
+            raise AssertionError(f"unexpected sync counter\n--- stderr ---\n{r1.err}")
+
+        # 同一镜像换回 stream 后端读取，验证 mmap 写入已落盘
+        r2 = _run(exe, "cat /a/f\nexit\n", cwd)
+        if r2.code != 0 or r2.out.strip() != "mapped":
+            raise AssertionError(f"unexpected stdout\n--- stdout ---\n{r2.out}\n--- stderr ---\n{r2.err}")
+
+        r3 = _run(exe, "cat /a/f\nexit\n", cwd, ["--disk-backend=bogus"])
+        if r3.code == 0:
+            raise AssertionError("unknown backend should be rejected")
+
+
+def case_writeback_sync(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        overwrites = [f"echo v{i:04d} > f" for i in range(20)]
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "touch f",
+                    "echo init > f",
+                    "sync",
+                    "stats reset",
+                    *overwrites,
+                    "stats",
+                    "sync",
+                    "stats",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        writes = _counters(r.err, "fs_bcache_writes_total")
+        backend = _counters(r.err, "disk_backend_writes_total")
+        if len(writes) != 2 or len(backend) != 2:
+            raise AssertionError(f"missing disk counters\n--- stderr ---\n{r.err}")
+        # 覆盖写只改缓冲缓存中的块；sync 时每个脏块只落盘一次。inode 块经元数据日志
+        # （描述块 + inode 块 + 提交块），日志过半时还有一次检查点（已记日志的块原地写回 + 日志头）
+        if backend[0] != 0:
+            raise AssertionError(f"overwrites reached the backend before sync: {backend[0]}")
+        if backend[1] > 10 or writes[1] < 2 * backend[1]:
+            raise AssertionError(f"write-back did not coalesce: {writes[1]} writes, {backend[1]} backend writes")
+
+        r2 = _run(exe, "cat f\nexit\n", cwd)
+        if r2.code != 0 or r2.out.strip() != "v0019":
+            raise AssertionError(f"unexpected stdout\n--- stdout ---\n{r2.out}\n--- stderr ---\n{r2.err}")
+
+
+def case_pread_backends(exe: Path, repo: Path) -> None:
+    for backend in ("pread", "direct"):
+        with tempfile.TemporaryDirectory() as td:
+            cwd = Path(td)
+            pc = cwd / "sw.pc"
+            pc.write_text("\n".join(f"W {i * 0x1000}" for i in range(12)) + "\n", encoding="utf-8")
+
+            r1 = _run(
+                exe,
+                "\n".join(
+                    [
+                        "format",
+                        "mkdir /d",
+                        "touch /d/f",
+                        f"echo {backend} > /d/f",
+                        f"create -f {pc.name}",
+                        "tick 20",
+                        "exit",
+                        "",
+                    ]
+                ),
+                cwd,
+                [f"--disk-backend={backend}"],
+            )
+            if r1.code != 0:
+                raise AssertionError(r1.out + r1.err)
+            _require_contains(r1.err, f"backend: {backend}")
+            if not _swap_blocks(r1.err):
+                raise AssertionError(f"[{backend}] expected swap-out activity\n--- stderr ---\n{r1.err}")
+
+            r2 = _run(exe, "cat /d/f\nexit\n", cwd)
+            if r2.code != 0 or r2.out.strip() != backend:
+                raise AssertionError(f"[{backend}] unexpected stdout\n--- stdout ---\n{r2.out}\n--- stderr ---\n{r2.err}")
+
+
+def case_async_io(exe: Path, repo: Path) -> None:
+    for backend, engine in (("pread", "uring"), ("pread", "pool"), ("stream", "auto")):
+        with tempfile.TemporaryDirectory() as td:
+            cwd = Path(td)
+            pc = cwd / "sw.pc"
+            # 先写满 12 页迫使脏页异步换出，再读回前几页触发换入
+            ops = [f"W {i * 0x1000}" for i in range(12)] + [f"R {i * 0x1000}" for i in range(4)]
+            pc.write_text("\n".join(ops) + "\n", encoding="utf-8")
+
+            r1 = _run(
+                exe,
+                "\n".join(
+                    [
+                        "format",
+                        "touch f",
+                        f"echo {engine} > f",
+                        f"create -f {pc.name}",
+                        "tick 40",
+                        "sync",
+                        "stats",
+                        "exit",
+                        "",
+                    ]
+                ),
+                cwd,
+                [f"--disk-backend={backend}", f"--io-engine={engine}", "--io-queue-depth=4"],
+            )
+            if r1.code != 0:
+                raise AssertionError(r1.out + r1.err)
+            tag = f"[{backend}/{engine}]"
+            if not _swap_blocks(r1.err):
+                raise AssertionError(f"{tag} expected swap-out activity\n--- stderr ---\n{r1.err}")
+            expected = {"uring": "io_uring", "pool": "thread-pool", "auto": "thread-pool"}[engine]
+            _require_contains(r1.err, f"io engine: {expected}")
+
+            def metric(name: str) -> int:
+                m = re.search(rf"{name}\s+\w+\s+(\d+)", r1.err)
+                if not m:
+                    raise AssertionError(f"{tag} missing {name}\n--- stderr ---\n{r1.err}")
+                return int(m.group(1))
+
+            submitted = metric("disk_async_submitted_total")
+            if submitted == 0 or metric("disk_async_completed_total") != submitted:
+                raise AssertionError(f"{tag} async requests not all completed\n--- stderr ---\n{r1.err}")
+            if metric("disk_io_queue_depth") != 4 or metric("disk_io_in_flight") != 0:
+                raise AssertionError(f"{tag} unexpected queue gauges\n--- stderr ---\n{r1.err}")
+
+            r2 = _run(exe, "cat f\nexit\n", cwd, [f"--disk-backend={backend}"])
+            if r2.code != 0 or r2.out.strip() != engine:
+                raise AssertionError(f"{tag} unexpected stdout\n--- stdout ---\n{r2.out}\n--- stderr ---\n{r2.err}")
+
+
+def case_vectored_io(exe: Path, repo: Path) -> None:
+    for backend in ("pread", "stream"):
+        with tempfile.TemporaryDirectory() as td:
+            cwd = Path(td)
+            # 40 KB = 10 个直接块：写入后重启，整文件 cat 应合并为少量后端调用
+            payload = "".join(chr(ord("a") + i % 26) for i in range(40960))
+            r1 = _run(exe, f"format\ntouch big\necho {payload} > big\nexit\n", cwd,
+                      [f"--disk-backend={backend}"])
+            if r1.code != 0:
+                raise AssertionError(r1.out + r1.err)
+
+            r2 = _run(exe, "stats reset\ncat big\nstats\nexit\n", cwd, [f"--disk-backend={backend}"])
+            if r2.code != 0:
+                raise AssertionError(r2.out + r2.err)
+            if r2.out.strip() != payload:
+                raise AssertionError(f"[{backend}] payload mismatch ({len(r2.out.strip())} bytes)")
+
+            reads = _counter(r2.err, "disk_reads_total")
+            runs = _counter(r2.err, "disk_backend_runs_total")
+            # 10 个数据块 + 少量 inode/目录块，逐块读取时 runs == reads
+            if reads < 10 or runs > reads - 8:
+                raise AssertionError(f"[{backend}] reads were not coalesced: {reads} blocks in {runs} runs")
+
+
+def case_disk_geometry(exe: Path, repo: Path) -> None:
+    blocks, swap, block_size = 65536, 512, 4096
+    swap_start = blocks - swap
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        r1 = _run(
+            exe,
+            "format\nfsinfo\ntouch f\necho geometry > f\nexit\n",
+            cwd,
+            [f"--disk-blocks={blocks}", f"--swap-blocks={swap}"],
+        )
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        _require_contains(r1.err, f"Total blocks: {swap_start}")
+        _require_contains(r1.err, f"Disk: {blocks} x {block_size} B, swap {swap} blocks")
+
+        # 稀疏创建：256 MB 镜像只有元数据块真正落盘
+        st = (cwd / "disk.img").stat()
+        if st.st_size != blocks * block_size:
+            raise AssertionError(f"unexpected image size {st.st_size}")
+        if st.st_blocks * 512 > st.st_size // 16:
+            raise AssertionError(f"image is not sparse: {st.st_blocks * 512} bytes allocated")
+
+        # 不带参数重新打开：块数取自文件大小，swap 分区取自超级块
+        pc = cwd / "sw.pc"
+        pc.write_text("\n".join(f"W {i * 0x1000}" for i in range(12)) + "\n", encoding="utf-8")
+        r2 = _run(exe, f"cat f\ncreate -f {pc.name}\ntick 20\nexit\n", cwd)
+        if r2.code != 0 or r2.out.strip() != "geometry":
+            raise AssertionError(f"unexpected stdout\n--- stdout ---\n{r2.out}\n--- stderr ---\n{r2.err}")
+        if "layout mismatch" in r2.err:
+            raise AssertionError(f"reopen without flags triggered a re-format\n--- stderr ---\n{r2.err}")
+        swapped = _swap_blocks(r2.err)
+        if not swapped or min(swapped) < swap_start:
+            raise AssertionError(f"swap outside the recorded partition: {swapped}\n--- stderr ---\n{r2.err}")
+
+        # 显式指定与镜像不同的几何时拒绝启动：镜像既不扩展也不重新格式化
+        for flag in (f"--swap-blocks={swap * 2}", f"--disk-blocks={blocks * 2}"):
+            r3 = _run(exe, "exit\n", cwd, [flag])
+            if r3.code != 2 or "Disk geometry error" not in r3.err:
+                raise AssertionError(f"conflicting {flag} accepted\n--- stderr ---\n{r3.err}")
+        if (cwd / "disk.img").stat().st_size != blocks * block_size:
+            raise AssertionError("conflicting geometry resized the image")
+        r3 = _run(exe, "cat f\nexit\n", cwd, [f"--disk-blocks={blocks}", f"--swap-blocks={swap}"])
+        if r3.code != 0 or r3.out.strip() != "geometry":
+            raise AssertionError(f"image lost after refused start\n--- stdout ---\n{r3.out}\n--- stderr ---\n{r3.err}")
+
+        fresh = cwd / "fresh"
+        fresh.mkdir()
+        r4 = _run(exe, "exit\n", fresh, ["--swap-blocks=70000"])
+        if r4.code == 0 or "does not fit" not in r4.err:
+            raise AssertionError(f"oversized swap accepted\n--- stderr ---\n{r4.err}")
+
+
+def case_ram_backend(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        pc = cwd / "sw.pc"
+        pc.write_text("\n".join(f"W {i * 0x1000}" for i in range(12)) + "\n", encoding="utf-8")
+
+        # 纯内存盘：文件系统与 swap 都可用，但不创建镜像文件
+        r1 = _run(
+            exe,
+            f"format\ntouch f\necho volatile > f\ncat f\ncreate -f {pc.name}\ntick 20\nsync\nexit\n",
+            cwd,
+            ["--disk-backend=ram"],
+        )
+        if r1.code != 0 or r1.out.strip() != "volatile":
+            raise AssertionError(f"unexpected stdout\n--- stdout ---\n{r1.out}\n--- stderr ---\n{r1.err}")
+        if not _swap_blocks(r1.err):
+            raise AssertionError(f"expected swap-out activity\n--- stderr ---\n{r1.err}")
+        _require_contains(r1.err, "Disk synced (backend: ram, io engine: sync)")
+        if (cwd / "disk.img").exists():
+            raise AssertionError("ram backend created disk.img")
+
+        # ram-persist：退出时存回镜像，其他后端与下一次 ram-persist 都能读到
+        r2 = _run(exe, "format\ntouch f\necho kept > f\nexit\n", cwd, ["--disk-backend=ram-persist"])
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+        _require_contains(r2.err, "from RAM disk to disk.img")
+
+        r3 = _run(exe, "cat f\nexit\n", cwd)
+        if r3.code != 0 or r3.out.strip() != "kept":
+            raise AssertionError(f"image not saved\n--- stdout ---\n{r3.out}\n--- stderr ---\n{r3.err}")
+
+        r4 = _run(exe, "cat f\necho again > f\nexit\n", cwd, ["--disk-backend=ram-persist"])
+        if r4.code != 0 or r4.out.strip() != "kept":
+            raise AssertionError(f"image not loaded\n--- stdout ---\n{r4.out}\n--- stderr ---\n{r4.err}")
+        _require_contains(r4.err, "into RAM disk")
+
+        r5 = _run(exe, "cat f\nexit\n", cwd, ["--disk-backend=pread"])
+        if r5.code != 0 or r5.out.strip() != "again":
+            raise AssertionError(f"second save lost\n--- stdout ---\n{r5.out}\n--- stderr ---\n{r5.err}")
+
+
+def case_disk_sched(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        for name in ("p1", "p2"):
+            (cwd / f"{name}.pc").write_text(
+                f"FO /{name}\nFW 3 8192\nFC 3\nC\n", encoding="utf-8"
+            )
+        commands = "touch /p1\ntouch /p2\ncreate -f p1.pc\ncreate -f p2.pc\ntick 8\nps\n"
+
+        # 关闭时序模型时块访问不耗时：8 个 tick 内两个进程都已完成
+        r0 = _run(exe, commands + "iosched\nexit\n", cwd)
+        if r0.code != 0:
+            raise AssertionError(r0.out + r0.err)
+        if re.search(r"^\d+\tBlocked", r0.err, re.M):
+            raise AssertionError(f"process blocked without the timing model\n--- stderr ---\n{r0.err}")
+        _require_contains(r0.err, "Disk timing model disabled")
+
+        (cwd / "disk.img").unlink()
+        r = _run(
+            exe,
+            commands + "tick 200\nps\niosched\niosched compare\nexit\n",
+            cwd,
+            ["--disk-sched=fcfs"],
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        # 写新块的指令在 barrier 处把块交给模拟磁盘，进程阻塞到请求完成
+        _require_contains(r.err, "disk request(s)")
+        if not re.search(r"^\d+\tBlocked", r.err, re.M):
+            raise AssertionError(f"no process blocked on disk I/O\n--- stderr ---\n{r.err}")
+        _require_contains(r.err, "disk I/O completed after")
+        last_ps = r.err.rsplit("PID\tState", 1)[1].split("tinix>", 1)[0]
+        if re.search(r"^\d+\t", last_ps, re.M):
+            raise AssertionError(f"processes did not finish\n--- stderr ---\n{r.err}")
+
+        live = re.search(
+            r"requests: (\d+) .*?latency \(ticks\): mean=([\d.]+) .*?head movement: (\d+) tracks",
+            r.err,
+            re.S,
+        )
+        if not live or int(live.group(1)) == 0:
+            raise AssertionError(f"missing scheduler stats\n--- stderr ---\n{r.err}")
+        _require_contains(r.err, "throughput: ")
+        _require_contains(r.err, " p95=")
+
+        rows = {
+            m.group(1): m.groups()[1:]
+            for m in re.finditer(
+                r"^(fcfs|sstf|scan|clook)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+(\d+)$",
+                r.err,
+                re.M,
+            )
+        }
+        if set(rows) != {"fcfs", "sstf", "scan", "clook"}:
+            raise AssertionError(f"missing policy rows: {sorted(rows)}\n--- stderr ---\n{r.err}")
+        # 同策略回放与实际运行一致；SCAN 每次折返都走到磁盘边缘
+        if rows["fcfs"][1] != live.group(2) or rows["fcfs"][5] != live.group(3):
+            raise AssertionError(f"fcfs replay differs from live run: {rows['fcfs']} vs {live.groups()}")
+        if int(rows["scan"][5]) < int(rows["clook"][5]):
+            raise AssertionError(f"scan moved less than c-look: {rows}")
+
+        bad = _run(exe, "exit\n", cwd, ["--disk-sched=elevator"])
+        if bad.code != 2:
+            raise AssertionError(f"unknown policy accepted\n--- stderr ---\n{bad.err}")
+
+
+def case_buffer_cache(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+
+        def stats(text: str) -> list[tuple[int, int, int]]:
+            return [
+                (int(m.group(1)), int(m.group(2)), int(m.group(3)))
+                for m in re.finditer(
+                    r"hits: (\d+)  misses: (\d+)  hit rate: [\d.]+%\nevictions: (\d+)", text
+                )
+            ]
+
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "mkdir /d",
+                    "touch /d/a",
+                    "touch /d/b",
+                    "echo alpha > /d/a",
+                    "echo beta > /d/b",
+                    "bcache",
+                    "bcache reset",
+                    "ls /d",
+                    "ls /d",
+                    "cat /d/a",
+                    "bcache",
+                    "bcache 64",
+                    "bcache reset",
+                    "ls /d",
+                    "cat /d/b",
+                    "bcache",
+                    "bcache 0",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+            ["--buffer-cache=4"],
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        _require_contains(r.err, "capacity: 4 blocks")
+        _require_contains(r.err, "Buffer cache capacity: 64 blocks")
+        _require_contains(r.err, "Usage: bcache")
+        s = stats(r.err)
+        if len(s) != 3:
+            raise AssertionError(f"missing bcache stats\n--- stderr ---\n{r.err}")
+        # 4 块的缓存装不下格式化与建文件涉及的元数据块，必然发生淘汰
+        if s[0][2] == 0:
+            raise AssertionError(f"no evictions with a 4-block cache: {s}")
+        # 重复访问同一目录应命中缓存；扩容后工作集全部驻留，未命中更少
+        if s[1][0] == 0 or s[2][0] == 0 or s[2][1] > s[1][1] or s[2][2] != 0:
+            raise AssertionError(f"unexpected cache behaviour: {s}")
+
+        # 只经缓存写入的数据在退出时落盘，重启后可读回
+        r2 = _run(exe, "cat /d/a\ncat /d/b\nexit\n", cwd)
+        if r2.code != 0 or r2.out.split() != ["alpha", "beta"]:
+            raise AssertionError(f"unexpected stdout\n--- stdout ---\n{r2.out}\n--- stderr ---\n{r2.err}")
+
+        bad = _run(exe, "exit\n", cwd, ["--buffer-cache=0"])
+        if bad.code != 2:
+            raise AssertionError(f"zero-sized cache accepted\n--- stderr ---\n{bad.err}")
+
+
+def case_inode_cache(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        (cwd / "rw.pc").write_text(
+            "FO /f\n" + "FW 3 256\n" * 8 + "FC 3\nFO /f\n" + "FR 3 256\n" * 8 + "FC 3\nC\n",
+            encoding="utf-8",
+        )
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "touch f",
+                    "sync",
+                    "stats reset",
+                    "create -f rw.pc",
+                    "tick 40",
+                    "stats",
+                    "sync",
+                    "stats",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        hits = _counters(r.err, "fs_icache_hits_total")
+        misses = _counters(r.err, "fs_icache_misses_total")
+        writebacks = _counters(r.err, "fs_icache_writebacks_total")
+        updates = _counters(r.err, "fs_icache_block_updates_total")
+        if len(hits) != 2 or len(writebacks) != 2 or len(updates) != 2:
+            raise AssertionError(f"missing inode cache counters\n--- stderr ---\n{r.err}")
+        # 打开的文件持有 inode 引用：16 次读写不再逐次查 inode 表，只有两次打开时的路径解析与取用
+        if hits[0] + misses[0] > 8:
+            raise AssertionError(f"read/write re-read the inode: hits={hits[0]} misses={misses[0]}")
+        # 分配新块的第一次写是提交点，其后的覆盖写只标记内存 inode，sync 时才写回
+        if writebacks[0] != 1 or writebacks[1] != 2 or updates[1] > writebacks[1]:
+            raise AssertionError(f"unexpected inode write-back: {writebacks} ({updates} block updates)")
+
+        r2 = _run(exe, "fsinfo\nls /\nexit\n", cwd)
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+        _require_contains(r2.out, "f (inode=1, size=2048)")
+
+
+def case_dentry_cache(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "mkdir /a",
+                    "mkdir /a/b",
+                    "touch /a/b/f",
+                    "echo hi > /a/b/f",
+                    "dcache reset",
+                    "cat /a/b/f",
+                    "cat /a/b/f",
+                    "cat /a/b/nope",
+                    "cat /a/b/nope",
+                    "dcache",
+                    "rm /a/b/f",
+                    "cat /a/b/f",
+                    "touch /a/b/f",
+                    "echo yo > /a/b/f",
+                    "cat /a/b/f",
+                    "dcache",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        # 删除与重新创建都使缓存项失效：删除后找不到，重建后读到新内容
+        if r.out.split() != ["hi", "hi", "yo"]:
+            raise AssertionError(f"unexpected stdout\n--- stdout ---\n{r.out}\n--- stderr ---\n{r.err}")
+        _require_contains(r.err, "File not found: /a/b/f")
+
+        stats = [
+            tuple(int(v) for v in m.groups())
+            for m in re.finditer(r"hits: (\d+) \(negative: (\d+)\)  misses: (\d+)", r.err)
+        ]
+        if len(stats) != 2:
+            raise AssertionError(f"missing dcache stats\n--- stderr ---\n{r.err}")
+        # 第一次查 nope 扫描目录并缓存否定项，其余路径分量都命中
+        hits, negative, misses = stats[0]
+        if misses != 1 or negative != 1 or hits < 6:
+            raise AssertionError(f"unexpected dentry cache stats: {stats}")
+        _require_contains(r.err, "(negative: 1), capacity:")
+
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 删除目录后 inode 号被新目录重新使用：旧目录下的缓存项不能在新目录中解析出来
+        r = _run(
+            exe,
+            "\n".join(
+                ["format", "mkdir /d", "touch /d/f", "stat /d/f", "rm /d"]
+                + [f"touch /x{i}" for i in range(1, 126)]
+                + ["rm /x1", "mkdir /e", "stat /e/f", "touch /e/f", "echo new > /e/f", "cat /e/f", "exit", ""]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        _require_contains(r.err, "Created directory: /e (inode=1)")
+        _require_contains(r.err, "File not found: /e/f")
+        if "File already exists: /e/f" in r.err or r.out.split()[-1:] != ["new"]:
+            raise AssertionError(f"stale dentry resolved in reused directory\n--- stdout ---\n{r.out}\n--- stderr ---\n{r.err[-2000:]}")
+
+
+def case_readahead(exe: Path, repo: Path) -> None:
+    for backend in ("stream", "pread"):
+        with tempfile.TemporaryDirectory() as td:
+            cwd = Path(td)
+            (cwd / "w.pc").write_text("FO /f\nFW 3 40960\nFC 3\nC\n", encoding="utf-8")
+            (cwd / "r1.pc").write_text("FO /f\nFR 3 4096\nFC 3\nC\n", encoding="utf-8")
+            (cwd / "r.pc").write_text("FO /f\n" + "FR 3 4096\n" * 10 + "FC 3\nC\n", encoding="utf-8")
+            r0 = _run(exe, "touch /f\ncreate -f w.pc\ntick 10\nexit\n", cwd, [f"--disk-backend={backend}"])
+            if r0.code != 0:
+                raise AssertionError(r0.out + r0.err)
+
+            # 重启后缓存为空：只读一块就关闭，预读的块在缩容时未被访问即淘汰；
+            # 随后顺序读完整个文件，除第一块外都应由预读供给
+            r = _run(
+                exe,
+                "\n".join(
+                    [
+                        "create -f r1.pc",
+                        "tick 10",
+                        "bcache 1",
+                        "bcache",
+                        "bcache 256",
+                        "bcache reset",
+                        "create -f r.pc",
+                        "tick 30",
+                        "bcache",
+                        "exit",
+                        "",
+                    ]
+                ),
+                cwd,
+                [f"--disk-backend={backend}"],
+            )
+            if r.code != 0:
+                raise AssertionError(r.out + r.err)
+            ra = [
+                tuple(int(v) for v in m.groups())
+                for m in re.finditer(r"read-ahead: (\d+) blocks, hits: (\d+), wasted: (\d+)", r.err)
+            ]
+            misses = [int(v) for v in re.findall(r"misses: (\d+)", r.err)]
+            if len(ra) != 2 or len(misses) != 2:
+                raise AssertionError(f"missing read-ahead stats\n--- stderr ---\n{r.err}")
+            if ra[0][0] < 2 or ra[0][2] < 1:
+                raise AssertionError(f"{backend}: short read did not waste its read-ahead: {ra}")
+            if ra[1][1] < 8 or misses[1] > 2:
+                raise AssertionError(f"{backend}: sequential read not served by read-ahead: {ra}, misses {misses}")
+
+
+def case_delalloc(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 同一进程交替追加两个文件：延迟分配后每次刷出每个文件各得一段连续块
+        (cwd / "ab.pc").write_text(
+            "FO /a\nFO /b\n" + "FW 3 4096\nFW 4 4096\n" * 4 + "FC 3\nFC 4\n", encoding="utf-8"
+        )
+        # 写入后长时间不关闭：由 tick 定时刷出
+        (cwd / "c.pc").write_text("FO /c\nFW 3 1000\n" + "C\n" * 8 + "FC 3\n", encoding="utf-8")
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "touch /a",
+                    "touch /b",
+                    "touch /c",
+                    "stats reset",
+                    "create -f ab.pc",
+                    "tick 20",
+                    "stats",
+                    "stats reset",
+                    "create -f c.pc",
+                    "tick 7",
+                    "stats",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+
+        blocks = _counters(r.err, "fs_delalloc_blocks_total")
+        extents = _counters(r.err, "fs_delalloc_extents_total")
+        flushes = _counters(r.err, "fs_delalloc_flushes_total")
+        saves = _counters(r.err, "fs_bitmap_saves_total")
+        if len(blocks) != 2 or len(extents) != 2 or len(flushes) != 2 or len(saves) != 2:
+            raise AssertionError(f"missing delalloc metrics\n--- stderr ---\n{r.err}")
+        if blocks[0] != 8 or extents[0] > 4 or saves[0] > 2:
+            raise AssertionError(f"interleaved appends not coalesced: blocks {blocks}, extents {extents}, bitmap saves {saves}")
+        if blocks[1] != 1 or flushes[1] != 1:
+            raise AssertionError(f"timer did not flush delayed data before close: blocks {blocks}, flushes {flushes}")
+
+        r2 = _run(exe, "cat /a\ncat /b\ncat /c\nexit\n", cwd)
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+        if [len(line) for line in r2.out.splitlines() if line.startswith("x")] != [16384, 16384, 1000]:
+            raise AssertionError("delayed data lost after restart")
+
+
+def case_metadata_commit(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        bulk = ["format", "sync", "stats reset"] + [f"touch /f{i}" for i in range(40)] + ["sync", "stats"]
+
+        # 逐操作提交与成组提交的批量创建对比
+        writes = {}
+        for ops in (1, 32):
+            r = _run(exe, "\n".join(bulk + ["exit", ""]), cwd, [f"--commit-ops={ops}"])
+            if r.code != 0:
+                raise AssertionError(r.out + r.err)
+            commits = _counters(r.err, "fs_metadata_commits_total")
+            writes[ops] = _counters(r.err, "disk_writes_total")
+            if len(commits) != 1 or len(writes[ops]) != 1:
+                raise AssertionError(f"missing commit metrics\n--- stderr ---\n{r.err}")
+            if commits[0] != (40 if ops == 1 else 2):
+                raise AssertionError(f"--commit-ops={ops}: {commits[0]} commits for 40 creates")
+        if writes[32][0] * 3 > writes[1][0]:
+            raise AssertionError(f"batched commit did not cut disk writes: {writes}")
+
+        # 少量操作由 tick 定时器提交；重启后文件仍在
+        r = _run(
+            exe,
+            "\n".join(["stats reset", "touch /late", "tick 3", "stats", "tick 3", "stats", "exit", ""]),
+            cwd,
+            ["--commit-ticks=5"],
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        commits = _counters(r.err, "fs_metadata_commits_total")
+        if commits != [0, 1]:
+            raise AssertionError(f"tick-based commit not observed: {commits}")
+        r2 = _run(exe, "ls /\nexit\n", cwd)
+        if "late" not in r2.out + r2.err or "f39" not in r2.out + r2.err:
+            raise AssertionError(f"committed files missing after restart\n{r2.out}{r2.err}")
+
+
+def case_journal_recovery(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 每个操作都提交：事务已写入日志，原地写回仍留在缓存中，掉电后靠重放恢复
+        r1 = _run(
+            exe,
+            "format\nmkdir /d\ntouch /d/a\necho hello > /d/a\ntouch /d/b\ncrash\n",
+            cwd,
+            ["--commit-ops=1"],
+        )
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        _require_contains(r1.err, "Simulated power loss.")
+
+        # 未提交的操作随掉电丢失，但文件系统保持一致
+        r2 = _run(exe, "ls /d\ncat /d/a\ntouch /d/c\ncrash\n", cwd)
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+        _require_contains(r2.err, "Journal recovery replayed")
+        if "free space mismatch" in r2.err:
+            raise AssertionError(f"replayed metadata inconsistent\n--- stderr ---\n{r2.err}")
+        for pat in (r"^  - a \(inode=\d+, size=[1-9]\d*\)$", r"^  - b \(inode=\d+, size=0\)$", r"^hello$"):
+            if not re.search(pat, r2.out, re.M):
+                raise AssertionError(f"missing {pat!r} after recovery\n--- stdout ---\n{r2.out}")
+
+        r3 = _run(exe, "ls /d\njournal\nexit\n", cwd)
+        if r3.code != 0:
+            raise AssertionError(r3.out + r3.err)
+        if "Journal recovery replayed" in r3.err or "free space mismatch" in r3.err:
+            raise AssertionError(f"unexpected recovery after clean state\n--- stderr ---\n{r3.err}")
+        if " c (" in r3.out:
+            raise AssertionError(f"uncommitted create survived power loss\n--- stdout ---\n{r3.out}")
+        _require_contains(r3.err, "=== Journal ===")
+
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 重新格式化后掉电：旧文件系统留在日志区的事务不能接在新事务后面被重放
+        r1 = _run(exe, "format\nmkdir /d\ntouch /d/x\ntouch /d/y\nexit\n", cwd, ["--commit-ops=1"])
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        r2 = _run(exe, "format\nmkdir /e\ncrash\n", cwd, ["--commit-ops=1"])
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+        r3 = _run(exe, "ls /e\nexit\n", cwd)
+        if r3.code != 0:
+            raise AssertionError(r3.out + r3.err)
+        _require_contains(r3.err, "Journal recovery replayed")
+        if re.search(r"^  . [xy] \(", r3.out, re.M) or "free space mismatch" in r3.err:
+            raise AssertionError(f"stale journal transactions replayed\n--- stdout ---\n{r3.out}\n--- stderr ---\n{r3.err}")
+
+
+def case_large_files(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 6 MiB 文件经一级与二级间接块映射；1300 个目录项占 11 个目录块
+        (cwd / "w.pc").write_text("FO /big\n" + "FW 3 1048576\n" * 6 + "FC 3\n", encoding="utf-8")
+        (cwd / "r.pc").write_text("FO /big\n" + "FR 3 1048576\n" * 7 + "FC 3\n", encoding="utf-8")
+        names = [f"f{i}" for i in range(1300)]
+        args = ["--disk-blocks=12288"]
+        r1 = _run(
+            exe,
+            "format\nmkdir /d\n"
+            + "".join(f"touch /d/{n}\n" for n in names)
+            + "touch /big\nsync\nfsinfo\ncreate -f w.pc\ntick 20\nexit\n",
+            cwd,
+            args,
+        )
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        if "File size limit reached" in r1.err or "Directory full" in r1.err:
+            raise AssertionError(f"unexpected size limit\n--- stderr ---\n{r1.err[-2000:]}")
+        free_before = re.findall(r"^Free blocks: (\d+)$", r1.err, re.M)
+
+        r2 = _run(
+            exe,
+            "ls /d\nstats reset\ncreate -f r.pc\ntick 20\nstats\nrm /big\nsync\nfsinfo\nexit\n",
+            cwd,
+            args,
+        )
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+        listed = set(re.findall(r"^  - (f\d+) \(", r2.out, re.M))
+        if listed != set(names):
+            raise AssertionError(f"directory lost entries: {len(listed)} of {len(names)} listed")
+
+        read = _counter(r2.err, "fs_read_bytes_total")
+        if read != 6 * 1048576:
+            raise AssertionError(f"large file read back {read} bytes")
+        # 顺序读每个映射块只取少数几次，而不是每个数据块一次
+        map_reads = _counter(r2.err, "fs_bmap_block_reads_total")
+        if map_reads > 64:
+            raise AssertionError(f"map blocks fetched {map_reads} times for 1536 data blocks")
+        free_after = re.findall(r"^Free blocks: (\d+)$", r2.err, re.M)
+        if not free_before or free_after[-1:] != free_before[-1:]:
+            raise AssertionError(f"rm leaked blocks: {free_before} -> {free_after}")
+
+
+def case_extents(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 两个文件交替追加 1 MiB：每次刷出各得一段连续块
+        (cwd / "big.pc").write_text(
+            "FO /a\nFO /b\n" + "FW 3 1048576\nFW 4 1048576\n" * 3 + "FC 3\nFC 4\n", encoding="utf-8"
+        )
+        # 交替写单块并等 tick 定时刷出：每块一段，超出 inode 内的 extent 存入 extent 块
+        (cwd / "frag.pc").write_text(
+            "FO /c\nFO /d\n" + ("FW 3 4096\nFW 4 4096\n" + "C\n" * 6) * 10 + "FC 3\nFC 4\n",
+            encoding="utf-8",
+        )
+        (cwd / "read.pc").write_text(
+            "FO /a\n" + "FR 3 1048576\n" * 4 + "FC 3\nFO /c\nFR 4 1048576\nFC 4\n", encoding="utf-8"
+        )
+        args = ["--disk-blocks=4096"]
+        r1 = _run(
+            exe,
+            "format\nfsinfo\ntouch /a\ntouch /b\ntouch /c\ntouch /d\n"
+            "create -f big.pc\ntick 20\ncreate -f frag.pc\ntick 100\nstat /a\nstat /c\nexit\n",
+            cwd,
+            args,
+        )
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        extents = [int(n) for n in re.findall(r"^Extents: (\d+)", r1.err, re.M)]
+        if len(extents) != 2 or extents[0] > 3 or extents[1] != 10:
+            raise AssertionError(f"unexpected extent layout {extents}\n--- stderr ---\n{r1.err[-3000:]}")
+        free_before = re.findall(r"^Free blocks: (\d+)$", r1.err, re.M)
+
+        r2 = _run(
+            exe,
+            "stats reset\ncreate -f read.pc\ntick 20\nstats\n"
+            "rm /a\nrm /b\nrm /c\nrm /d\nsync\nfsinfo\nexit\n",
+            cwd,
+            args,
+        )
+        if r2.code != 0:
+            raise AssertionError(r2.out + r2.err)
+
+        read = _counter(r2.err, "fs_read_bytes_total")
+        if read != 3 * 1048576 + 10 * 4096:
+            raise AssertionError(f"read back {read} bytes")
+        # 768 块按段连续，由后端合并为少数几次调用
+        runs = _counter(r2.err, "disk_backend_runs_total")
+        if runs > 40:
+            raise AssertionError(f"extent-mapped reads took {runs} backend calls")
+        free_after = re.findall(r"^Free blocks: (\d+)$", r2.err, re.M)
+        if not free_before or free_after[-1:] != free_before[:1]:
+            raise AssertionError(f"rm leaked blocks: {free_before} -> {free_after}")
+
+
+def case_bitmap_alloc(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 写满分区、删除后再写满：轮转提示越过末尾后回到开头，重新用上释放的块
+        for name in ("a", "b"):
+            (cwd / f"{name}.pc").write_text(
+                f"FO /{name}\n" + "FW 3 1048576\n" * 4 + "FC 3\n", encoding="utf-8"
+            )
+        r = _run(
+            exe,
+            "\n".join(
+                [
+                    "format",
+                    "touch /a",
+                    "create -f a.pc",
+                    "tick 20",
+                    "ls /",
+                    "rm /a",
+                    "touch /c",
+                    "stats reset",
+                    "touch /b",
+                    "create -f b.pc",
+                    "tick 20",
+                    "ls /",
+                    "stats",
+                    "exit",
+                    "",
+                ]
+            ),
+            cwd,
+        )
+        if r.code != 0:
+            raise AssertionError(r.out + r.err)
+        sizes = dict(re.findall(r"^  - ([ab]) \(inode=\d+, size=(\d+)\)$", r.out, re.M))
+        a_size = int(sizes.get("a", 0))
+        if a_size < 3 * 1048576 or int(sizes.get("b", 0)) != a_size:
+            raise AssertionError(f"refill after wrap-around got {sizes.get('b')} bytes, first fill {a_size}")
+
+        allocs = _counter(r.err, "fs_block_allocs_total")
+        words = _counter(r.err, "fs_bitmap_words_scanned_total")
+        if words > allocs // 8:
+            raise AssertionError(f"{words} bitmap words scanned for {allocs} block allocations")
+
+
+def case_block_groups(exe: Path, repo: Path) -> None:
+    with tempfile.TemporaryDirectory() as td:
+        cwd = Path(td)
+        # 分区（去掉 128 块 swap、超级块与 32 块日志）正好分成两个 8192 块的组
+        args = ["--disk-blocks=16545"]
+        for name in ("d1", "d2"):
+            (cwd / f"{name}.pc").write_text(
+                f"FO /{name}/f\nFW 3 1048576\nFC 3\n", encoding="utf-8"
+            )
+        r1 = _run(
+            exe,
+            "format\nmkdir /d1\nmkdir /d2\ntouch /d1/f\ntouch /d2/f\n"
+            "create -f d1.pc\ncreate -f d2.pc\ntick 20\nexit\n",
+            cwd,
+            args,
+        )
+        if r1.code != 0:
+            raise AssertionError(r1.out + r1.err)
+        r2 = _run(exe, "fsinfo\nstat /d1/f\nstat /d2/f\nexit\n", cwd, args)
+        if r2.code != 0 or "Mount successful" not in r2.err:
+            raise AssertionError(r2.out + r2.err)
+        if not re.search(r"^Groups: 2 x 8192 blocks, 1024 inodes each$", r2.err, re.M):
+            raise AssertionError(f"expected two block groups\n--- stderr ---\n{r2.err}")
+        group1_start = int(re.search(r"^Group 1: blocks (\d+)-", r2.err, re.M).group(1))
+
+        # 新目录分到空闲块较多的组，文件的 inode 与数据块跟随所在目录的组
+        files = re.findall(r"^Group: (\d+)\nExtents: 1 \((\d+)\+256\)$", r2.err, re.M)
+        if len(files) != 2:
+            raise AssertionError(f"unexpected stat output\n--- stderr ---\n{r2.err}")
+        for (group, start), want in zip(files, ("1", "0")):
+            if group != want or (int(start) >= group1_start) != (want == "1"):
+                raise AssertionError(f"file data at {start} in group {group}, expected group {want}")
+
+
 CASES = {
     "shell_help": case_shell_help,
     "fs_persistence": case_fs_persistence,
@@ -784,6 +1879,29 @@ CASES = {
     "pc_file_ops_explicit_fd": case_pc_file_ops_explicit_fd,
     "pc_file_ops_auto_fd_cleanup": case_pc_file_ops_auto_fd_cleanup,
     "pc_file_ops_invalid_fd": case_pc_file_ops_invalid_fd,
+    "log_levels": case_log_levels,
+    "trace_ring": case_trace_ring,
+    "stats_metrics": case_stats_metrics,
+    "timeline_export": case_timeline_export,
+    "mmap_backend": case_mmap_backend,
+    "writeback_sync": case_writeback_sync,
+    "pread_backends": case_pread_backends,
+    "async_io": case_async_io,
+    "vectored_io": case_vectored_io,
+    "disk_geometry": case_disk_geometry,
+    "ram_backend": case_ram_backend,
+    "disk_sched": case_disk_sched,
+    "buffer_cache": case_buffer_cache,
+    "inode_cache": case_inode_cache,
+    "dentry_cache": case_dentry_cache,
+    "readahead": case_readahead,
+    "delalloc": case_delalloc,
+    "metadata_commit": case_metadata_commit,
+    "journal_recovery": case_journal_recovery,
+    "large_files": case_large_files,
+    "extents": case_extents,
+    "bitmap_alloc": case_bitmap_alloc,
+    "block_groups": case_block_groups,
 }
 
 